@@ -5,7 +5,9 @@
 #include <stdexcept>                       // for runtime_error
 #include <fmt/format.h>                        // for format
 #include <scn/scan.h>
+#include "operon/core/problem.hpp"
 #include "operon/interpreter/dispatch_table.hpp"
+#include "operon/interpreter/interval.hpp"
 #include "operon/operators/creator.hpp"    // for CreatorBase, BalancedTreeC...
 #include "operon/operators/evaluator.hpp"  // for Evaluator, EvaluatorBase
 #include "operon/operators/generator.hpp"  // for OffspringGeneratorBase
@@ -135,6 +137,18 @@ auto ParseEvaluator(std::string const& str, Problem& problem, DefaultDispatch& d
     return evaluator;
 }
 
+auto ParseDispatch(std::string const& str) -> DefaultDispatch
+{
+    auto tok = Split(str, ':');
+    auto backend = ParseMathBackend(tok[0]);
+    if (!backend) {
+        throw std::runtime_error(fmt::format("unable to parse math backend '{}'", tok[0]));
+    }
+    DefaultDispatch dtable;
+    dtable.SetBackend(*backend, tok.size() > 1 ? ParsePrimitiveSetConfig(tok[1]) : ~NodeType{});
+    return dtable;
+}
+
 auto ParseGenerator(std::string const& str, EvaluatorBase& eval, CrossoverBase& cx, MutatorBase& mut, SelectorBase& femSel, SelectorBase& maleSel, CoefficientOptimizer const* coeffOptimizer = nullptr) -> std::unique_ptr<OffspringGeneratorBase>
 {
     std::unique_ptr<OffspringGeneratorBase> generator;
@@ -174,4 +188,66 @@ auto ParseOptimizer(std::string const& /*str*/, Problem const& /*problem*/, Defa
     throw std::runtime_error("not implemented");
 }
 
+auto ParseScheduler(std::string const& str, CoefficientOptimizer const& optimizer, EvaluatorBase& evaluator, std::size_t firstPass, std::size_t secondPass) -> std::unique_ptr<LocalSearchScheduler>
+{
+    auto tok = Split(str, ':');
+    auto const& name = tok[0];
+    if (name == "none") { return nullptr; }
+
+    auto scan = [&](std::size_t i, double value) { return tok.size() > i ? scn::scan<double>(tok[i], "{}")->value() : value; };
+    std::unique_ptr<LocalSearchScheduler> scheduler;
+    if (name == "uniform") {
+        scheduler = std::make_unique<LocalSearchScheduler>(optimizer, evaluator, LocalSearchPolicy::Uniform, firstPass, secondPass);
+    } else if (name == "best") {
+        scheduler = std::make_unique<LocalSearchScheduler>(optimizer, evaluator, LocalSearchPolicy::Best, firstPass, secondPass);
+        scheduler->SetFraction(scan(1, LocalSearchScheduler::DefaultFraction));
+    } else if (name == "improving") {
+        scheduler = std::make_unique<LocalSearchScheduler>(optimizer, evaluator, LocalSearchPolicy::Improving, firstPass, secondPass);
+        scheduler->SetThreshold(static_cast<Operon::Scalar>(scan(1, LocalSearchScheduler::DefaultThreshold)));
+    } else if (name == "best-or-improving") {
+        scheduler = std::make_unique<LocalSearchScheduler>(optimizer, evaluator, LocalSearchPolicy::BestOrImproving, firstPass, secondPass);
+        scheduler->SetFraction(scan(1, LocalSearchScheduler::DefaultFraction));
+        scheduler->SetThreshold(static_cast<Operon::Scalar>(scan(2, LocalSearchScheduler::DefaultThreshold)));
+    } else {
+        throw std::invalid_argument(detail::GetErrorString("local-search-policy", str));
+    }
+    return scheduler;
+}
+
+auto ParseIntervalCheck(std::string const& str, Problem const& problem) -> std::unique_ptr<IntervalInterpreter>
+{
+    if (str == "none") { return nullptr; }
+    if (str != "relaxed" && str != "strict") {
+        throw std::invalid_argument(detail::GetErrorString("interval-check", str));
+    }
+    return std::make_unique<IntervalInterpreter>(problem.GetDataset(), problem.TrainingRange(), /*strict=*/str == "strict");
+}
+
+auto ParseSubsample(std::string const& str, EvaluatorBase& evaluator, uint64_t seed) -> void
+{
+    auto tok = Split(str, ':');
+    auto const res = scn::scan<double>(tok[0], "{}");
+    if (!res || !(res->value() > 0 && res->value() <= 1)) {
+        throw std::invalid_argument(detail::GetErrorString("subsample", str));
+    }
+    auto const fraction = res->value();
+    if (fraction == 1) { return; }
+
+    std::size_t strata{Evaluator<DefaultDispatch>::DefaultStrata};
+    if (tok.size() > 1) {
+        auto result = scn::scan<std::size_t>(tok[1], "{}");
+        if (!result || result->value() == 0) {
+            throw std::invalid_argument(detail::GetErrorString("subsample", str));
+        }
+        strata = result->value();
+    }
+
+    // all the evaluators of ParseEvaluator derive from Evaluator
+    auto* e = dynamic_cast<Evaluator<DefaultDispatch>*>(&evaluator);
+    if (e == nullptr) {
+        throw std::invalid_argument(detail::GetErrorString("subsample", str));
+    }
+    e->SetSubsample(fraction, strata, seed);
+}
+
 } // namespace Operon
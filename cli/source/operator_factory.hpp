@@ -5,6 +5,7 @@
 #define OPERON_CLI_OPERATOR_FACTORY_HPP
 
 #include <cstddef>                            // for size_t
+#include <cstdint>
 #include <memory>                              // for unique_ptr, make_unique
 #include <string>                              // for operator==, string
 #include <utility>                             // for addressof
@@ -13,6 +14,7 @@
 #include "operon/core/individual.hpp"          // for Comparison
 #include "operon/interpreter/dispatch_table.hpp"
 #include "operon/interpreter/interpreter.hpp"  // for Interpreter
+#include "operon/interpreter/interval.hpp"
 #include "operon/optimizer/optimizer.hpp"
 #include "util.hpp"                            // for Split
 namespace Operon { struct EvaluatorBase; }
@@ -27,6 +29,7 @@ namespace Operon { struct CreatorBase; }
 namespace Operon { struct CrossoverBase; }
 namespace Operon { struct ErrorMetric; }
 namespace Operon { class CoefficientOptimizer; }
+namespace Operon { class LocalSearchScheduler; }
 namespace Operon { struct MutatorBase; }
 namespace Operon { struct Variable; }
 
@@ -40,12 +43,25 @@ auto ParseCreator(std::string const& str, PrimitiveSet const& pset, std::vector<
 
 auto ParseEvaluator(std::string const& str, Problem& problem, DefaultDispatch& dtable, bool scale = true) -> std::unique_ptr<EvaluatorBase>;
 
+// a dispatch table evaluating the given primitives (all by default) with another math backend, specified as backend[:sym1,sym2,...]
+auto ParseDispatch(std::string const& str) -> DefaultDispatch;
+
 auto ParseErrorMetric(std::string const& str) -> std::tuple<std::unique_ptr<Operon::ErrorMetric>, bool>;
 
 auto ParseGenerator(std::string const& str, EvaluatorBase& eval, CrossoverBase& cx, MutatorBase& mut, SelectorBase& femSel, SelectorBase& maleSel, CoefficientOptimizer const* cOpt) -> std::unique_ptr<OffspringGeneratorBase>;
 
 auto ParseOptimizer(std::string const& str, Problem const& problem, DefaultDispatch const& dtable) -> std::unique_ptr<OptimizerBase>;
 
+// the second local search pass (see LocalSearchScheduler) as none, uniform, best[:fraction], improving[:threshold] or
+// best-or-improving[:fraction[:threshold]], nullptr for none
+auto ParseScheduler(std::string const& str, CoefficientOptimizer const& optimizer, EvaluatorBase& evaluator, std::size_t firstPass, std::size_t secondPass) -> std::unique_ptr<LocalSearchScheduler>;
+
+// the progressive evaluation (see Evaluator::SetSubsample) as fraction[:strata], a fraction of 1 disables it
+auto ParseSubsample(std::string const& str, EvaluatorBase& evaluator, uint64_t seed) -> void;
+
+// the interval check of the offspring over the training range (none, relaxed or strict), nullptr for none
+auto ParseIntervalCheck(std::string const& str, Problem const& problem) -> std::unique_ptr<IntervalInterpreter>;
+
 } // namespace Operon
 
 #endif
@@ -22,6 +22,7 @@
 #include "operon/operators/crossover.hpp"
 #include "operon/operators/evaluator.hpp"
 #include "operon/operators/generator.hpp"
+#include "operon/operators/local_search.hpp"
 #include "operon/operators/initializer.hpp"
 #include "operon/operators/mutation.hpp"
 #include "operon/operators/reinserter.hpp"
@@ -46,6 +47,7 @@ auto main(int argc, char** argv) -> int
     config.CrossoverProbability = result["crossover-probability"].as<Operon::Scalar>();
     config.MutationProbability = result["mutation-probability"].as<Operon::Scalar>();
     config.TimeLimit = result["timelimit"].as<size_t>();
+    config.SubtreeCacheSize = result["subtree-cache"].as<size_t>() << 20U;
     config.Seed = std::random_device {}();
 
     // parse remaining configuration
@@ -216,9 +218,15 @@ auto main(int argc, char** argv) -> int
         mutator.Add(discretePoint, 1.0);
 
         Operon::DefaultDispatch dtable;
+        // the search can use faster approximations, the coefficient optimizer keeps the exact primitives
+        auto searchTable = result.count("search-backend") > 0 ? Operon::ParseDispatch(result["search-backend"].as<std::string>()) : dtable;
         auto scale = result["linear-scaling"].as<bool>();
-        auto evaluator = Operon::ParseEvaluator(result["objective"].as<std::string>(), problem, dtable, scale);
+        auto evaluator = Operon::ParseEvaluator(result["objective"].as<std::string>(), problem, searchTable, scale);
         evaluator->SetBudget(config.Evaluations);
+        Operon::ParseSubsample(result["subsample"].as<std::string>(), *evaluator, config.Seed);
+        if (auto* e = dynamic_cast<Operon::Evaluator<Operon::DefaultDispatch>*>(evaluator.get()); e != nullptr) {
+            e->SetEarlyAbandon(result["early-abandon"].as<bool>());
+        }
 
         auto optimizer = std::make_unique<Operon::LevenbergMarquardtOptimizer<decltype(dtable), Operon::OptimizerType::Eigen>>(dtable, problem);
         optimizer->SetIterations(config.Iterations);
@@ -234,6 +242,8 @@ auto main(int argc, char** argv) -> int
 
         auto generator = Operon::ParseGenerator(result["offspring-generator"].as<std::string>(), *evaluator, crossover, mutator, *femaleSelector, *maleSelector, &cOpt);
         auto reinserter = Operon::ParseReinserter(result["reinserter"].as<std::string>(), comp);
+        auto const scheduler = Operon::ParseScheduler(result["local-search-policy"].as<std::string>(), cOpt, *evaluator, result["local-search-first-pass"].as<size_t>(), config.Iterations);
+        generator->SetScheduler(scheduler.get());
 
         Operon::RandomGenerator random(config.Seed);
         if (result["shuffle"].as<bool>()) {
@@ -243,6 +253,10 @@ auto main(int argc, char** argv) -> int
             problem.StandardizeData(problem.TrainingRange());
         }
 
+        // the variable bounds are taken after the data is shuffled and standardized
+        auto const interval = Operon::ParseIntervalCheck(result["interval-check"].as<std::string>(), problem);
+        generator->SetIntervalCheck(interval.get());
+
         tf::Executor executor(threads);
 
         auto t0 = std::chrono::steady_clock::now();
@@ -276,14 +290,14 @@ auto main(int argc, char** argv) -> int
 
             tf::Taskflow taskflow;
 
-            using DT = Operon::DefaultDispatch;
-
             auto evalTrain = taskflow.emplace([&]() {
-                estimatedTrain = Operon::Interpreter<Operon::Scalar, DT>::Evaluate(best.Genotype, problem.GetDataset(), trainingRange);
+                estimatedTrain.resize(trainingRange.Size());
+                Operon::EvaluateRows(executor, dtable, best.Genotype, problem.GetDataset(), trainingRange, {}, estimatedTrain);
             });
 
             auto evalTest = taskflow.emplace([&]() {
-                estimatedTest = Operon::Interpreter<Operon::Scalar, DT>::Evaluate(best.Genotype, problem.GetDataset(), testRange);
+                estimatedTest.resize(testRange.Size());
+                Operon::EvaluateRows(executor, dtable, best.Genotype, problem.GetDataset(), testRange, {}, estimatedTest);
             });
 
             // scale values
@@ -362,6 +376,8 @@ auto main(int argc, char** argv) -> int
             auto t1 = std::chrono::steady_clock::now();
             auto elapsed = static_cast<double>(std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count()) / 1e6;
 
+            auto const localSearch = scheduler ? scheduler->GetStats() : Operon::LocalSearchScheduler::Stats{};
+
             using T = std::tuple<std::string, double, std::string>;
             auto const* format = ":>#8.3g";
             std::array stats {
@@ -378,6 +394,9 @@ auto main(int argc, char** argv) -> int
                 T{ "res_eval", evaluator.ResidualEvaluations, ":>" },
                 T{ "jac_eval", evaluator.JacobianEvaluations, ":>" },
                 T{ "opt_time", evaluator.CostFunctionTime,    ":>" },
+                T{ "ls_refined", localSearch.Refined, ":>" },
+                T{ "ls_time", localSearch.Time, format },
+                T{ "ls_gain", localSearch.Gain, format },
                 T{ "seed", config.Seed, ":>" },
                 T{ "elapsed", elapsed, ":>"},
             };
@@ -25,6 +25,7 @@
 #include "operon/operators/evaluator.hpp"
 #include "operon/operators/generator.hpp"
 #include "operon/operators/initializer.hpp"
+#include "operon/operators/local_search.hpp"
 #include "operon/operators/mutation.hpp"
 #include "operon/operators/non_dominated_sorter.hpp"
 #include "operon/operators/reinserter.hpp"
@@ -54,6 +55,7 @@ auto main(int argc, char** argv) -> int
     config.LocalSearchProbability = result["local-search-probability"].as<Operon::Scalar>();
     config.LamarckianProbability = result["lamarckian-probability"].as<Operon::Scalar>();
     config.TimeLimit = result["timelimit"].as<size_t>();
+    config.SubtreeCacheSize = result["subtree-cache"].as<size_t>() << 20U;
     config.Seed = std::random_device {}();
 
     // parse remaining config options
@@ -225,9 +227,12 @@ auto main(int argc, char** argv) -> int
         mutator.Add(discretePoint, 1.0);
 
         Operon::DefaultDispatch dtable;
+        // the search can use faster approximations, the coefficient optimizer keeps the exact primitives
+        auto searchTable = result.count("search-backend") > 0 ? Operon::ParseDispatch(result["search-backend"].as<std::string>()) : dtable;
         auto scale = result["linear-scaling"].as<bool>();
-        auto errorEvaluator = Operon::ParseEvaluator(result["objective"].as<std::string>(), problem, dtable, scale);
+        auto errorEvaluator = Operon::ParseEvaluator(result["objective"].as<std::string>(), problem, searchTable, scale);
         errorEvaluator->SetBudget(config.Evaluations);
+        Operon::ParseSubsample(result["subsample"].as<std::string>(), *errorEvaluator, config.Seed);
 
         auto optimizer = std::make_unique<Operon::LevenbergMarquardtOptimizer<decltype(dtable), Operon::OptimizerType::Eigen>>(dtable, problem);
         optimizer->SetIterations(config.Iterations);
@@ -248,6 +253,8 @@ auto main(int argc, char** argv) -> int
 
         auto generator = Operon::ParseGenerator(result["offspring-generator"].as<std::string>(), evaluator, crossover, mutator, *femaleSelector, *maleSelector, &cOpt);
         auto reinserter = Operon::ParseReinserter(result["reinserter"].as<std::string>(), comp);
+        auto const scheduler = Operon::ParseScheduler(result["local-search-policy"].as<std::string>(), cOpt, evaluator, result["local-search-first-pass"].as<size_t>(), config.Iterations);
+        generator->SetScheduler(scheduler.get());
 
         Operon::RandomGenerator random(config.Seed);
         if (result["shuffle"].as<bool>()) {
@@ -257,6 +264,10 @@ auto main(int argc, char** argv) -> int
             problem.StandardizeData(problem.TrainingRange());
         }
 
+        // the variable bounds are taken after the data is shuffled and standardized
+        auto const interval = Operon::ParseIntervalCheck(result["interval-check"].as<std::string>(), problem);
+        generator->SetIntervalCheck(interval.get());
+
         tf::Executor executor(threads);
 
         auto t0 = std::chrono::steady_clock::now();
@@ -288,14 +299,14 @@ auto main(int argc, char** argv) -> int
 
             tf::Taskflow taskflow;
 
-            using DT = Operon::DefaultDispatch;
-
             auto evalTrain = taskflow.emplace([&]() {
-                estimatedTrain = Operon::Interpreter<Operon::Scalar, DT>::Evaluate(best.Genotype, problem.GetDataset(), trainingRange);
+                estimatedTrain.resize(trainingRange.Size());
+                Operon::EvaluateRows(executor, dtable, best.Genotype, problem.GetDataset(), trainingRange, {}, estimatedTrain);
             });
 
             auto evalTest = taskflow.emplace([&]() {
-                estimatedTest = Operon::Interpreter<Operon::Scalar, DT>::Evaluate(best.Genotype, problem.GetDataset(), testRange);
+                estimatedTest.resize(testRange.Size());
+                Operon::EvaluateRows(executor, dtable, best.Genotype, problem.GetDataset(), testRange, {}, estimatedTest);
             });
 
             // scale values
@@ -377,6 +388,7 @@ auto main(int argc, char** argv) -> int
             auto const* format = ":>#8.3g"; // see https://fmt.dev/latest/syntax.html
 
             auto [resEval, jacEval, callCount, cfTime ] = evaluator.Stats();
+            auto const localSearch = scheduler ? scheduler->GetStats() : Operon::LocalSearchScheduler::Stats{};
             std::array stats {
                 T{ "iteration", gp.Generation(), ":>" },
                 T{ "r2_tr", r2Train, format },
@@ -391,6 +403,9 @@ auto main(int argc, char** argv) -> int
                 T{ "res_eval", resEval, ":>" },
                 T{ "jac_eval", jacEval, ":>" },
                 T{ "opt_time", cfTime, ":>" },
+                T{ "ls_refined", localSearch.Refined, ":>" },
+                T{ "ls_time", localSearch.Time, format },
+                T{ "ls_gain", localSearch.Gain, format },
                 T{ "seed", config.Seed, ":>" },
                 T{ "elapsed", elapsed, ":>"},
             };
@@ -27,6 +27,7 @@ auto main(int argc, char** argv) -> int
         ("target", "Name of the target variable (if none provided, model output will be printed)", cxxopts::value<std::string>())
         ("range", "Data range [A:B)", cxxopts::value<std::string>())
         ("scale", "Linear scaling slope:intercept", cxxopts::value<std::string>())
+        ("threads", "Number of threads used to evaluate the model (0: all available)", cxxopts::value<size_t>()->default_value("0"))
         ("debug", "Show some debugging information", cxxopts::value<bool>()->default_value("false"))
         ("format", "Format string (see https://fmt.dev/latest/syntax.html)", cxxopts::value<std::string>()->default_value(":>#8.4g"))
         ("help", "Print help");
@@ -81,7 +82,8 @@ auto main(int argc, char** argv) -> int
         fmt::print("Scale: {}\n", result["scale"].count() > 0 ? result["scale"].as<std::string>() : std::string("auto"));
     }
 
-    auto est = Operon::Interpreter<Operon::Scalar, decltype(dtable)>::Evaluate(model, ds, range);
+    // large ranges are split into row chunks evaluated in parallel
+    auto est = Operon::EvaluateRows(model, ds, range, result["threads"].as<size_t>());
 
     std::string format = result["format"].as<std::string>();
     if (result["target"].count() > 0) {
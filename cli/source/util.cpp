@@ -193,9 +193,16 @@ auto InitOptions(std::string const& name, std::string const& desc, int width) ->
         ("reinserter", "Reinsertion operator merging offspring in the recombination pool back into the population", cxxopts::value<std::string>()->default_value("keep-best"))
         ("enable-symbols", "Comma-separated list of enabled symbols ("+symbols+")", cxxopts::value<std::string>())
         ("local-search-probability", "Probability for local search", cxxopts::value<Operon::Scalar>()->default_value("1.0"))
+        ("local-search-policy", "Second local search pass (with --iterations) on the children selected at the end of each generation: none, uniform, best[:fraction], improving[:threshold] or best-or-improving[:fraction[:threshold]]", cxxopts::value<std::string>()->default_value("none"))
+        ("local-search-first-pass", "Local optimization iterations of the first pass, run on every child when a local search policy is set", cxxopts::value<size_t>()->default_value("1"))
         ("lamarckian-probability", "Probability that the local search improvements are saved back into the chromosome", cxxopts::value<Operon::Scalar>()->default_value("1.0"))
         ("disable-symbols", "Comma-separated list of disabled symbols ("+symbols+")", cxxopts::value<std::string>())
         ("symbolic", "Operate in symbolic mode - no coefficient tuning or coefficient mutation", cxxopts::value<bool>()->default_value("false"))
+        ("subtree-cache", "Memory budget (MiB) for the outputs of the subtrees inherited by the offspring, reused across generations (0 disables the cache)", cxxopts::value<size_t>()->default_value("0"))
+        ("early-abandon", "Stop evaluating an offspring as soon as its partial squared error shows it would be rejected by the offspring selection (sse, mse, rmse and nmse objectives of operon_gp)", cxxopts::value<bool>()->default_value("false"))
+        ("subsample", "Evaluate the offspring on a fraction of the training rows, drawn again every generation in a window of each of the strata (fraction[:strata], 1 disables it). The parents are evaluated on all the rows", cxxopts::value<std::string>()->default_value("1"))
+        ("interval-check", "Reject the offspring whose output may be undefined over the training range before evaluating them: none, relaxed or strict (also rejects the unbounded outputs)", cxxopts::value<std::string>()->default_value("none"))
+        ("search-backend", "Math backend for the fitness evaluation during the search, optionally for some primitives only (eg, --search-backend fast_v3:exp,log,tanh). Coefficient tuning and reporting use the exact primitives. The backend must be compiled in (see MATH_BACKENDS)", cxxopts::value<std::string>())
         ("show-primitives", "Display the primitive set used by the algorithm")
         ("threads", "Number of threads to use for parallelism", cxxopts::value<size_t>()->default_value("0"))
         ("timelimit", "Time limit after which the algorithm will terminate", cxxopts::value<size_t>()->default_value(std::to_string(std::numeric_limits<size_t>::max())))
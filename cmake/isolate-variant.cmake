@@ -0,0 +1,68 @@
+cmake_minimum_required(VERSION 3.20)
+
+# Renames the vague linkage symbols (inline functions, templates and their static data, emitted as weak or
+# unique symbols) which the object file of a kernel variant defines outside of its inline namespace, and
+# makes them local (unique symbols keep their binding, the new name is enough). These are the functions of
+# Eigen and of the standard library that are not inlined into the kernels (at -O0 none of them are): the
+# linker would otherwise keep a single copy of each, possibly the one compiled for another instruction
+# set. Fails if such a symbol keeps its name.
+# Usage: cmake -D NM=<nm> -D OBJCOPY=<objcopy> -D NAMESPACE=<name> -D INPUT=<object> -D OUTPUT=<object>
+#        -P isolate-variant.cmake
+
+foreach(var IN ITEMS NM OBJCOPY NAMESPACE INPUT OUTPUT)
+  if(NOT DEFINED "${var}")
+    message(FATAL_ERROR "${var} is not defined")
+  endif()
+endforeach()
+
+# the mangled inline namespace, e.g. 18variant_eigen_avx2
+string(LENGTH "${NAMESPACE}" length)
+set(mangled "${length}${NAMESPACE}")
+
+function(vague_symbols object result)
+  execute_process(
+      COMMAND "${NM}" --defined-only -P "${object}"
+      OUTPUT_VARIABLE output
+      RESULT_VARIABLE status
+  )
+  if(NOT status EQUAL "0")
+    message(FATAL_ERROR "'${object}': ${NM} returned with ${status}")
+  endif()
+  string(REPLACE "\n" ";" lines "${output}")
+  set(symbols "")
+  foreach(line IN LISTS lines)
+    if(line MATCHES "^([^ ]+) [WVu] ")
+      set(symbol "${CMAKE_MATCH_1}")
+      string(FIND "${symbol}" "${mangled}" position)
+      if(position EQUAL "-1" AND NOT symbol MATCHES "^${NAMESPACE}\\.")
+        list(APPEND symbols "${symbol}")
+      endif()
+    endif()
+  endforeach()
+  set("${result}" "${symbols}" PARENT_SCOPE)
+endfunction()
+
+vague_symbols("${INPUT}" symbols)
+set(renames "")
+set(locals "")
+foreach(symbol IN LISTS symbols)
+  string(APPEND renames "${symbol} ${NAMESPACE}.${symbol}\n")
+  string(APPEND locals "${NAMESPACE}.${symbol}\n")
+endforeach()
+file(WRITE "${OUTPUT}.renames" "${renames}")
+file(WRITE "${OUTPUT}.locals" "${locals}")
+
+execute_process(
+    COMMAND "${OBJCOPY}" "--redefine-syms=${OUTPUT}.renames" "--localize-symbols=${OUTPUT}.locals" "${INPUT}" "${OUTPUT}"
+    RESULT_VARIABLE status
+)
+if(NOT status EQUAL "0")
+  message(FATAL_ERROR "'${INPUT}': ${OBJCOPY} returned with ${status}")
+endif()
+
+vague_symbols("${OUTPUT}" remaining)
+if(NOT remaining STREQUAL "")
+  file(REMOVE "${OUTPUT}")
+  list(JOIN remaining "\n" remaining)
+  message(FATAL_ERROR "'${INPUT}': the following symbols are defined outside of ${NAMESPACE}:\n\n${remaining}\n")
+endif()
@@ -0,0 +1,54 @@
+# Adds the kernel variant SOURCE (see source/interpreter/isa/kernels.hpp) to TARGET, compiled with the build
+# settings of TARGET and the given OPTIONS (e.g. the instruction set flags). Where the tools are available
+# (KERNEL_VARIANT_ISOLATION), the variant is compiled into an object library of its own and the symbols it
+# shares with the other translation units (the non-inlined code of Eigen and of the standard library) are
+# renamed after NAMESPACE, the inline namespace of the variant (see isolate-variant.cmake): otherwise the
+# linker could replace the generic copies with the ones compiled for another instruction set.
+# Usage: add_kernel_variant(<target> <name> <source> <namespace> [OPTIONS <option>...]
+#                           [INCLUDE_DIRECTORIES <dir>...])
+set(KERNEL_VARIANT_ISOLATION FALSE)
+if(CMAKE_NM AND CMAKE_OBJCOPY AND UNIX AND NOT APPLE)
+  set(KERNEL_VARIANT_ISOLATION TRUE)
+endif()
+
+set(KERNEL_VARIANT_SCRIPT "${CMAKE_CURRENT_LIST_DIR}/isolate-variant.cmake")
+
+function(add_kernel_variant TARGET NAME SOURCE NAMESPACE)
+  cmake_parse_arguments(PARSE_ARGV 4 ARG "" "" "OPTIONS;INCLUDE_DIRECTORIES")
+  if(NOT KERNEL_VARIANT_ISOLATION)
+    target_sources("${TARGET}" PRIVATE "${SOURCE}")
+    set_source_files_properties("${SOURCE}" PROPERTIES
+        COMPILE_OPTIONS "${ARG_OPTIONS}"
+        INCLUDE_DIRECTORIES "${ARG_INCLUDE_DIRECTORIES}"
+    )
+    return()
+  endif()
+
+  set(objects "${TARGET}_${NAME}")
+  add_library("${objects}" OBJECT "${SOURCE}")
+  target_include_directories("${objects}" PRIVATE ${ARG_INCLUDE_DIRECTORIES} "$<TARGET_PROPERTY:${TARGET},INCLUDE_DIRECTORIES>")
+  target_compile_definitions("${objects}" PRIVATE "$<TARGET_PROPERTY:${TARGET},COMPILE_DEFINITIONS>")
+  target_compile_options("${objects}" PRIVATE "$<TARGET_PROPERTY:${TARGET},COMPILE_OPTIONS>" ${ARG_OPTIONS})
+  target_compile_features("${objects}" PRIVATE cxx_std_20)
+  set_target_properties("${objects}" PROPERTIES
+      POSITION_INDEPENDENT_CODE ON
+      CXX_VISIBILITY_PRESET hidden
+      VISIBILITY_INLINES_HIDDEN YES
+  )
+
+  set(output "${CMAKE_CURRENT_BINARY_DIR}/variants/${NAME}${CMAKE_CXX_OUTPUT_EXTENSION}")
+  add_custom_command(
+      OUTPUT "${output}"
+      COMMAND "${CMAKE_COMMAND}"
+      -D "NM=${CMAKE_NM}"
+      -D "OBJCOPY=${CMAKE_OBJCOPY}"
+      -D "NAMESPACE=${NAMESPACE}"
+      -D "INPUT=$<TARGET_OBJECTS:${objects}>"
+      -D "OUTPUT=${output}"
+      -P "${KERNEL_VARIANT_SCRIPT}"
+      DEPENDS "${objects}" "$<TARGET_OBJECTS:${objects}>" "${KERNEL_VARIANT_SCRIPT}"
+      COMMENT "Isolating the symbols of the ${NAME} kernels"
+      VERBATIM
+  )
+  target_sources("${TARGET}" PRIVATE "${output}")
+endfunction()
@@ -13,12 +13,14 @@ if(PROJECT_IS_TOP_LEVEL)
   set(USE_SINGLE_PRECISION_DESCRIPTION "Perform model evaluation using floats (single precision) instead of doubles. Great for reducing runtime, might not be appropriate for all purposes [default=OFF].")
   set(USE_CERES_DESCRIPTION            "Use the non-linear least squares optimizer from Ceres solver to tune model coefficients (if OFF, Eigen::LevenbergMarquardt will be used instead).")
   set(MATH_BACKEND_DESCRIPTION         "Math library for tree evaluation (defaults to Eigen)")
+  set(USE_ISA_DISPATCH_DESCRIPTION     "Compile the evaluation kernels for several x86-64 instruction sets (SSE4.2, AVX2, AVX-512) and select one at runtime [default=ON].")
 
   # option descriptions
   option(USE_JEMALLOC         ${JEMALLOC_DESCRIPTION}             OFF)
   option(USE_SINGLE_PRECISION ${USE_SINGLE_PRECISION_DESCRIPTION}  ON)
   option(USE_CERES            ${USE_CERES_DESCRIPTION}            OFF)
   option(MATH_BACKEND         ${MATH_BACKEND_DESCRIPTION}      "Eigen")
+  option(USE_ISA_DISPATCH     ${USE_ISA_DISPATCH_DESCRIPTION}     ON)
 
   # provide a summary of configured options
   include(FeatureSummary)
@@ -26,6 +28,7 @@ if(PROJECT_IS_TOP_LEVEL)
   add_feature_info(USE_SINGLE_PRECISION USE_SINGLE_PRECISION     ${USE_SINGLE_PRECISION_DESCRIPTION})
   add_feature_info(USE_CERES            USE_CERES                ${USE_CERES_DESCRIPTION})
   add_feature_info(MATH_BACKEND         MATH_BACKEND_DESCRIPTION ${MATH_BACKEND_DESCRIPTION})
+  add_feature_info(USE_ISA_DISPATCH     USE_ISA_DISPATCH         ${USE_ISA_DISPATCH_DESCRIPTION})
   set(CMAKE_EXPORT_COMPILE_COMMANDS ON CACHE INTERNAL "")
   if(CMAKE_EXPORT_COMPILE_COMMANDS)
     set(CMAKE_CXX_STANDARD_INCLUDE_DIRECTORIES ${CMAKE_CXX_IMPLICIT_INCLUDE_DIRECTORIES})
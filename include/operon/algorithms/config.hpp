@@ -20,6 +20,8 @@ struct GeneticAlgorithmConfig {
     double LocalSearchProbability{1.0};
     double LamarckianProbability{1.0};
     double Epsilon{0};     // used when comparing fitness values
+    size_t EvaluationGroupSize{8}; // number of trees evaluated together over the same row blocks
+    size_t SubtreeCacheSize{0};    // memory budget (bytes) of the cached subtree outputs, 0 to disable the cache
 };
 } // namespace Operon
 
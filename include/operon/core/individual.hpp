@@ -19,6 +19,8 @@ struct Individual {
     Operon::Vector<Operon::Scalar> Fitness;
     size_t Rank{}; // domination rank; used by NSGA2
     Operon::Scalar Distance{}; // crowding distance; used by NSGA2
+    bool Approximate{false}; // fitness computed on a sample of the training rows (see EvaluatorBase::Promote)
+    Operon::Scalar LocalSearchRate{std::numeric_limits<Operon::Scalar>::quiet_NaN()}; // cost decrease per iteration of the last local search, NaN without local search (see LocalSearchScheduler)
 
     inline auto operator[](size_t const i) noexcept -> Operon::Scalar& { return Fitness[i]; }
     inline auto operator[](size_t const i) const noexcept -> Operon::Scalar { return Fitness[i]; }
@@ -60,7 +60,7 @@ struct NodeTypes {
     static auto constexpr Count = std::countr_zero(static_cast<uint64_t>(NodeType::Variable)) + 1UL;
 
     // returns the index of the given type in the NodeType enum
-    static auto GetIndex(NodeType type) -> size_t
+    static constexpr auto GetIndex(NodeType type) -> size_t
     {
         return std::countr_zero(static_cast<uint32_t>(type));
     }
@@ -6,7 +6,10 @@
 
 #include <ankerl/unordered_dense.h>
 #include <cstdint>
+#include <functional>
+#include <memory>
 #include <span>
+#include <type_traits>
 #include <utility>
 
 #include "constants.hpp"
@@ -57,6 +60,27 @@ using SegmentedSet = ankerl::unordered_dense::detail::table<Key, void, Hash, Key
 template<typename T, T... Ints>
 using Seq = std::integer_sequence<T, Ints...>;
 
+// non-owning reference to a callable (it must outlive the reference), for callbacks invoked in hot loops
+// through a virtual interface: unlike std::function it never allocates and calls through one pointer
+template<typename Signature>
+class FunctionRef;
+
+template<typename R, typename... Args>
+class FunctionRef<R(Args...)> {
+    void* obj_;
+    R (*call_)(void*, Args...);
+
+public:
+    template<typename F>
+    requires (!std::is_same_v<std::remove_cvref_t<F>, FunctionRef> && std::is_invocable_r_v<R, F&, Args...>)
+    FunctionRef(F&& f) noexcept // NOLINT(google-explicit-constructor,bugprone-forwarding-reference-overload)
+        : obj_(const_cast<void*>(static_cast<void const*>(std::addressof(f)))) // NOLINT(cppcoreguidelines-pro-type-const-cast)
+        , call_([](void* obj, Args... args) -> R { return std::invoke(*static_cast<std::add_pointer_t<F>>(obj), std::forward<Args>(args)...); })
+    { }
+
+    auto operator()(Args... args) const -> R { return call_(obj_, std::forward<Args>(args)...); }
+};
+
 #if defined(USE_SINGLE_PRECISION)
 using Scalar = float;
 #else
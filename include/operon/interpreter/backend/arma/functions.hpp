@@ -9,6 +9,7 @@
 #include "operon/interpreter/backend/backend.hpp"
 
 namespace Operon::Backend {
+OPERON_ISA_NAMESPACE_BEGIN
     template<typename T, std::size_t S>
     auto Map(T* ptr) {
         return arma::Mat<Operon::Scalar>(ptr, S, 1, /*copy_aux_mem =*/false, /*strict=*/true);
@@ -200,5 +201,6 @@ namespace Operon::Backend {
     auto Cbrt(T* res, T const* arg) {
         Map<T, S>(res) = arma::cbrt(Map<T const, S>(arg));
     }
+OPERON_ISA_NAMESPACE_END
 }  // namespace Operon::Backend
 #endif
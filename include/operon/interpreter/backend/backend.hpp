@@ -3,6 +3,7 @@
 
 #include "operon/mdspan/mdspan.hpp"
 #include "operon/core/types.hpp"
+#include "operon/interpreter/isa.hpp"
 
 namespace Operon::Backend {
     template<typename T>
@@ -13,10 +14,12 @@ namespace Operon::Backend {
     template<typename T, std::size_t S = BatchSize<T>>
     using View = std::mdspan<T, std::extents<int, S, std::dynamic_extent>, std::layout_left>;
 
+OPERON_ISA_NAMESPACE_BEGIN
     template<typename T, std::size_t S>
     auto Ptr(View<T, S> view, std::integral auto col) -> Backend::View<T, S>::element_type* {
         return view.data_handle() + col * S;
     }
+OPERON_ISA_NAMESPACE_END
 } // namespace Operon::Backend
 
 #endif
@@ -8,6 +8,7 @@
 #include "operon/interpreter/backend/backend.hpp"
 
 namespace Operon::Backend {
+OPERON_ISA_NAMESPACE_BEGIN
     namespace detail {
         template<typename T>
         using CVector = blaze::CustomVector<T, blaze::unaligned, blaze::unpadded, blaze::columnVector>;
@@ -211,5 +212,6 @@ namespace Operon::Backend {
     auto Cbrt(T* res, T const* arg) {
         Map<T, S>(res) = blaze::cbrt(Map<T const, S>(arg));
     }
+OPERON_ISA_NAMESPACE_END
 } // namespace Operon::Backend
 #endif
@@ -8,6 +8,7 @@
 #include "functions.hpp"
 
 namespace Operon::Backend {
+OPERON_ISA_NAMESPACE_BEGIN
 namespace detail {
     template<typename T>
     inline auto IsNaN(T value) { return std::isnan(value); }
@@ -183,6 +184,7 @@ namespace detail {
     auto Cbrt(std::vector<Operon::Node> const& /*nodes*/, Backend::View<T const, S> primal, Backend::View<T> trace, std::integral auto i, std::integral auto j) {
         Col(trace, j) = (T{3} * Col(primal, i).square()).inverse();
     }
+OPERON_ISA_NAMESPACE_END
 }  // namespace Operon::Backend
 
 #endif
\ No newline at end of file
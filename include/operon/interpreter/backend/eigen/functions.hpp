@@ -8,6 +8,7 @@
 #include "operon/interpreter/backend/backend.hpp"
 
 namespace Operon::Backend {
+OPERON_ISA_NAMESPACE_BEGIN
     template<typename T, std::size_t S>
     using Map = Eigen::Map<std::conditional_t<std::is_const_v<T>, Eigen::Array<std::remove_const_t<T>, S, 1> const, Eigen::Array<T, S, 1>>>;
 
@@ -193,5 +194,6 @@ namespace Operon::Backend {
     auto Cbrt(T* res, T const* arg) {
         Map<T, S>(res, S, 1) = Map<T const, S>(arg, S, 1).unaryExpr([](auto x) { return std::cbrt(x); });
     }
+OPERON_ISA_NAMESPACE_END
 }  // namespace Operon::Backend
 #endif
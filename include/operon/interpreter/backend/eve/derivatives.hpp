@@ -7,6 +7,7 @@
 #include "functions.hpp"
 
 namespace Operon::Backend {
+OPERON_ISA_NAMESPACE_BEGIN
 namespace detail {
     template<typename T>
     inline auto IsNaN(T value) { return eve::all(eve::is_nan(value)); }
@@ -370,6 +371,7 @@ namespace detail {
             eve::store(eve::rec(T{3} * eve::sqr(W{pi+s})), res+s);
         }
     }
+OPERON_ISA_NAMESPACE_END
 }  // namespace Operon::Backend
 
 #endif
@@ -12,6 +12,7 @@
 #include "operon/core/node.hpp"
 
 namespace Operon::Backend {
+OPERON_ISA_NAMESPACE_BEGIN
     // utility
     template<typename T, std::size_t S>
     auto Fill(T* res, T value) {
@@ -319,6 +320,7 @@ namespace Operon::Backend {
             eve::store(eve::cbrt(W{arg + i}), res+i);
         }
     }
+OPERON_ISA_NAMESPACE_END
 } // namespace Operon::Backend
 
 #endif
@@ -7,6 +7,7 @@
 #include "functions.hpp"
 
 namespace Operon::Backend {
+OPERON_ISA_NAMESPACE_BEGIN
 namespace detail {
     template<typename T>
     inline auto IsNaN(T value) { return std::isnan(value); }
@@ -30,6 +31,8 @@ namespace detail {
     }
 } // namespace detail
 
+    // the derivatives call the scalar approximations element by element, unlike the forward kernels
+    // (see Apply in functions.hpp) they are not evaluated one simd register at a time
     template<typename T, std::size_t S>
     auto Add(std::vector<Operon::Node> const& /*nodes*/, Backend::View<T const, S> /*primal*/, Backend::View<T> trace, std::integral auto /*i*/, std::integral auto j) {
         std::ranges::fill_n(Ptr(trace, j), S, T{1});
@@ -71,14 +74,14 @@ namespace detail {
         auto const* pj = Ptr(primal, j);
 
         if (j == i-1) {
-            std::transform(pi, pi+S, pj, res, detail::fast_approx::Div);
+            std::transform(pi, pi+S, pj, res, [](auto x, auto y) { return detail::fast_approx::Div(x, y); });
         } else {
             auto const* pk = Ptr(primal, i-1);
-            constexpr auto p = -3.F / 2.F;
+            constexpr auto p = T{-3} / T{2};
             for (auto s = 0UL; s < S; ++s) {
                 auto const b = pj[s];
                 auto const c = pk[s];
-                res[s] = -b * c * detail::fast_approx::Pow(1 + b * b, p);
+                res[s] = -b * c * detail::fast_approx::Pow(T{1} + b * b, p);
             }
         }
     }
@@ -258,5 +261,6 @@ namespace detail {
         auto const* pi = Ptr(primal, i);
         std::transform(pi, pi+S, res, [](auto x){ return detail::fast_approx::Inv(T{3} * x*x); });
     }
+OPERON_ISA_NAMESPACE_END
 }  // namespace Operon::Backend
 #endif
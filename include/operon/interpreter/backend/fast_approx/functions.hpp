@@ -4,6 +4,8 @@
 #ifndef OPERON_BACKEND_fast_approx_FUNCTIONS_HPP
 #define OPERON_BACKEND_fast_approx_FUNCTIONS_HPP
 
+#include <eve/module/core.hpp>
+
 #include "operon/interpreter/backend/backend.hpp"
 #include "operon/core/node.hpp"
 
@@ -17,78 +19,108 @@
 #include "impl/tanh.hpp"
 
 namespace Operon::Backend {
+OPERON_ISA_NAMESPACE_BEGIN
     namespace detail::fast_approx {
         static constexpr auto Precision = OPERON_MATH_FAST_APPROX_PRECISION;
 
-        // unary details
-        inline auto constexpr Inv(Operon::Scalar x) -> Operon::Scalar {
+        // unary details, V is a scalar or an eve::wide
+        template<typename V>
+        inline auto Inv(V x) -> V {
             return fast_approx::InvImpl<Precision>(x);
         }
 
-        inline auto constexpr Log(Operon::Scalar x) -> Operon::Scalar {
+        template<typename V>
+        inline auto Log(V x) -> V {
             return fast_approx::LogImpl<Precision>(x);
         }
 
-        inline auto constexpr Log1p(Operon::Scalar x) -> Operon::Scalar {
+        template<typename V>
+        inline auto Log1p(V x) -> V {
             return fast_approx::Log1pImpl<Precision>(x);
         }
 
-        inline auto constexpr Logabs(Operon::Scalar x) -> Operon::Scalar {
+        template<typename V>
+        inline auto Logabs(V x) -> V {
             return fast_approx::LogabsImpl<Precision>(x);
         }
 
-        inline auto constexpr Exp(Operon::Scalar x) -> Operon::Scalar {
+        template<typename V>
+        inline auto Exp(V x) -> V {
             return fast_approx::ExpImpl<Precision>(x);
         }
 
-        inline auto constexpr Sin(Operon::Scalar x) -> Operon::Scalar {
+        template<typename V>
+        inline auto Sin(V x) -> V {
             return fast_approx::SinImpl<Precision>(x);
         }
 
-        inline auto constexpr Cos(Operon::Scalar x) -> Operon::Scalar {
+        template<typename V>
+        inline auto Cos(V x) -> V {
             return fast_approx::CosImpl<Precision>(x);
         }
 
-        inline auto constexpr Tan(Operon::Scalar x) -> Operon::Scalar {
+        template<typename V>
+        inline auto Tan(V x) -> V {
             return fast_approx::TanImpl<Precision>(x);
         }
 
-        inline auto constexpr Sinh(Operon::Scalar x) -> Operon::Scalar {
+        template<typename V>
+        inline auto Sinh(V x) -> V {
             auto const e = Exp(x);
-            return (e*e - 1.F) * Inv(e+e);
+            return (e*e - V(1)) * Inv(e+e);
         }
 
-        inline auto constexpr Cosh(Operon::Scalar x) -> Operon::Scalar {
+        template<typename V>
+        inline auto Cosh(V x) -> V {
             auto const e = Exp(x);
-            return (e*e + 1.F) * Inv(e+e);
+            return (e*e + V(1)) * Inv(e+e);
         }
 
-        inline auto constexpr ISqrt(Operon::Scalar x) -> Operon::Scalar {
+        template<typename V>
+        inline auto ISqrt(V x) -> V {
             return fast_approx::ISqrtImpl<Precision>(x);
         }
 
-        inline auto constexpr Sqrt(Operon::Scalar x) -> Operon::Scalar {
+        template<typename V>
+        inline auto Sqrt(V x) -> V {
             return fast_approx::SqrtImpl<Precision>(x);
         }
 
-        inline auto constexpr Sqrtabs(Operon::Scalar x) -> Operon::Scalar {
+        template<typename V>
+        inline auto Sqrtabs(V x) -> V {
             return fast_approx::SqrtabsImpl<Precision>(x);
         }
 
-        inline auto constexpr Div(Operon::Scalar x, Operon::Scalar y) -> Operon::Scalar {
+        template<typename V>
+        inline auto Tanh(V x) -> V {
+            return fast_approx::TanhImpl<Precision>(x);
+        }
+
+        // binary details
+        template<typename V>
+        inline auto Div(V x, V y) -> V {
             return fast_approx::DivImpl<Precision>(x, y);
         }
 
-        inline auto constexpr Pow(Operon::Scalar x, Operon::Scalar y) -> Operon::Scalar {
+        template<typename V>
+        inline auto Pow(V x, V y) -> V {
             return fast_approx::PowImpl<Precision>(x, y);
         }
 
-        inline auto constexpr Tanh(Operon::Scalar x) -> Operon::Scalar {
-            return fast_approx::TanhImpl<Precision>(x);
+        template<typename V>
+        inline auto Aq(V x, V y) -> V {
+            return fast_approx::AqImpl<Precision>(x, y);
         }
 
-        inline auto constexpr Aq(Operon::Scalar x, Operon::Scalar y) -> Operon::Scalar {
-            return fast_approx::AqImpl<Precision>(x, y);
+        // evaluates the approximation one simd register at a time
+        template<typename T, std::size_t S, typename F>
+        requires (S % eve::wide<T>::size() == 0)
+        inline auto Apply(T* res, F&& f, auto const*... args) -> void {
+            using W = eve::wide<T>;
+            constexpr auto L = W::size();
+            for (auto i = 0UL; i < S; i += L) {
+                eve::store(f(W{args+i}...), res+i);
+            }
         }
     } // namespace detail::fast_approx
 
@@ -131,13 +163,13 @@ namespace Operon::Backend {
 
     template<typename T, std::size_t S>
     auto Div(T* res, auto const* first, auto const*... rest) {
-        for (auto i = 0UL; i < S; ++i) {
-            if constexpr (sizeof...(rest) == 0) {
-                res[i] = detail::fast_approx::Inv(first[i]);
+        detail::fast_approx::Apply<T, S>(res, [](auto x, auto... y) {
+            if constexpr (sizeof...(y) == 0) {
+                return detail::fast_approx::Inv(x);
             } else {
-                res[i] = detail::fast_approx::Div(first[i], (rest[i] * ...));
+                return detail::fast_approx::Div(x, (y * ...));
             }
-        }
+        }, first, rest...);
     }
 
     template<typename T, std::size_t S>
@@ -157,12 +189,12 @@ namespace Operon::Backend {
     // binary functions
     template<typename T, std::size_t S>
     auto Aq(T* res, T const* a, T const* b) {
-        std::transform(a, a+S, b, res, detail::fast_approx::Aq);
+        detail::fast_approx::Apply<T, S>(res, [](auto x, auto y) { return detail::fast_approx::Aq(x, y); }, a, b);
     }
 
     template<typename T, std::size_t S>
     auto Pow(T* res, T const* a, T const* b) {
-        std::transform(a, a+S, b, res, detail::fast_approx::Pow);
+        detail::fast_approx::Apply<T, S>(res, [](auto x, auto y) { return detail::fast_approx::Pow(x, y); }, a, b);
     }
 
     // unary functions
@@ -178,7 +210,7 @@ namespace Operon::Backend {
 
     template<typename T, std::size_t S>
     auto Inv(T* res, T const* arg) {
-        std::transform(arg, arg+S, res, detail::fast_approx::Inv);
+        detail::fast_approx::Apply<T, S>(res, [](auto x) { return detail::fast_approx::Inv(x); }, arg);
     }
 
     template<typename T, std::size_t S>
@@ -198,37 +230,37 @@ namespace Operon::Backend {
 
     template<typename T, std::size_t S>
     auto Exp(T* res, T const* arg) {
-        std::transform(arg, arg+S, res, detail::fast_approx::Exp);
+        detail::fast_approx::Apply<T, S>(res, [](auto x) { return detail::fast_approx::Exp(x); }, arg);
     }
 
     template<typename T, std::size_t S>
     auto Log(T* res, T const* arg) {
-        std::transform(arg, arg+S, res, detail::fast_approx::Log);
+        detail::fast_approx::Apply<T, S>(res, [](auto x) { return detail::fast_approx::Log(x); }, arg);
     }
 
     template<typename T, std::size_t S>
     auto Log1p(T* res, T const* arg) {
-        std::transform(arg, arg+S, res, detail::fast_approx::Log1p);
+        detail::fast_approx::Apply<T, S>(res, [](auto x) { return detail::fast_approx::Log1p(x); }, arg);
     }
 
     template<typename T, std::size_t S>
     auto Logabs(T* res, T const* arg) {
-        std::transform(arg, arg+S, res, detail::fast_approx::Logabs);
+        detail::fast_approx::Apply<T, S>(res, [](auto x) { return detail::fast_approx::Logabs(x); }, arg);
     }
 
     template<typename T, std::size_t S>
     auto Sin(T* res, T const* arg) {
-        std::transform(arg, arg+S, res, detail::fast_approx::Sin);
+        detail::fast_approx::Apply<T, S>(res, [](auto x) { return detail::fast_approx::Sin(x); }, arg);
     }
 
     template<typename T, std::size_t S>
     auto Cos(T* res, T const* arg) {
-        std::transform(arg, arg+S, res, detail::fast_approx::Cos);
+        detail::fast_approx::Apply<T, S>(res, [](auto x) { return detail::fast_approx::Cos(x); }, arg);
     }
 
     template<typename T, std::size_t S>
     auto Tan(T* res, T const* arg) {
-        std::transform(arg, arg+S, res, detail::fast_approx::Tan);
+        detail::fast_approx::Apply<T, S>(res, [](auto x) { return detail::fast_approx::Tan(x); }, arg);
     }
 
     template<typename T, std::size_t S>
@@ -248,27 +280,27 @@ namespace Operon::Backend {
 
     template<typename T, std::size_t S>
     auto Sinh(T* res, T const* arg) {
-        std::transform(arg, arg+S, res, detail::fast_approx::Sinh);
+        detail::fast_approx::Apply<T, S>(res, [](auto x) { return detail::fast_approx::Sinh(x); }, arg);
     }
 
     template<typename T, std::size_t S>
     auto Cosh(T* res, T const* arg) {
-        std::transform(arg, arg+S, res, detail::fast_approx::Sinh);
+        detail::fast_approx::Apply<T, S>(res, [](auto x) { return detail::fast_approx::Cosh(x); }, arg);
     }
 
     template<typename T, std::size_t S>
     auto Tanh(T* res, T const* arg) {
-        std::transform(arg, arg+S, res, detail::fast_approx::Tanh);
+        detail::fast_approx::Apply<T, S>(res, [](auto x) { return detail::fast_approx::Tanh(x); }, arg);
     }
 
     template<typename T, std::size_t S>
     auto Sqrt(T* res, T const* arg) {
-        std::transform(arg, arg+S, res, detail::fast_approx::Sqrt);
+        detail::fast_approx::Apply<T, S>(res, [](auto x) { return detail::fast_approx::Sqrt(x); }, arg);
     }
 
     template<typename T, std::size_t S>
     auto Sqrtabs(T* res, T const* arg) {
-        std::transform(arg, arg+S, res, detail::fast_approx::Sqrtabs);
+        detail::fast_approx::Apply<T, S>(res, [](auto x) { return detail::fast_approx::Sqrtabs(x); }, arg);
     }
 
     template<typename T, std::size_t S>
@@ -280,6 +312,7 @@ namespace Operon::Backend {
     auto Cbrt(T* res, T const* arg) {
         std::transform(arg, arg+S, res, [](auto x) { return std::cbrt(x); });
     }
+OPERON_ISA_NAMESPACE_END
 } // namespace Operon::Backend
 
 
@@ -1,16 +1,22 @@
 #ifndef OPERON_BACKEND_FAST_APPROX_AQ_HPP
 #define OPERON_BACKEND_FAST_APPROX_AQ_HPP
 
-#include "operon/core/types.hpp"
+#include "common.hpp"
 #include "inv.hpp"
 #include "sqrt.hpp"
 
-namespace Operon::Backend::detail::fast_approx {
-    template<std::size_t P = 0>
-    inline auto constexpr AqImpl(Operon::Scalar x1, Operon::Scalar x2) {
-        auto constexpr p{9999999980506447872.F};
-        return std::abs(x2) > p ? DivImpl<P>(x1, std::abs(x2)) : x1 * ISqrtImpl<P>(1 + x2*x2);
+namespace Operon::Backend {
+OPERON_ISA_NAMESPACE_BEGIN
+namespace detail::fast_approx {
+    template<std::size_t P = 0, typename V>
+    inline auto AqImpl(V x1, V x2) -> V {
+        using T = Real<V>;
+        // 1 + x2^2 overflows above the square root of the largest value
+        auto const p = std::sqrt(std::numeric_limits<T>::max());
+        return Select(Abs(x2) > V(p), DivImpl<P>(x1, Abs(x2)), x1 * ISqrtImpl<P>(V(T{1}) + x2*x2));
     }
-} // namespace Operon::Backend::detail::fast_approx
+} // namespace detail::fast_approx
+OPERON_ISA_NAMESPACE_END
+} // namespace Operon::Backend
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,116 @@
+#ifndef OPERON_BACKEND_FAST_APPROX_COMMON_HPP
+#define OPERON_BACKEND_FAST_APPROX_COMMON_HPP
+
+#include <bit>
+#include <cmath>
+#include <concepts>
+#include <cstdint>
+#include <limits>
+#include <numbers>
+
+#include <eve/module/core.hpp>
+
+#include "operon/interpreter/isa.hpp"
+
+// the approximations are templates over a value type V, which is either a scalar (float or double) or a simd
+// register (eve::wide<float>, eve::wide<double>). the special values are handled with masks instead of branches,
+// so that the same code can run on a whole register at once
+namespace Operon::Backend {
+OPERON_ISA_NAMESPACE_BEGIN
+namespace detail::fast_approx {
+    // layout of the ieee 754 binary32 and binary64 formats
+    template<typename T> struct Ieee;
+
+    template<> struct Ieee<float> {
+        using Int = std::int32_t;
+        static constexpr Int Mantissa{23};
+        static constexpr Int Bias{127};
+        static constexpr float MaxExp{85.F}; // largest argument for which exp is finite (rounded down)
+    };
+
+    template<> struct Ieee<double> {
+        using Int = std::int64_t;
+        static constexpr Int Mantissa{52};
+        static constexpr Int Bias{1023};
+        static constexpr double MaxExp{708.};
+    };
+
+    template<typename V> using Real = eve::element_type_t<V>;
+    template<typename V> using Int = typename Ieee<Real<V>>::Int;
+
+    template<typename V>
+    concept ScalarValue = std::floating_point<V> || std::integral<V>;
+
+    // the magic constants of the bit tricks are given for binary32, as an offset to a multiple (num/den) of the
+    // exponent bias. for binary64 the multiple is taken from its own bias and the offset is scaled to the wider mantissa
+    template<typename T>
+    constexpr auto Magic(std::int64_t bits, std::int64_t num = 1, std::int64_t den = 1) -> typename Ieee<T>::Int {
+        using F = Ieee<float>;
+        using D = Ieee<T>;
+        auto const offset = bits - (num * (std::int64_t{F::Bias} << (F::Mantissa - 1)) / den * 2);
+        return static_cast<typename D::Int>((num * (std::int64_t{D::Bias} << (D::Mantissa - 1)) / den * 2) + (offset << (D::Mantissa - F::Mantissa)));
+    }
+
+    template<typename V>
+    constexpr auto One() -> Int<V> { return Ieee<Real<V>>::Bias << Ieee<Real<V>>::Mantissa; } // bits of 1.0
+
+    template<typename V, typename M>
+    inline auto Select(M mask, V a, V b) -> V {
+        if constexpr (ScalarValue<V>) { return mask ? a : b; } else { return eve::if_else(mask, a, b); }
+    }
+
+    // reinterpret the bits
+    template<typename V>
+    inline auto AsInt(V x) {
+        if constexpr (ScalarValue<V>) { return std::bit_cast<Int<V>>(x); } else { return eve::bit_cast(x, eve::as<eve::as_integer_t<V>>{}); }
+    }
+
+    template<typename V, typename I>
+    inline auto AsReal(I i) -> V {
+        if constexpr (ScalarValue<V>) { return std::bit_cast<V>(i); } else { return eve::bit_cast(i, eve::as<V>{}); }
+    }
+
+    // convert the values (truncating towards zero)
+    template<typename V>
+    inline auto ToInt(V x) {
+        if constexpr (ScalarValue<V>) { return static_cast<Int<V>>(x); } else { return eve::convert(x, eve::as<Int<V>>{}); }
+    }
+
+    template<typename V, typename I>
+    inline auto ToReal(I i) -> V {
+        if constexpr (ScalarValue<V>) { return static_cast<V>(i); } else { return eve::convert(i, eve::as<Real<V>>{}); }
+    }
+
+    template<typename V>
+    inline auto Abs(V x) -> V {
+        if constexpr (ScalarValue<V>) { return std::abs(x); } else { return eve::abs(x); }
+    }
+
+    template<typename V>
+    inline auto Floor(V x) -> V {
+        if constexpr (ScalarValue<V>) { return std::floor(x); } else { return eve::floor(x); }
+    }
+
+    template<typename V>
+    inline auto Trunc(V x) -> V {
+        if constexpr (ScalarValue<V>) { return std::trunc(x); } else { return eve::trunc(x); }
+    }
+
+    // clamp to [lo, hi], nan is mapped to zero (the result is masked out by the caller) to keep the conversions defined
+    template<typename V>
+    inline auto Clamp(V x, Real<V> lo, Real<V> hi) -> V {
+        using T = Real<V>;
+        auto const y = Select(x < V(lo), V(lo), Select(x > V(hi), V(hi), x));
+        return Select(x != x, V(T{0}), y); // NOLINT(misc-redundant-expression)
+    }
+
+    template<typename V>
+    constexpr auto Inf() -> Real<V> { return std::numeric_limits<Real<V>>::infinity(); }
+
+    template<typename V>
+    constexpr auto NaN() -> Real<V> { return std::numeric_limits<Real<V>>::quiet_NaN(); }
+} // namespace detail::fast_approx
+OPERON_ISA_NAMESPACE_END
+} // namespace Operon::Backend
+
+#endif
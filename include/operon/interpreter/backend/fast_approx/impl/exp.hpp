@@ -1,59 +1,68 @@
 #ifndef OPERON_BACKEND_FAST_APPROX_EXP_HPP
 #define OPERON_BACKEND_FAST_APPROX_EXP_HPP
 
-#include "operon/core/types.hpp"
-
-namespace Operon::Backend::detail::fast_approx {
-    inline auto constexpr ExpV1(Operon::Scalar x) -> Operon::Scalar {
-        if (std::isnan(x)) { return std::numeric_limits<Operon::Scalar>::quiet_NaN(); }
-        if (x == 0) { return 1.F; }
-        if (x < -85.F) { return 0; }
-        if (x > +85.F) { return std::numeric_limits<float>::infinity(); }
-
-        auto const f = x * 12102203.161561485 + 1065054451;
-        auto const i = static_cast<int32_t>(f);
-        return std::bit_cast<float>(i);
+#include "common.hpp"
+
+namespace Operon::Backend {
+OPERON_ISA_NAMESPACE_BEGIN
+namespace detail::fast_approx {
+    template<typename V>
+    inline auto ExpSpecial(V x, V y) -> V {
+        using T = Real<V>;
+        constexpr auto m = Ieee<T>::MaxExp;
+        y = Select(x < V(-m), V(T{0}), y);
+        y = Select(x > V(+m), V(Inf<V>()), y);
+        y = Select(x != x, V(NaN<V>()), y); // NOLINT(misc-redundant-expression)
+        return Select(x == V(T{0}), V(T{1}), y);
     }
 
-    // http://stackoverflow.com/questions/10552280/fast-exp-calculation-possible-to-improve-accuracy-without-losing-too-much-perfo/10792321#10792321
-    inline auto constexpr ExpV2(Operon::Scalar x) -> Operon::Scalar {
-        if (std::isnan(x)) { return std::numeric_limits<Operon::Scalar>::quiet_NaN(); }
-        if (x == 0) { return 1.F; }
-        if (x < -85.F) { return 0; }
-        if (x > +85.F) { return std::numeric_limits<float>::infinity(); }
-
-        float t = x * 1.442695041F;
-        float fi = std::floor(t);
-        float f = t - fi;
-        int i = static_cast<int32_t>(fi);
-        auto xf = (0.3371894346f * f + 0.657636276f) * f + 1.00172476f; /* compute 2^f */
-        auto xi = (std::bit_cast<int32_t>(xf) + (i << 23));             /* scale by 2^i */
-        return std::bit_cast<float>(xi);
+    template<typename V>
+    inline auto ExpV1(V x) -> V {
+        using T = Real<V>;
+        constexpr auto m = Ieee<T>::MaxExp;
+        constexpr auto a = static_cast<T>(Int<V>{1} << Ieee<T>::Mantissa) / std::numbers::ln2_v<T>;
+        constexpr auto b = static_cast<T>(Magic<T>(1065054451));
+
+        auto const f = a * Clamp(x, -m, m) + b;
+        return ExpSpecial(x, AsReal<V>(ToInt(f)));
     }
 
-    inline auto constexpr ExpV3(Operon::Scalar x) -> Operon::Scalar {
-        if (std::isnan(x)) { return std::numeric_limits<Operon::Scalar>::quiet_NaN(); }
-        if (x == 0) { return 1.F; }
-        if (x < -85.F) { return 0; }
-        if (x > +85.F) { return std::numeric_limits<float>::infinity(); }
+    // http://stackoverflow.com/questions/10552280/fast-exp-calculation-possible-to-improve-accuracy-without-losing-too-much-perfo/10792321#10792321
+    template<typename V>
+    inline auto ExpV2(V x) -> V {
+        using T = Real<V>;
+        constexpr auto m = Ieee<T>::MaxExp;
 
-        constexpr float a = (1U << 23U) / 0.69314718f;
-        constexpr float b = (1U << 23U) * (127 - 0.043677448f);
-        x = a * x + b;
+        auto const t = Clamp(x, -m, m) * std::numbers::log2e_v<T>;
+        auto const fi = Floor(t);
+        auto const f = t - fi;
+        auto const xf = (T{0.3371894346} * f + T{0.657636276}) * f + T{1.00172476}; /* compute 2^f */
+        auto const xi = AsInt(xf) + (ToInt(fi) << Ieee<T>::Mantissa);                /* scale by 2^i */
+        return ExpSpecial(x, AsReal<V>(xi));
+    }
 
-        constexpr float c = (1U << 23U);
-        constexpr float d = (1U << 23U) * 255;
-        if (x < c || x > d)
-            x = (x < c) ? 0.0f : d;
+    template<typename V>
+    inline auto ExpV3(V x) -> V {
+        using T = Real<V>;
+        constexpr auto m = Ieee<T>::MaxExp;
+        constexpr auto s = static_cast<T>(Int<V>{1} << Ieee<T>::Mantissa);
+        constexpr auto a = s / std::numbers::ln2_v<T>;
+        constexpr auto b = s * (Ieee<T>::Bias - T{0.043677448});
+        constexpr auto c = s;
+        constexpr auto d = s * (2 * Ieee<T>::Bias + 1);
 
-        return std::bit_cast<float>(static_cast<uint32_t>(x));
+        auto f = a * Clamp(x, -m, m) + b;
+        f = Select(f < V(c), V(T{0}), Select(f > V(d), V(d), f));
+        return ExpSpecial(x, AsReal<V>(ToInt(f)));
     }
 
-    template<std::size_t P = 0>
-    inline auto constexpr ExpImpl(Operon::Scalar x) -> Operon::Scalar {
+    template<std::size_t P = 0, typename V>
+    inline auto ExpImpl(V x) -> V {
         if constexpr (P == 0) { return ExpV1(x); }
         else { return ExpV2(x); }
     }
-}  // namespace Operon::Backend::detail::fast_approx
+}  // namespace detail::fast_approx
+OPERON_ISA_NAMESPACE_END
+} // namespace Operon::Backend
 
 #endif
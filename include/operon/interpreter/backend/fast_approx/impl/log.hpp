@@ -1,42 +1,48 @@
 #ifndef OPERON_BACKEND_FAST_APPROX_LOG_HPP
 #define OPERON_BACKEND_FAST_APPROX_LOG_HPP
 
-#include "operon/core/types.hpp"
+#include "common.hpp"
 
-namespace Operon::Backend::detail::fast_approx {
-    template<std::size_t P = 0>
-    inline auto constexpr LogImpl(Operon::Scalar x) -> Operon::Scalar {
-        constexpr auto inf { std::numeric_limits<Operon::Scalar>::infinity() };
-        constexpr auto nan { std::numeric_limits<Operon::Scalar>::quiet_NaN() };
-        if (std::isnan(x)) { return nan; }
-        if (x < 0) { return nan; }
-        if (x == 0) { return -inf; }
-        if (x == 1) { return 0.F; }
-        if (x == inf) { return inf; }
+namespace Operon::Backend {
+OPERON_ISA_NAMESPACE_BEGIN
+namespace detail::fast_approx {
+    template<std::size_t P = 0, typename V>
+    inline auto LogImpl(V x) -> V {
+        using T = Real<V>;
+        constexpr auto ln2 = std::numbers::ln2_v<T>;
+        constexpr auto mantissa = Ieee<T>::Mantissa;
+
+        V y;
         if constexpr (P == 0) {
-            return (std::bit_cast<int32_t>(x) - 1065353217) * 8.262958405176314e-8F;
+            constexpr auto s = ln2 / static_cast<T>(Int<V>{1} << mantissa);
+            y = ToReal<V>(AsInt(x) - Magic<T>(1065353217)) * s;
         } else {
-            auto bx = std::bit_cast<std::uint32_t>(x);
-            auto ex = bx >> 23U;
-            auto t = static_cast<std::int32_t>(ex) - static_cast<std::int32_t>(127);
-            bx = 1065353216 | (bx & 8388607);
-            x = std::bit_cast<float>(bx);
+            auto const bx = AsInt(x);
+            auto const t = ToReal<V>((bx >> mantissa) - Ieee<T>::Bias);
+            auto const m = AsReal<V>((bx & ((Int<V>{1} << mantissa) - 1)) | One<V>());
             if constexpr (P == 1) {
-                return -1.49278+(2.11263+(-0.729104+0.10969*x)*x)*x+0.6931471806*t;
+                y = T{-1.49278}+(T{2.11263}+(T{-0.729104}+T{0.10969}*m)*m)*m+ln2*t;
             } else {
-                return -1.7417939+(2.8212026+(-1.4699568+(0.44717955-0.056570851*x)*x)*x)*x+0.6931471806*t;
+                y = T{-1.7417939}+(T{2.8212026}+(T{-1.4699568}+(T{0.44717955}-T{0.056570851}*m)*m)*m)*m+ln2*t;
             }
         }
+
+        y = Select(x == V(T{1}), V(T{0}), y);
+        y = Select(x == V(Inf<V>()), V(Inf<V>()), y);
+        y = Select(x == V(T{0}), V(-Inf<V>()), y);
+        return Select(x < V(T{0}) || x != x, V(NaN<V>()), y); // NOLINT(misc-redundant-expression)
     }
 
-    template<std::size_t P = 0>
-    inline auto constexpr Log1pImpl(Operon::Scalar x) -> Operon::Scalar  {
-        return LogImpl<P>(1 + x);
+    template<std::size_t P = 0, typename V>
+    inline auto Log1pImpl(V x) -> V {
+        return LogImpl<P>(V(Real<V>{1}) + x);
     }
 
-    template<std::size_t P = 0>
-    inline auto constexpr LogabsImpl(Operon::Scalar x) -> Operon::Scalar  {
-        return LogImpl<P>(std::abs(x));
+    template<std::size_t P = 0, typename V>
+    inline auto LogabsImpl(V x) -> V {
+        return LogImpl<P>(Abs(x));
     }
-}  // namespace Operon::Backend::detail::fast_approx
+}  // namespace detail::fast_approx
+OPERON_ISA_NAMESPACE_END
+} // namespace Operon::Backend
 #endif
@@ -1,53 +1,51 @@
 #ifndef OPERON_BACKEND_FAST_APPROX_SQRT_HPP
 #define OPERON_BACKEND_FAST_APPROX_SQRT_HPP
 
-#include "operon/core/types.hpp"
-
-namespace Operon::Backend::detail::fast_approx {
-    template<std::size_t P = 0>
-    inline auto constexpr ISqrtImpl(Operon::Scalar x) -> Operon::Scalar {
-        static_assert(std::is_same_v<Operon::Scalar, float>, "this function only works in single-precision mode.");
-        constexpr auto nan{ std::numeric_limits<Operon::Scalar>::quiet_NaN() };
-        constexpr auto inf{ std::numeric_limits<Operon::Scalar>::infinity() };
-        constexpr auto fast_sqrt_constant{static_cast<float>(0x5F3759DF)};
-
-        if (std::isnan(x)) { return nan; }
-        if (x < 0) { return nan; }
-        if (x == -0) { return -inf; }
-        if (x == +0) { return +inf; }
-
-        auto xt = x * 0.5F;
-        auto xi = std::bit_cast<int32_t>(x);
-        xi = fast_sqrt_constant - (xi >> 1U);
-        auto xf = std::bit_cast<float>(xi);
+#include "common.hpp"
+
+namespace Operon::Backend {
+OPERON_ISA_NAMESPACE_BEGIN
+namespace detail::fast_approx {
+    template<std::size_t P = 0, typename V>
+    inline auto ISqrtImpl(V x) -> V {
+        using T = Real<V>;
+        constexpr auto m = Magic<T>(0x5F3759DF, 3, 2);
+
+        auto const xt = x * T{0.5};
+        auto xf = AsReal<V>(m - (AsInt(x) >> 1));
         for (auto i = 0UL; i < P; ++i) {
-            xf = xf * (float{1.5} - (xt * (xf * xf)));
+            xf = xf * (T{1.5} - (xt * (xf * xf)));
         }
-        return xf;
+
+        xf = Select(x == V(Inf<V>()), V(T{0}), xf);
+        xf = Select(x == V(T{0}), V(Inf<V>()), xf);
+        return Select(x < V(T{0}) || x != x, V(NaN<V>()), xf); // NOLINT(misc-redundant-expression)
     }
 
-    template<std::size_t P = 0>
-    inline auto constexpr SqrtImpl(Operon::Scalar x) -> Operon::Scalar {
-        constexpr auto nan = std::numeric_limits<Operon::Scalar>::quiet_NaN();
-        if (std::isnan(x)) { return nan; }
-        if (x < 0) { return nan; }
-        if (x == 0) { return 0; }
+    template<std::size_t P = 0, typename V>
+    inline auto SqrtImpl(V x) -> V {
+        using T = Real<V>;
+
+        V y;
         if constexpr (P == 0) {
-            auto xi = std::bit_cast<int32_t>(x);
-            xi -= 0x3F800000;
-            xi = ((((xi >> 31U) & 1) << 31U) | ((xi >> 1U) & 0x7FFFFFFF));
-            xi += 0x3F800000;
-            xi &= 0xFFFFFFFF;
-            return std::bit_cast<float>(xi);
+            // halve the exponent, the arithmetic shift keeps the sign of the unbiased exponent
+            constexpr auto one = One<V>();
+            y = AsReal<V>(((AsInt(x) - one) >> 1) + one);
         } else {
-            return x * ISqrtImpl<P>(x);
+            y = x * ISqrtImpl<P>(x);
         }
+
+        y = Select(x == V(Inf<V>()), V(Inf<V>()), y);
+        y = Select(x == V(T{0}), V(T{0}), y);
+        return Select(x < V(T{0}) || x != x, V(NaN<V>()), y); // NOLINT(misc-redundant-expression)
     }
 
-    template<std::size_t P = 0>
-    inline auto constexpr SqrtabsImpl(Operon::Scalar x) {
-        return SqrtImpl<P>(std::abs(x));
+    template<std::size_t P = 0, typename V>
+    inline auto SqrtabsImpl(V x) -> V {
+        return SqrtImpl<P>(Abs(x));
     }
-}  // namespace Operon::Backend::detail::fast_approx
+}  // namespace detail::fast_approx
+OPERON_ISA_NAMESPACE_END
+} // namespace Operon::Backend
 
 #endif
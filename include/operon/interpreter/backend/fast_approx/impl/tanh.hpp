@@ -1,46 +1,43 @@
 #ifndef OPERON_BACKEND_FAST_APPROX_TANH_HPP
 #define OPERON_BACKEND_FAST_APPROX_TANH_HPP
 
-#include "operon/core/types.hpp"
+#include "common.hpp"
 #include "inv.hpp"
 
-namespace Operon::Backend::detail::fast_approx {
-    template<std::size_t P = 0>
-    inline auto constexpr TanhImpl(Operon::Scalar x) -> Operon::Scalar {
-            constexpr auto nan { std::numeric_limits<Operon::Scalar>::quiet_NaN() };
-            if (std::isnan(x)) { return nan; }
-            if (x == 0) { return 0; }
+namespace Operon::Backend {
+OPERON_ISA_NAMESPACE_BEGIN
+namespace detail::fast_approx {
+    template<std::size_t P = 0, typename V>
+    inline auto TanhImpl(V x) -> V {
+            using T = Real<V>;
 
+            V y;
             if constexpr (P == 0) {
-                if (x <= -3) {
-                    return -1.F;
-                }
-                if (x >= +3) {
-                    return +1.F;
-                }
-                auto const r = InvImpl<P>(x * x + 3.F);
-                auto constexpr a = 8.F / 3.F;
-                auto constexpr b = 1.F / 9.F;
-                return x * (a * r + b);
+                auto const r = InvImpl<P>(x * x + T{3});
+                auto constexpr a = T{8} / T{3};
+                auto constexpr b = T{1} / T{9};
+                y = x * (a * r + b);
+                y = Select(x <= V(T{-3}), V(T{-1}), Select(x >= V(T{+3}), V(T{+1}), y));
             } else {
-                if (x < -85) { return -1.F; }
-                if (x > +85) { return +1.F; }
-
+                constexpr auto m = Ieee<T>::MaxExp;
                 auto expZeroShift = [](auto x) {
-                    constexpr auto shift{23U};
-                    constexpr auto ff{127U};
-                    auto a = DivImpl<P>((1U << shift), std::numbers::ln2_v<Operon::Scalar>);
-                    auto b = (ff * (1U << shift));
-                    auto f = a * x + b;
-                    auto i = static_cast<int32_t>(f);
-                    return std::bit_cast<float>(i);
+                    constexpr auto a = static_cast<T>(Int<V>{1} << Ieee<T>::Mantissa) / std::numbers::ln2_v<T>;
+                    constexpr auto b = static_cast<T>(One<V>());
+                    return AsReal<V>(ToInt(a * x + b));
                 };
 
-                auto a = expZeroShift(x);
-                auto b = expZeroShift(-x);
-                return DivImpl<P>(a-b, a+b);
+                auto const xc = Clamp(x, -m, m);
+                auto a = expZeroShift(xc);
+                auto b = expZeroShift(-xc);
+                y = DivImpl<P>(a-b, a+b);
+                y = Select(x < V(-m), V(T{-1}), Select(x > V(+m), V(T{+1}), y));
             }
+
+            y = Select(x == V(T{0}), V(T{0}), y);
+            return Select(x != x, V(NaN<V>()), y); // NOLINT(misc-redundant-expression)
         }
-}  // namespace Operon::Backend::detail::fast_approx
+}  // namespace detail::fast_approx
+OPERON_ISA_NAMESPACE_END
+} // namespace Operon::Backend
 
 #endif
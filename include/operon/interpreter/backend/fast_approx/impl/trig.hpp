@@ -1,58 +1,69 @@
 #ifndef OPERON_BACKEND_FAST_APPROX_TRIG_HPP
 #define OPERON_BACKEND_FAST_APPROX_TRIG_HPP
 
-#include "operon/core/types.hpp"
+#include "common.hpp"
 #include "inv.hpp"
-#include "exp.hpp"
 
-namespace Operon::Backend::detail::fast_approx {
-    template<std::size_t P = 0>
-    inline auto constexpr CosImpl(Operon::Scalar x) -> Operon::Scalar {
-        if (!std::isfinite(x)) { return std::numeric_limits<Operon::Scalar>::quiet_NaN(); }
-        if (x == 0) { return 1.F; }
+namespace Operon::Backend {
+OPERON_ISA_NAMESPACE_BEGIN
+namespace detail::fast_approx {
+    // parabolic approximation of sin(pi * (z - 1)), the argument is reduced to [-1, 1)
+    template<typename V>
+    inline auto Parabola(V z) -> V {
+        using T = Real<V>;
+        z = z - T{2} * Trunc(z / T{2}) - T{1};
+        return T{4} * Select(z < V(T{0}), z*z + z, -z*z + z);
+    }
+
+    template<std::size_t P = 0, typename V>
+    inline auto CosImpl(V x) -> V {
+        using T = Real<V>;
 
+        V y;
         if constexpr (P == 0) {
-            auto constexpr invPi = std::numbers::inv_pi_v<float>;
-            x = std::abs(x) * invPi + 1.5F;
-            x = x - 2 * static_cast<float>(static_cast<int>(x/2)) - 1.F;
-            return 4 * (x < 0 ? (x*x + x) : (-x*x + x));
+            y = Parabola(Abs(x) * std::numbers::inv_pi_v<T> + T{1.5});
         } else {
-            constexpr float tp = std::numbers::inv_pi_v<float>/2;
-            constexpr float a{.25F};
-            constexpr float b{16.F};
-            constexpr float c{.50F};
-            constexpr float d{.225F};
-            x *= tp;
-            x -= a + std::floor(x + a);
-            x *= b * (std::abs(x) - c);
+            constexpr T tp = std::numbers::inv_pi_v<T>/2;
+            constexpr T a{.25};
+            constexpr T b{16.};
+            constexpr T c{.50};
+            constexpr T d{.225};
+            y = x * tp;
+            y -= a + Floor(y + a);
+            y *= b * (Abs(y) - c);
             if constexpr (P >= 1) {
-                x += d * x * (std::abs(x) - 1.F); // another step for extra precision
+                y += d * y * (Abs(y) - T{1}); // another step for extra precision
             }
-            return x;
         }
+
+        y = Select(x == V(T{0}), V(T{1}), y);
+        return Select(Abs(x) == V(Inf<V>()) || x != x, V(NaN<V>()), y); // NOLINT(misc-redundant-expression)
     }
 
-    template<std::size_t P = 0>
-    inline auto constexpr SinImpl(Operon::Scalar x) -> Operon::Scalar {
-        if (!std::isfinite(x)) { return std::numeric_limits<Operon::Scalar>::quiet_NaN(); }
-        if (x == 0) { return x; }
+    template<std::size_t P = 0, typename V>
+    inline auto SinImpl(V x) -> V {
+        using T = Real<V>;
+
+        V y;
         if constexpr (P == 0) {
-            auto constexpr invPi = std::numbers::inv_pi_v<float>;
-            auto const offset = x < 0 ? 2.F : 1.F;
-            x = std::abs(x) * invPi + offset;
-            x = x - 2 * static_cast<float>(static_cast<int>(x/2)) - 1.F;
-            return 4 * (x < 0 ? (x*x + x) : (-x*x + x));
+            auto const offset = Select(x < V(T{0}), V(T{2}), V(T{1}));
+            y = Parabola(Abs(x) * std::numbers::inv_pi_v<T> + offset);
         } else {
-            constexpr float tp = std::numbers::pi_v<float>/2;
-            return CosImpl<P>(x-tp);
+            constexpr T tp = std::numbers::pi_v<T>/2;
+            y = CosImpl<P>(x-tp);
         }
+
+        y = Select(x == V(T{0}), x, y);
+        return Select(Abs(x) == V(Inf<V>()) || x != x, V(NaN<V>()), y); // NOLINT(misc-redundant-expression)
     }
 
-    template<std::size_t P = 0>
-    inline auto constexpr TanImpl(Operon::Scalar x) -> Operon::Scalar {
-        if (x == 0) { return x; }
-        return DivImpl<P>(SinImpl<P>(x), CosImpl<P>(x));
+    template<std::size_t P = 0, typename V>
+    inline auto TanImpl(V x) -> V {
+        using T = Real<V>;
+        return Select(x == V(T{0}), x, DivImpl<P>(SinImpl<P>(x), CosImpl<P>(x)));
     }
-}  // namespace Operon::Backend::detail::fast_approx
+}  // namespace detail::fast_approx
+OPERON_ISA_NAMESPACE_END
+} // namespace Operon::Backend
 
 #endif
@@ -8,6 +8,7 @@
 #include "functions.hpp"
 
 namespace Operon::Backend {
+OPERON_ISA_NAMESPACE_BEGIN
 namespace detail {
     template<typename T>
     inline auto IsNaN(T value) { return std::isnan(value); }
@@ -200,5 +201,6 @@ namespace detail {
     auto Cbrt(std::vector<Operon::Node> const& /*nodes*/, Backend::View<T const, S> primal, Backend::View<T> trace, std::integral auto i, std::integral auto j) {
         Col(trace, j) = T{1} / (T{3} * Fastor::pow(Col(primal, i), 2));
     }
+OPERON_ISA_NAMESPACE_END
 }  // namespace Operon::Backend
 #endif
\ No newline at end of file
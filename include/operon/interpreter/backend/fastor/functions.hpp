@@ -11,6 +11,7 @@
 #include "operon/core/node.hpp"
 
 namespace Operon::Backend {
+OPERON_ISA_NAMESPACE_BEGIN
     template<typename T, std::size_t S>
     auto Map(T* ptr) { return Fastor::TensorMap<T, S>(ptr); }
 
@@ -199,6 +200,7 @@ namespace Operon::Backend {
     auto Cbrt(T* res, T const* arg) {
         Map<T, S>(res) = Fastor::cbrt(Map<T, S>(arg));
     }
+OPERON_ISA_NAMESPACE_END
 } // namespace Operon::Backend
 
 #endif
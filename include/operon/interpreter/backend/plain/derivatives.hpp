@@ -8,6 +8,7 @@
 #include "functions.hpp"
 
 namespace Operon::Backend {
+OPERON_ISA_NAMESPACE_BEGIN
 namespace detail {
     template<typename T>
     inline auto IsNaN(T value) { return std::isnan(value); }
@@ -260,6 +261,7 @@ namespace detail {
         auto const* pi = Ptr(primal, i);
         std::transform(pi, pi+S, res, [](auto x){ return T{1} / (T{3} * x*x); });
     }
+OPERON_ISA_NAMESPACE_END
 }  // namespace Operon::Backend
 
 #endif
\ No newline at end of file
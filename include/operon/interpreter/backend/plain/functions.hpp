@@ -8,6 +8,7 @@
 #include "operon/core/node.hpp"
 
 namespace Operon::Backend {
+OPERON_ISA_NAMESPACE_BEGIN
     // utility
     template<typename T, std::size_t S>
     auto Fill(T* res, T value) {
@@ -196,6 +197,7 @@ namespace Operon::Backend {
     auto Cbrt(T* res, T const* arg) {
         std::transform(arg, arg+S, res, [](auto x) { return std::cbrt(x); });
     }
+OPERON_ISA_NAMESPACE_END
 } // namespace Operon::Backend
 
 #endif
\ No newline at end of file
@@ -4,6 +4,7 @@
 #include "functions.hpp"
 
 namespace Operon::Backend {
+OPERON_ISA_NAMESPACE_BEGIN
 namespace detail {
     template<typename T>
     inline auto IsNaN(T value) { return std::isnan(value); }
@@ -256,5 +257,6 @@ namespace detail {
         auto const* pi = Ptr(primal, i);
         std::transform(pi, pi+S, res, [](auto x){ return detail::vdt::Inv(T{3} * x*x); });
     }
+OPERON_ISA_NAMESPACE_END
 }  // namespace Operon::Backend
 #endif
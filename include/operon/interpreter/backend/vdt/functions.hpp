@@ -10,6 +10,7 @@
 #include "operon/core/node.hpp"
 
 namespace Operon::Backend {
+OPERON_ISA_NAMESPACE_BEGIN
 
     namespace detail::vdt {
         // we need wrappers due to VDT calling conventions
@@ -368,6 +369,7 @@ namespace Operon::Backend {
     auto Cbrt(T* res, T const* arg) {
         std::transform(arg, arg+S, res, detail::vdt::Cbrt);
     }
+OPERON_ISA_NAMESPACE_END
 } // namespace Operon::Backend
 
 #endif
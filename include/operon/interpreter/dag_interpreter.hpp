@@ -0,0 +1,290 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2024 Heal Research
+
+#ifndef OPERON_INTERPRETER_DAG_INTERPRETER_HPP
+#define OPERON_INTERPRETER_DAG_INTERPRETER_HPP
+
+#include <algorithm>
+#include <bit>
+#include <concepts>
+#include <cstring>
+#include <functional>
+#include <ranges>
+#include <vector>
+
+#include "operon/hash/hash.hpp"
+#include "tape.hpp"
+
+namespace Operon {
+
+// evaluates a group of trees as a directed acyclic graph of unique subtrees: identical subtrees (same
+// symbols, same coefficients, same children) are merged when the group is compiled, so that each of
+// them is evaluated only once per row block and its output is shared by all the trees containing it.
+// the subtrees are identified by a merkle-style hash over the node and the ids of its (already merged)
+// children, candidates with a matching hash are compared exactly so collisions can never merge
+// different subtrees. the children are kept in their original order, hence the results are identical
+// to those of the tree-wise Interpreter. the built-in primitives read their arguments directly from the
+// outputs of the children (see Dispatch::IndexedOp), only the user-registered callables go through a
+// stencil. the buffers only grow, so an interpreter can be reused for many groups (e.g. one per worker).
+template<typename T = Operon::Scalar, typename DTable = DefaultDispatch>
+class DagInterpreter {
+public:
+    static constexpr auto BatchSize = DTable::template BatchSize<T>;
+
+    using Kernel = typename DTable::template Kernel<T>;
+    using Indexed = Dispatch::IndexedFunction<T, BatchSize>;
+
+    struct Instruction {
+        T Coefficient{1};                       // node weight (the value for constants)
+        Operon::Scalar const* Values{nullptr};  // dataset column (variables only)
+        Kernel Function{};                      // primitive resolved from the dispatch table
+        Indexed Direct{nullptr};                // built-in primitive reading the children outputs in place
+        Operon::Hash HashValue{};               // node hash value (symbol type or variable)
+        int64_t Arity{0};
+        int64_t Children{0};                    // offset of the children ids
+        int64_t Stencil{-1};                    // node layout expected by a user-registered primitive
+    };
+
+    DagInterpreter(DTable const& dtable, Operon::Dataset const& dataset)
+        : dtable_(dtable)
+        , dataset_(dataset)
+    {
+    }
+
+    template<std::ranges::random_access_range R, typename Proj = std::identity>
+    auto Compile(R const& trees, Proj proj = {}) -> void
+    {
+        code_.clear();
+        children_.clear();
+        roots_.clear();
+        unique_.clear();
+        totalNodes_ = 0;
+
+        auto& ids = ids_;
+        auto& key = key_;
+
+        for (auto const& t : trees) {
+            Operon::Tree const& tree = std::invoke(proj, t);
+            auto const& nodes = tree.Nodes();
+            ids.resize(nodes.size());
+
+            for (auto i = 0UL; i < nodes.size(); ++i) {
+                auto const& n = nodes[i];
+                key.clear();
+                key.push_back(n.HashValue);
+                key.push_back(Bits(n.Value));
+                for (auto j : Tree::Indices(nodes, i)) {
+                    key.push_back(static_cast<uint64_t>(ids[j]));
+                }
+                auto const h = hasher_(std::bit_cast<uint8_t const*>(key.data()), key.size() * sizeof(uint64_t)); // NOLINT
+
+                if (auto it = unique_.find(h); it != unique_.end() && Matches(it->second, n, key)) {
+                    ids[i] = it->second;
+                    continue;
+                }
+                ids[i] = Add(n, key);
+                unique_.emplace(h, ids[i]);
+            }
+
+            roots_.push_back(ids.back());
+            totalNodes_ += nodes.size();
+        }
+
+        constexpr int64_t S{ BatchSize };
+        auto const nn { std::ssize(code_) };
+        if (capacity_ < nn) {
+            primalStorage_ = detail::AllocateAligned<T, Backend::DefaultAlignment>(S * nn);
+            capacity_ = nn;
+        }
+        primal_ = Backend::View<T, BatchSize>(primalStorage_.get(), S, nn);
+        for (auto i = 0L; i < nn; ++i) {
+            if (code_[i].Values == nullptr && !code_[i].Function) {
+                Fill<T, S>(primal_, static_cast<int>(i), code_[i].Coefficient);
+            }
+        }
+    }
+
+    // the result holds range.Size() values for each tree, one tree after the other
+    auto Evaluate(Operon::Range range, Operon::Span<T> result) const -> void
+    {
+        auto const len { range.Size() };
+        EXPECT(result.size() >= roots_.size() * len);
+        Evaluate(range, [&](std::size_t i) { return result.subspan(i * len, len); });
+    }
+
+    // the output callable returns the result span for the i-th tree
+    template<typename Out>
+    requires std::invocable<Out, std::size_t>
+    auto Evaluate(Operon::Range range, Out&& output) const -> void
+    {
+        auto const len { static_cast<int64_t>(range.Size()) };
+        EvaluateBlocks(range, [&](int64_t row, int64_t rem) {
+            for (auto t = 0UL; t < roots_.size(); ++t) {
+                auto out = output(t);
+                if (std::ssize(out) != len) { continue; }
+                std::ranges::copy(Output(t).first(rem), out.data() + row);
+            }
+        });
+    }
+
+    // evaluates the graph one block of rows at a time and calls block(row, rem) after each of them, the
+    // outputs of the block are then available through Output. the trees do not need a result buffer, e.g.
+    // their fitness can be accumulated block by block
+    template<typename F>
+    requires std::invocable<F, int64_t, int64_t>
+    auto EvaluateBlocks(Operon::Range range, F&& block) const -> void
+    {
+        auto const start { static_cast<int64_t>(range.Start()) };
+        auto const len { static_cast<int64_t>(range.Size()) };
+        constexpr int64_t S{ BatchSize };
+
+        for (auto row = 0L; row < len; row += S) {
+            auto const rem { std::min(S, len - row) };
+            Operon::Range rg(start + row, start + row + rem);
+
+            for (auto i = 0L; i < std::ssize(code_); ++i) {
+                auto const& ins = code_[i];
+                auto* ptr = primal_.data_handle() + i * S;
+                auto const p = ins.Coefficient;
+
+                if (ins.Values != nullptr) {
+                    std::ranges::transform(std::span(ins.Values + start + row, rem), ptr, [p](auto x) { return x * p; });
+                    continue;
+                }
+                if (ins.Direct != nullptr) {
+                    ins.Direct(primal_, i, { children_.data() + ins.Children, static_cast<std::size_t>(ins.Arity) });
+                } else if (ins.Function) {
+                    // copy the children outputs where the callable expects them and evaluate it in place
+                    auto const& stencil = stencils_[ins.Stencil];
+                    auto const k { ins.Arity };
+                    for (auto c = 0L; c < k; ++c) {
+                        auto const* src = primal_.data_handle() + children_[ins.Children + c] * S;
+                        std::ranges::copy_n(src, S, scratch_.data_handle() + (k - 1 - c) * S);
+                    }
+                    ins.Function(stencil, scratch_, k, rg);
+                    std::ranges::copy_n(scratch_.data_handle() + k * S, rem, ptr);
+                } else {
+                    continue; // constants are filled when compiling
+                }
+                if (p != T{1}) {
+                    std::ranges::transform(std::span(ptr, rem), ptr, [p](auto x) { return x * p; });
+                }
+            }
+            std::invoke(block, row, rem);
+        }
+    }
+
+    // the outputs of the i-th tree for the current block of rows (see EvaluateBlocks)
+    [[nodiscard]] auto Output(std::size_t i) const -> Operon::Span<T const>
+    {
+        return { primal_.data_handle() + roots_[i] * BatchSize, BatchSize };
+    }
+
+    // number of compiled trees
+    [[nodiscard]] auto Size() const -> std::size_t { return roots_.size(); }
+
+    [[nodiscard]] auto GetDispatchTable() const -> DTable const& { return dtable_.get(); }
+    [[nodiscard]] auto GetDataset() const -> Operon::Dataset const& { return dataset_.get(); }
+
+    // number of nodes in the compiled trees
+    [[nodiscard]] auto TotalNodes() const -> std::size_t { return totalNodes_; }
+    // number of unique subtrees (nodes of the graph)
+    [[nodiscard]] auto UniqueNodes() const -> std::size_t { return code_.size(); }
+    // fraction of the nodes whose evaluation was saved by merging
+    [[nodiscard]] auto DedupRatio() const -> double
+    {
+        return totalNodes_ == 0 ? 0.0 : 1.0 - static_cast<double>(code_.size()) / static_cast<double>(totalNodes_);
+    }
+
+    [[nodiscard]] auto Code() const -> Operon::Span<Instruction const> { return { code_.data(), code_.size() }; }
+
+private:
+    static auto Bits(Operon::Scalar value) -> uint64_t
+    {
+        uint64_t bits{0};
+        std::memcpy(&bits, &value, sizeof(value));
+        return bits;
+    }
+
+    // exact comparison of a graph node with a tree node whose children were already mapped
+    auto Matches(int64_t id, Node const& n, std::vector<uint64_t> const& key) const -> bool
+    {
+        auto const& ins = code_[id];
+        if (ins.HashValue != n.HashValue || ins.Arity != n.Arity || Bits(static_cast<Operon::Scalar>(ins.Coefficient)) != key[1]) { return false; }
+        return std::ranges::equal(std::span(children_).subspan(ins.Children, ins.Arity), std::span(key).subspan(2),
+            [](auto a, auto b) { return static_cast<uint64_t>(a) == b; });
+    }
+
+    auto Add(Node const& n, std::vector<uint64_t> const& key) -> int64_t
+    {
+        Instruction ins{ .Coefficient = T{n.Value}, .HashValue = n.HashValue, .Arity = n.Arity };
+        ins.Children = std::ssize(children_);
+        std::ranges::transform(std::span(key).subspan(2), std::back_inserter(children_), [](auto x) { return static_cast<int64_t>(x); });
+
+        if (n.IsVariable()) {
+            ins.Values = dataset_.get().GetValues(n.HashValue).data();
+        } else if (!n.IsLeaf()) {
+            auto const& dtable = dtable_.get();
+            if (!dtable.Contains(n.HashValue)) {
+                throw std::runtime_error(fmt::format("Missing primitive for node {}\n", n.Name()));
+            }
+            ins.Direct = dtable.template GetIndexed<T>(n.HashValue);
+            if (ins.Direct == nullptr) {
+                ins.Function = dtable.template GetFunction<T>(n.HashValue);
+                ins.Stencil = GetStencil(n);
+            }
+        }
+        code_.push_back(ins);
+        return std::ssize(code_) - 1;
+    }
+
+    // the user-registered primitives locate the arguments through the node lengths: a stencil places the
+    // arguments (as leaves) right before a copy of the function node, the same layout for all nodes of that type
+    auto GetStencil(Node const& n) -> int64_t
+    {
+        auto const key = n.HashValue ^ (static_cast<Operon::Hash>(n.Arity) << 48U);
+        if (auto it = stencilMap_.find(key); it != stencilMap_.end()) { return it->second; }
+
+        Operon::Vector<Node> stencil(n.Arity, Node::Constant(0));
+        auto f = n;
+        f.Length = n.Arity;
+        stencil.push_back(f);
+        stencils_.push_back(std::move(stencil));
+
+        // the scratch buffer must hold the widest stencil
+        constexpr int64_t S{ BatchSize };
+        if (scratch_.extent(1) < n.Arity + 1) {
+            scratchStorage_ = detail::AllocateAligned<T, Backend::DefaultAlignment>(S * (n.Arity + 1));
+            scratch_ = Backend::View<T, BatchSize>(scratchStorage_.get(), S, n.Arity + 1);
+        }
+
+        auto const idx { std::ssize(stencils_) - 1 };
+        stencilMap_.emplace(key, idx);
+        return idx;
+    }
+
+    std::reference_wrapper<DTable const> dtable_;
+    std::reference_wrapper<Operon::Dataset const> dataset_;
+    Operon::Hasher hasher_;
+
+    std::vector<Instruction> code_;      // unique subtrees in topological (postfix) order
+    std::vector<int64_t> children_;      // children ids of the function nodes, in tree order
+    std::vector<int64_t> roots_;         // graph node of each tree
+    Operon::Map<Operon::Hash, int64_t> unique_;
+    std::size_t totalNodes_{0};
+    std::vector<int64_t> ids_;           // graph node of each tree node (compile scratch)
+    std::vector<uint64_t> key_;          // hashed node key (compile scratch)
+
+    std::vector<Operon::Vector<Node>> stencils_;
+    Operon::Map<Operon::Hash, int64_t> stencilMap_;
+
+    int64_t capacity_{0};
+    Backend::View<T, BatchSize> primal_;
+    detail::AlignedUnique<T> primalStorage_;
+    Backend::View<T, BatchSize> scratch_;
+    detail::AlignedUnique<T> scratchStorage_;
+};
+
+} // namespace Operon
+
+#endif
@@ -7,6 +7,7 @@
 #include "functions.hpp"
 
 namespace Operon {
+OPERON_ISA_NAMESPACE_BEGIN
     // default function to catch any missing template specializations
     template<typename T, Operon::NodeType N  = Operon::NodeTypes::NoType, std::size_t S = Backend::BatchSize<T>>
     struct Diff {
@@ -213,6 +214,7 @@ namespace Operon {
             Backend::Tanh<T, S>(nodes, primal, trace, i, j);
         }
     };
+OPERON_ISA_NAMESPACE_END
 } // namespace Operon
 
 #endif
\ No newline at end of file
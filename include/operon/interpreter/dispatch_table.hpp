@@ -4,8 +4,12 @@
 #ifndef OPERON_EVAL_DETAIL
 #define OPERON_EVAL_DETAIL
 
+#include <algorithm>
+#include <array>
+#include <bit>
 #include <Eigen/Dense>
 #include <fmt/core.h>
+#include <functional>
 #include <optional>
 #include <cstddef>
 #include <tuple>
@@ -14,11 +18,13 @@
 #include "operon/core/range.hpp"
 #include "operon/core/types.hpp"
 #include "derivatives.hpp"
+#include "isa.hpp"
+#include "operon/operon_export.hpp"
 
 
 namespace Operon {
 // data types used by the dispatch table and the interpreter
-struct Dispatch {
+namespace Dispatch {
 
 template<typename T>
 //requires std::is_arithmetic_v<T>
@@ -30,6 +36,76 @@ using Callable = std::function<void(Operon::Vector<Node> const&, Backend::View<T
 template<typename T, std::size_t S>
 using CallableDiff = std::function<void(Operon::Vector<Node> const&, Backend::View<T const, S>, Backend::View<T, S>, int, int)>;
 
+// the built-in primitives are plain functions, called through a function pointer
+template<typename T, std::size_t S>
+using Function = void(*)(Operon::Vector<Node> const&, Backend::View<T, S>, size_t, Operon::Range);
+
+template<typename T, std::size_t S>
+using Derivative = void(*)(Operon::Vector<Node> const&, Backend::View<T const, S>, Backend::View<T, S>, int, int);
+
+// a resolved dispatch table entry: either a built-in primitive or a user-registered callable (owned by
+// the dispatch table), the latter go through the type-erased call
+template<typename Ptr, typename Fn>
+struct KernelImpl {
+    Ptr Builtin{nullptr};
+    Fn const* Dynamic{nullptr};
+
+    explicit operator bool() const noexcept { return Builtin != nullptr || Dynamic != nullptr; }
+
+    template<typename... Args>
+    inline auto operator()(Args&&... args) const -> void
+    {
+        if (Builtin != nullptr) {
+            Builtin(std::forward<Args>(args)...);
+        } else {
+            std::invoke(*Dynamic, std::forward<Args>(args)...);
+        }
+    }
+};
+
+template<typename T, std::size_t S>
+using Kernel = KernelImpl<Function<T, S>, Callable<T, S>>;
+
+template<typename T, std::size_t S>
+using KernelDiff = KernelImpl<Derivative<T, S>, CallableDiff<T, S>>;
+
+// operand of the fused n-ary primitives: a column of values (a primal column or directly the dataset
+// values of a variable) and its weight, so that weighted variables do not need their own primal column
+template<typename T>
+struct Operand {
+    T const* Values;
+    T Weight;
+};
+
+template<typename T>
+using CallableFused = void(*)(T*, Operon::Span<Operand<T> const>, int64_t);
+
+// the built-in primitives with their arguments at arbitrary columns of the primal buffer (children in
+// NaryOp order, the first one is the closest to the parent), for callers which do not lay the arguments
+// out as a tree (e.g. the shared subtrees of the DagInterpreter). the arguments of the n-ary functions
+// are grouped like in NaryOp, so the results are identical
+template<typename T, std::size_t S>
+using IndexedFunction = void(*)(Backend::View<T, S>, int64_t, Operon::Span<int64_t const>);
+
+struct Noop {
+    template<typename... Args>
+    void operator()(Args&&... /*unused*/) {}
+};
+
+// the symbols up to (excluding) dynamic, constant and variable
+static auto constexpr BuiltinCount = NodeTypes::Count - 3;
+
+// the built-in primitives of one evaluation type, indexed by NodeTypes::GetIndex
+template<typename T, std::size_t S>
+struct Builtins {
+    std::array<Function<T, S>, NodeTypes::Count> Functions{};
+    std::array<Derivative<T, S>, NodeTypes::Count> Derivatives{};
+    std::array<CallableFused<T>, NodeTypes::Count> Fused{}; // fused n-ary primitives (add, sub, mul)
+    std::array<IndexedFunction<T, S>, NodeTypes::Count> Indexed{}; // arguments at arbitrary columns
+};
+
+// the kernels (see OPERON_ISA_NAMESPACE in isa.hpp)
+OPERON_ISA_NAMESPACE_BEGIN
 // dispatching mechanism
 // compared to the simple/naive way of evaluating n-ary symbols, this method has the following advantages:
 // 1) improved performance: the naive method accumulates into the result for each argument, leading to unnecessary assignments
@@ -37,7 +113,7 @@ using CallableDiff = std::function<void(Operon::Vector<Node> const&, Backend::Vi
 //    if arity > 4, one accumulation is performed every 4 args
 template<NodeType Type, typename T, std::size_t S>
 requires Node::IsNary<Type>
-static inline void NaryOp(Operon::Vector<Node> const& nodes, Backend::View<T, S> data, size_t parentIndex, Operon::Range /*unused*/)
+inline void NaryOp(Operon::Vector<Node> const& nodes, Backend::View<T, S> data, size_t parentIndex, Operon::Range /*unused*/)
 {
     static_assert(Type < NodeType::Aq);
     const auto nextArg = [&](size_t i) { return i - (nodes[i].Length + 1); };
@@ -86,7 +162,7 @@ static inline void NaryOp(Operon::Vector<Node> const& nodes, Backend::View<T, S>
 
 template<NodeType Type, typename T, std::size_t S>
 requires Node::IsBinary<Type>
-static inline void BinaryOp(Operon::Vector<Node> const& nodes, Backend::View<T, S> m, size_t i, Operon::Range /*unused*/)
+inline void BinaryOp(Operon::Vector<Node> const& nodes, Backend::View<T, S> m, size_t i, Operon::Range /*unused*/)
 {
     auto j = i - 1;
     auto k = j - nodes[j].Length - 1;
@@ -95,46 +171,170 @@ static inline void BinaryOp(Operon::Vector<Node> const& nodes, Backend::View<T,
 
 template<NodeType Type, typename T, std::size_t S>
 requires Node::IsUnary<Type>
-static inline void UnaryOp(Operon::Vector<Node> const& /*unused*/, Backend::View<T, S> m, size_t i, Operon::Range /*unused*/)
+inline void UnaryOp(Operon::Vector<Node> const& /*unused*/, Backend::View<T, S> m, size_t i, Operon::Range /*unused*/)
 {
     Func<T, Type, false>{}(m, i, i-1);
 }
 
-struct Noop {
-    template<typename... Args>
-    void operator()(Args&&... /*unused*/) {}
-};
+// the operand groups are the same as in NaryOp and the expressions have the same shape as in the
+// backends (right folds, leading operand for sub), only add, sub and mul are fused because they are
+// exact in every backend (division is approximated by some of them)
+template<NodeType Type>
+requires (Type == NodeType::Add || Type == NodeType::Sub || Type == NodeType::Mul)
+inline auto FusedFold(auto const&... args)
+{
+    if constexpr (Type == NodeType::Mul) { return (args * ...); } else { return (args + ...); }
+}
+
+template<NodeType Type>
+inline void FusedAssign(auto& res, bool continued, auto const& first, auto const&... rest)
+{
+    if (continued) {
+        if constexpr (Type == NodeType::Add) { res = res + FusedFold<Type>(first, rest...); }
+        if constexpr (Type == NodeType::Sub) { res = res - FusedFold<Type>(first, rest...); }
+        if constexpr (Type == NodeType::Mul) { res = res * FusedFold<Type>(first, rest...); }
+    } else if constexpr (sizeof...(rest) == 0) {
+        if constexpr (Type == NodeType::Sub) { res = -first; } else { res = first; }
+    } else if constexpr (Type == NodeType::Sub) {
+        res = first - FusedFold<Type>(rest...);
+    } else {
+        res = FusedFold<Type>(first, rest...);
+    }
+}
+
+template<NodeType Type, typename T, int N>
+inline void FusedOpImpl(T* result, Operon::Span<Operand<T> const> args, int64_t n)
+{
+    using A = Eigen::Array<T, N, 1>;
+    Eigen::Map<A> res(result, n);
+    auto const x = [&](auto j) { return Eigen::Map<A const>(args[j].Values, n) * args[j].Weight; };
+
+    bool continued = false;
+    for (auto i = 0UL; i < args.size(); i += 4) {
+        switch (std::min(args.size() - i, 4UL)) {
+        case 1: { FusedAssign<Type>(res, continued, x(i)); break; }
+        case 2: { FusedAssign<Type>(res, continued, x(i), x(i+1)); break; }
+        case 3: { FusedAssign<Type>(res, continued, x(i), x(i+1), x(i+2)); break; }
+        default: { FusedAssign<Type>(res, continued, x(i), x(i+1), x(i+2), x(i+3)); break; }
+        }
+        continued = true;
+    }
+}
 
+// evaluates the n-ary function over the first n rows of the operands (children in NaryOp order)
 template<NodeType Type, typename T, std::size_t S>
-static inline void DiffOp(Operon::Vector<Node> const& nodes, Backend::View<T const, S> primal, Backend::View<T, S> trace, int i, int j) {
+inline void FusedOp(T* result, Operon::Span<Operand<T> const> args, int64_t n)
+{
+    if (n == static_cast<int64_t>(S)) {
+        FusedOpImpl<Type, T, static_cast<int>(S)>(result, args, n);
+    } else {
+        FusedOpImpl<Type, T, Eigen::Dynamic>(result, args, n);
+    }
+}
+
+template<NodeType Type, typename T, std::size_t S>
+inline void IndexedOp(Backend::View<T, S> data, int64_t result, Operon::Span<int64_t const> args)
+{
+    if constexpr (Node::IsNary<Type>) {
+        auto const call = [&](bool continued, auto... a) {
+            if (continued) { Func<T, Type, true , S>{}(data, result, a...); }
+            else           { Func<T, Type, false, S>{}(data, result, a...); }
+        };
+
+        bool continued = false;
+        for (auto i = 0UL; i < args.size(); i += 4) {
+            switch (std::min(args.size() - i, 4UL)) {
+            case 1: { call(continued, args[i]); break; }
+            case 2: { call(continued, args[i], args[i+1]); break; }
+            case 3: { call(continued, args[i], args[i+1], args[i+2]); break; }
+            default: { call(continued, args[i], args[i+1], args[i+2], args[i+3]); break; }
+            }
+            continued = true;
+        }
+    } else if constexpr (Node::IsBinary<Type>) {
+        Func<T, Type, false, S>{}(data, result, args[0], args[1]);
+    } else {
+        Func<T, Type, false, S>{}(data, result, args[0]);
+    }
+}
+
+template<NodeType Type, typename T, std::size_t S>
+inline void DiffOp(Operon::Vector<Node> const& nodes, Backend::View<T const, S> primal, Backend::View<T, S> trace, int i, int j) {
    Diff<T, Type, S>{}(nodes, primal, trace, i, j);
 }
 
 template<NodeType Type, typename T, std::size_t S>
-static constexpr auto MakeFunctionCall() -> Dispatch::Callable<T, S>
+constexpr auto MakeFunctionCall() -> Dispatch::Function<T, S>
 {
     if constexpr (Node::IsNary<Type>) {
-        return Callable<T, S>{NaryOp<Type, T, S>};
+        return &NaryOp<Type, T, S>;
     } else if constexpr (Node::IsBinary<Type>) {
-        return Callable<T, S>{BinaryOp<Type, T, S>};
+        return &BinaryOp<Type, T, S>;
     } else if constexpr (Node::IsUnary<Type>) {
-        return Callable<T, S>{UnaryOp<Type, T, S>};
+        return &UnaryOp<Type, T, S>;
     }
 }
 
 template<NodeType Type, typename T, std::size_t S>
-static constexpr auto MakeDiffCall() -> Dispatch::CallableDiff<T, S>
+constexpr auto MakeDiffCall() -> Dispatch::Derivative<T, S>
 {
-    // this constexpr if here returns NOOP in case of non-arithmetic types (duals)
+    // non-arithmetic types (duals) have no derivatives
     if constexpr (std::is_arithmetic_v<T>) {
-        return CallableDiff<T, S>{DiffOp<Type, T, S>};
+        return &DiffOp<Type, T, S>;
+    } else {
+        return nullptr;
+    }
+}
+
+template<NodeType Type, typename T, std::size_t S>
+constexpr auto MakeIndexedCall() -> IndexedFunction<T, S>
+{
+    return &IndexedOp<Type, T, S>;
+}
+
+template<NodeType Type>
+static auto constexpr Fusable = Type == NodeType::Add || Type == NodeType::Sub || Type == NodeType::Mul;
+
+template<NodeType Type, typename T, std::size_t S>
+constexpr auto MakeFusedCall() -> CallableFused<T>
+{
+    if constexpr (std::is_arithmetic_v<T> && Fusable<Type>) {
+        return &FusedOp<Type, T, S>;
     } else {
-        return Dispatch::Noop{};
+        return nullptr;
     }
 }
-}; // struct Dispatch
+
+// the entry points of the inline kernels
+template<typename T, std::size_t S>
+struct Entries {
+    template<NodeType Type> static constexpr auto Function() { return MakeFunctionCall<Type, T, S>(); }
+    template<NodeType Type> static constexpr auto Derivative() { return MakeDiffCall<Type, T, S>(); }
+    template<NodeType Type> static constexpr auto Fused() { return MakeFusedCall<Type, T, S>(); }
+    template<NodeType Type> static constexpr auto Indexed() { return MakeIndexedCall<Type, T, S>(); }
+};
+
+template<typename T, std::size_t S, typename E = Entries<T, S>>
+constexpr auto MakeBuiltins() -> Builtins<T, S>
+{
+    return []<auto... I>(std::index_sequence<I...>){
+        Builtins<T, S> b{};
+        ((b.Functions[I] = E::template Function<static_cast<NodeType>(1U << I)>()), ...);
+        ((b.Derivatives[I] = E::template Derivative<static_cast<NodeType>(1U << I)>()), ...);
+        ((b.Fused[I] = E::template Fused<static_cast<NodeType>(1U << I)>()), ...);
+        ((b.Indexed[I] = E::template Indexed<static_cast<NodeType>(1U << I)>()), ...);
+        return b;
+    }(std::make_index_sequence<BuiltinCount>{});
+}
+OPERON_ISA_NAMESPACE_END
+} // namespace Dispatch
 
 namespace detail {
+    // the built-in primitives of a math backend compiled into the library, for the active instruction set
+    // (see isa.hpp). returns nullptr for the inline kernels of the configured backend, throws if the
+    // backend is not available
+    OPERON_EXPORT auto VariantBuiltins(MathBackend backend) -> Dispatch::Builtins<Operon::Scalar, Dispatch::DefaultBatchSize<Operon::Scalar>> const*;
+
     // return the index of type T in Tuple
     template<typename T, typename... Ts>
     static auto constexpr TypeIndexImpl() {
@@ -199,145 +399,222 @@ public:
     template<typename T>
     using CallableDiff = Dispatch::CallableDiff<T, BatchSize<T>>;
 
+    template<typename T>
+    using Kernel = Dispatch::Kernel<T, BatchSize<T>>;
+
+    template<typename T>
+    using KernelDiff = Dispatch::KernelDiff<T, BatchSize<T>>;
+
+    template<typename T>
+    using Builtins = Dispatch::Builtins<T, BatchSize<T>>;
+
 private:
-    template<NodeType Type, typename T>
-    static constexpr auto MakeFunction() {
-        return Dispatch::MakeFunctionCall<Type, T, BatchSize<T>>();
-    }
+    // the built-in primitives are stored in arrays indexed by NodeTypes::GetIndex (one set per type),
+    // shared by all the tables. user-registered callables live in a side map which takes precedence
+    static auto constexpr BuiltinCount = Dispatch::BuiltinCount;
+
+    static constexpr auto InlineBuiltins = []<auto... Idx>(std::index_sequence<Idx...>){
+        return std::make_tuple(Dispatch::MakeBuiltins<std::tuple_element_t<Idx, Typ>, BatchSize<std::tuple_element_t<Idx, Typ>>>()...);
+    }(std::make_index_sequence<std::tuple_size_v<Typ>>{});
 
-    template<NodeType Type, typename T>
-    static constexpr auto MakeDerivative() {
-        return Dispatch::MakeDiffCall<Type, T, BatchSize<T>>();
+    // each table holds its own copy of the built-in primitives, so that they can be swapped per table
+    using TBuiltins = decltype([]<auto... Idx>(std::index_sequence<Idx...>){
+                    return std::make_tuple(Builtins<std::tuple_element_t<Idx, Typ>>{}...);
+                 }(std::make_index_sequence<std::tuple_size_v<Typ>>{}));
+
+    // the kernels compiled into the library replace the inline ones for the scalar type with the default
+    // batch size (see isa.hpp), the instruction set is chosen when the table is created
+    template<typename T>
+    static constexpr auto HasVariants = std::is_same_v<T, Operon::Scalar> && BatchSize<T> == Dispatch::DefaultBatchSize<T>;
+
+    template<typename T>
+    static auto SelectBuiltins(MathBackend backend) -> Builtins<T> const& {
+        if constexpr (HasVariants<T>) {
+            if (auto const* b = detail::VariantBuiltins(backend); b != nullptr) { return *b; }
+        }
+        return std::get<TypeIndex<T>>(InlineBuiltins);
     }
 
-    template<NodeType Type>
-    static constexpr auto MakeTuple()
-    {
+    static auto SelectBuiltins() -> TBuiltins {
         return []<auto... Idx>(std::index_sequence<Idx...>){
-            return std::make_tuple(
-                std::make_tuple(MakeFunction<Type, std::tuple_element_t<Idx, Tup>>()...),
-                std::make_tuple(MakeDerivative<Type, std::tuple_element_t<Idx, Tup>>()...)
-            );
-        }(std::index_sequence_for<Typ>{});
+            return TBuiltins{ SelectBuiltins<std::tuple_element_t<Idx, Typ>>(MathBackend::Default)... };
+        }(std::make_index_sequence<std::tuple_size_v<Typ>>{});
+    }
+
+    // the hash value of a built-in symbol is its node type (see Node), returns BuiltinCount otherwise
+    static constexpr auto BuiltinIndex(Operon::Hash h) noexcept -> std::size_t {
+        return std::has_single_bit(h) && h < static_cast<Operon::Hash>(NodeType::Dynamic)
+            ? NodeTypes::GetIndex(static_cast<NodeType>(h))
+            : BuiltinCount;
     }
 
     using TFun = decltype([]<auto... Idx>(std::index_sequence<Idx...>){
                     return std::make_tuple(Callable<std::tuple_element_t<Idx, Typ>>{}...);
-                 }(std::index_sequence_for<Typ>{}));
+                 }(std::make_index_sequence<std::tuple_size_v<Typ>>{}));
 
     using TDif = decltype([]<auto... Idx>(std::index_sequence<Idx...>){
                     return std::make_tuple(CallableDiff<std::tuple_element_t<Idx, Typ>>{}...);
-                 }(std::index_sequence_for<Typ>{}));
+                 }(std::make_index_sequence<std::tuple_size_v<Typ>>{}));
 
     using Tuple = std::tuple<TFun, TDif>;
-    using Map   = Operon::Map<Operon::Hash, Tuple>;
+    // the compiled tapes keep pointers to the registered callables: the segmented map does not move its values
+    // when it grows, so registering more callables does not invalidate them (erasing one from GetMap() does)
+    using Map   = Operon::SegmentedMap<Operon::Hash, Tuple>;
 
     Map map_;
+    TBuiltins builtins_{ SelectBuiltins() };
 
-public:
-    DispatchTable()
+    template<typename F, typename DF>
+    static auto MakeTuple(F const& f, DF const& df) -> Tuple
     {
-        auto constexpr f = [](auto i) { return static_cast<NodeType>(1U << i); };
-        [&]<auto ...I>(std::index_sequence<I...>){
-            (map_.insert({ Node(f(I)).HashValue, MakeTuple<f(I)>() }), ...);
-        }(std::make_index_sequence<NodeTypes::Count-3>{});
+        return []<auto... Idx>(F const& f, DF const& df, std::index_sequence<Idx...>){
+            return Tuple{
+                TFun{ Callable<std::tuple_element_t<Idx, Typ>>{f}... },
+                TDif{ CallableDiff<std::tuple_element_t<Idx, Typ>>{df}... }
+            };
+        }(f, df, std::make_index_sequence<std::tuple_size_v<Typ>>{});
     }
 
+public:
+    DispatchTable() = default;
     ~DispatchTable() = default;
 
     auto operator=(DispatchTable const& other) -> DispatchTable& {
         if (this != &other) {
             map_ = other.map_;
+            builtins_ = other.builtins_;
         }
         return *this;
     }
 
     auto operator=(DispatchTable&& other) noexcept -> DispatchTable& {
         map_ = std::move(other.map_);
+        builtins_ = other.builtins_;
         return *this;
     }
 
     template<typename U>
     static constexpr auto SupportsType = TypeIndex<U> < std::tuple_size_v<Typ>;
 
+    // the built-in primitives and the given callables (which take precedence over the built-in ones)
     explicit DispatchTable(Map const& map) : map_(map) { }
     explicit DispatchTable(Map&& map) : map_(std::move(map)) { }
     explicit DispatchTable(std::unordered_map<Operon::Hash, Tuple> const& map) : map_(map.begin(), map.end()) { }
 
-    DispatchTable(DispatchTable const& other) : map_(other.map_) { }
-    DispatchTable(DispatchTable &&other) noexcept : map_(std::move(other.map_)) { }
+    DispatchTable(DispatchTable const& other) : map_(other.map_), builtins_(other.builtins_) { }
+    DispatchTable(DispatchTable &&other) noexcept : map_(std::move(other.map_)), builtins_(other.builtins_) { }
 
+    // the user-registered callables
     auto GetMap() -> Map& { return map_; }
     auto GetMap() const -> Map const& { return map_; }
 
     template<typename T>
-    inline auto GetFunction(Operon::Hash const h) -> Callable<T>&
+    [[nodiscard]] inline auto TryGetFunction(Operon::Hash const h) const noexcept -> std::optional<Kernel<T>>
     {
-        return const_cast<Callable<T>&>(const_cast<DispatchTable<Ts...> const*>(*this)->GetFunction(h)); // NOLINT
+        if (!map_.empty()) {
+            if (auto it = map_.find(h); it != map_.end()) {
+                return Kernel<T>{ .Dynamic = &std::get<TypeIndex<T>>(std::get<0>(it->second)) };
+            }
+        }
+        if (auto i = BuiltinIndex(h); i < BuiltinCount) {
+            return Kernel<T>{ .Builtin = std::get<TypeIndex<T>>(builtins_).Functions[i] };
+        }
+        return {};
     }
 
     template<typename T>
-    inline auto GetDerivative(Operon::Hash const h) -> CallableDiff<T>&
+    [[nodiscard]] inline auto TryGetDerivative(Operon::Hash const h) const noexcept -> std::optional<KernelDiff<T>>
     {
-        return const_cast<CallableDiff<T>&>(const_cast<DispatchTable<Ts...> const*>(*this)->GetDerivative(h)); // NOLINT
+        if (!map_.empty()) {
+            if (auto it = map_.find(h); it != map_.end()) {
+                return KernelDiff<T>{ .Dynamic = &std::get<TypeIndex<T>>(std::get<1>(it->second)) };
+            }
+        }
+        if (auto i = BuiltinIndex(h); i < BuiltinCount) {
+            return KernelDiff<T>{ .Builtin = std::get<TypeIndex<T>>(builtins_).Derivatives[i] };
+        }
+        return {};
     }
 
+    // the fused version of a built-in n-ary primitive, nullptr if there is none or if the symbol was
+    // replaced by a user-registered callable
     template<typename T>
-    [[nodiscard]] inline auto GetFunction(Operon::Hash const h) const -> Callable<T> const&
+    [[nodiscard]] inline auto GetFused(Operon::Hash const h) const noexcept -> Dispatch::CallableFused<T>
     {
-        if (auto it = map_.find(h); it != map_.end()) {
-            return std::get<static_cast<size_t>(TypeIndex<T>)>(std::get<0>(it->second));
-        }
-        throw std::runtime_error(fmt::format("Hash value {} is not in the map\n", h));
+        auto const i = BuiltinIndex(h);
+        if (i == BuiltinCount || (!map_.empty() && map_.contains(h))) { return nullptr; }
+        return std::get<TypeIndex<T>>(builtins_).Fused[i];
     }
 
+    // the indexed version of a built-in primitive (see Dispatch::IndexedOp), nullptr if there is none or if
+    // the symbol was replaced by a user-registered callable
     template<typename T>
-    [[nodiscard]] inline auto GetDerivative(Operon::Hash const h) const -> CallableDiff<T> const&
+    [[nodiscard]] inline auto GetIndexed(Operon::Hash const h) const noexcept -> Dispatch::IndexedFunction<T, BatchSize<T>>
     {
-        if (auto it = map_.find(h); it != map_.end()) {
-            return std::get<static_cast<size_t>(TypeIndex<T>)>(std::get<1>(it->second));
-        }
-        throw std::runtime_error(fmt::format("Hash value {} is not in the map\n", h));
+        auto const i = BuiltinIndex(h);
+        if (i == BuiltinCount || (!map_.empty() && map_.contains(h))) { return nullptr; }
+        return std::get<TypeIndex<T>>(builtins_).Indexed[i];
     }
 
     template<typename T>
-    [[nodiscard]] inline auto Get(Operon::Hash const h) const -> std::tuple<Callable<T>, CallableDiff<T>>
+    [[nodiscard]] inline auto GetFunction(Operon::Hash const h) const -> Kernel<T>
     {
-        if (auto it = map_.find(h); it != map_.end()) {
-            return std::get<static_cast<size_t>(TypeIndex<T>)>(it->second);
-        }
+        if (auto f = TryGetFunction<T>(h)) { return *f; }
         throw std::runtime_error(fmt::format("Hash value {} is not in the map\n", h));
     }
 
-    template<typename F>
-    void RegisterCallable(Operon::Hash hash, F&& f) {
-        map_[hash] = MakeTuple<F, Ts...>(std::forward<F&&>(f), Dispatch::Noop{});
-    }
-
-    template<typename F, typename DF>
-    void RegisterCallable(Operon::Hash hash, F&& f, DF&& df) {
-        map_[hash] = MakeTuple<F, Ts...>(std::forward<F&&>(f), std::forward<DF&&>(df));
+    template<typename T>
+    [[nodiscard]] inline auto GetDerivative(Operon::Hash const h) const -> KernelDiff<T>
+    {
+        if (auto df = TryGetDerivative<T>(h)) { return *df; }
+        throw std::runtime_error(fmt::format("Hash value {} is not in the map\n", h));
     }
 
     template<typename T>
-    [[nodiscard]] inline auto TryGetFunction(Operon::Hash const h) const noexcept -> std::optional<Callable<T>>
+    [[nodiscard]] inline auto Get(Operon::Hash const h) const -> std::tuple<Kernel<T>, KernelDiff<T>>
     {
-        if (auto it = map_.find(h); it != map_.end()) {
-            return std::optional{ std::get<TypeIndex<T>>(std::get<0>(it->second)) };
-        }
-        return {};
+        return { GetFunction<T>(h), GetDerivative<T>(h) };
     }
 
-    template<typename T>
-    [[nodiscard]] inline auto TryGetDerivative(Operon::Hash const h) const noexcept -> std::optional<CallableDiff<T>>
+    // evaluates the given built-in primitives (all of them by default) with another math backend compiled
+    // into the library, for the scalar type with the default batch size (the other types keep the inline
+    // kernels). the functions, derivatives, fused and indexed kernels are replaced together, the registered
+    // callables still take precedence. the interpreters look up their kernels when they are created, so
+    // this does not affect the existing ones. throws if the backend is not available
+    auto SetBackend(MathBackend backend, NodeType types = ~NodeType{}) -> void
     {
-        if (auto it = map_.find(h); it != map_.end()) {
-            return std::optional{ std::get<TypeIndex<T>>(std::get<1>(it->second)) };
+        using T = Operon::Scalar;
+        if (!IsAvailable(backend)) {
+            throw std::runtime_error(fmt::format("math backend {} is not available", MathBackendName(backend)));
         }
-        return {};
+        if constexpr (detail::TypeIndexImpl<T, Ts...>() < std::tuple_size_v<Typ>) {
+            if constexpr (HasVariants<T>) {
+                auto const& src = SelectBuiltins<T>(backend);
+                auto& dst = std::get<TypeIndex<T>>(builtins_);
+                for (auto i = 0UL; i < BuiltinCount; ++i) {
+                    if (!static_cast<bool>(types & static_cast<NodeType>(1U << i))) { continue; }
+                    dst.Functions[i] = src.Functions[i];
+                    dst.Derivatives[i] = src.Derivatives[i];
+                    dst.Fused[i] = src.Fused[i];
+                    dst.Indexed[i] = src.Indexed[i];
+                }
+            }
+        }
+    }
+
+    // the callable must be invocable as Callable<T> for all the supported types T (e.g. a generic lambda),
+    // registering a built-in symbol replaces the built-in primitive
+    template<typename F>
+    void RegisterCallable(Operon::Hash hash, F&& f) {
+        map_[hash] = MakeTuple(std::forward<F>(f), Dispatch::Noop{});
+    }
+
+    template<typename F, typename DF>
+    void RegisterCallable(Operon::Hash hash, F&& f, DF&& df) {
+        map_[hash] = MakeTuple(std::forward<F>(f), std::forward<DF>(df));
     }
 
-    [[nodiscard]] auto Contains(Operon::Hash hash) const noexcept -> bool { return map_.contains(hash); }
+    [[nodiscard]] auto Contains(Operon::Hash hash) const noexcept -> bool { return BuiltinIndex(hash) < BuiltinCount || map_.contains(hash); }
 }; // struct DispatchTable
 
 using DefaultDispatch = DispatchTable<Operon::Scalar>;
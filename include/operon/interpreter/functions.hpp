@@ -5,6 +5,7 @@
 #define OPERON_INTERPRETER_FUNCTIONS_HPP
 
 #include "operon/core/node.hpp"
+#include "operon/interpreter/isa.hpp"
 #if defined(OPERON_MATH_EIGEN)
 #include "operon/interpreter/backend/eigen.hpp"
 #elif defined(OPERON_MATH_EVE)
@@ -30,6 +31,7 @@
 #endif
 
 namespace Operon {
+OPERON_ISA_NAMESPACE_BEGIN
     // utility
     template<typename T, std::size_t S>
     auto Fill(Backend::View<T, S> view, int idx, T value) {
@@ -332,6 +334,7 @@ namespace Operon {
             Backend::Tanh<T, S>(h + result * S, h + i * S);
         }
     };
+OPERON_ISA_NAMESPACE_END
 } // namespace Operon
 
 #endif
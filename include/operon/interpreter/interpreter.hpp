@@ -5,37 +5,28 @@
 #define OPERON_INTERPRETER_HPP
 
 #include <algorithm>
+#include <bit>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <memory>
 #include <optional>
 #include <span>
+#include <type_traits>
+#include <vector>
 
 #include "operon/core/dataset.hpp"
 #include "operon/core/tree.hpp"
 #include "operon/core/types.hpp"
+#include "operon/hash/hash.hpp"
 #include "dispatch_table.hpp"
-// #include "tape.hpp"
+#include "subtree_cache.hpp"
+#include "tape.hpp"
 
-namespace Operon {
-
-namespace detail {
-    // aligned allocation
-    template<class T>
-    struct Deleter {
-        auto operator()(T* p) const -> void {
-            std::free(p); // NOLINT
-        }
-    };
+// forward declaration
+namespace tf { class Executor; }
 
-    template<class T>
-    using AlignedUnique = std::unique_ptr<T[], Deleter<T>>;
-
-    template<class ElementType, size_t ByteAlignment>
-    auto AllocateAligned(auto const numElements) -> AlignedUnique<ElementType>
-    {
-        auto const numBytes = numElements * sizeof(ElementType);
-        auto* ptr = std::aligned_alloc(ByteAlignment, numBytes);
-        return AlignedUnique<ElementType>(static_cast<ElementType*>(ptr));
-    }
-}  // namespace detail
+namespace Operon {
 
 enum class LikelihoodType : int { Gaussian, Poisson };
 
@@ -53,6 +44,65 @@ struct InterpreterBase {
     virtual auto JacFwd(Operon::Span<T const> coeff, Operon::Range range, Operon::Span<T> jacobian) const -> void = 0;
     virtual auto JacFwd(Operon::Span<T const> coeff, Operon::Range range) const -> Eigen::Array<T, -1, -1> = 0;
 
+    // evaluate model jacobian in the mode with the lowest estimated cost
+    virtual auto Jac(Operon::Span<T const> coeff, Operon::Range range, Operon::Span<T> jacobian) const -> void { JacRev(coeff, range, jacobian); }
+
+    // evaluate model output and jacobian together, from the same forward pass
+    virtual auto EvaluateJac(Operon::Span<T const> coeff, Operon::Range range, Operon::Span<T> result, Operon::Span<T> jacobian) const -> void
+    {
+        Jac(coeff, range, jacobian);
+        Evaluate(coeff, range, result);
+    }
+
+    // computes the adjoint of the model output from its values: seed(row, primal, adjoint) receives the output
+    // for the rows [row, row + primal.size()) of the range and writes the adjoint (e.g. the loss derivative)
+    // (it is called once per batch, so it is taken by reference instead of as a std::function)
+    using Seed = Operon::FunctionRef<void(int64_t, Operon::Span<T const>, Operon::Span<T>)>;
+
+    // vector-jacobian product: gradient = J^T * v, where v is the adjoint given by the seed. the default
+    // implementation materializes the jacobian, the interpreter accumulates the gradient in reverse mode
+    virtual auto Vjp(Operon::Span<T const> coeff, Operon::Range range, Seed seed, Operon::Span<T> gradient) const -> void
+    {
+        auto const len { static_cast<int64_t>(range.Size()) };
+        std::vector<T> primal(len);
+        std::vector<T> adjoint(len);
+        Eigen::Array<T, -1, -1> jacobian(len, std::ssize(coeff));
+        EvaluateJac(coeff, range, primal, { jacobian.data(), static_cast<std::size_t>(jacobian.size()) });
+        seed(0, primal, adjoint);
+        Eigen::Map<Eigen::Matrix<T, -1, 1> const> v(adjoint.data(), len);
+        Eigen::Map<Eigen::Matrix<T, -1, 1>>(gradient.data(), std::ssize(gradient)) = jacobian.matrix().transpose() * v;
+    }
+
+    // vector-jacobian product with a fixed vector v (one value per row of the range)
+    auto Vjp(Operon::Span<T const> coeff, Operon::Range range, Operon::Span<T const> v, Operon::Span<T> gradient) const -> void
+    {
+        EXPECT(v.size() == range.Size());
+        Vjp(coeff, range, [&](int64_t row, Operon::Span<T const> primal, Operon::Span<T> adjoint) {
+            std::ranges::copy(v.subspan(row, primal.size()), adjoint.begin());
+        }, gradient);
+    }
+
+    // gauss-newton normal equations of the least squares problem: jtj = J^T J (p x p, column-major) and
+    // jtr = J^T r, where r is the residual (model output - target). returns the sum of squared residuals.
+    // the jacobian is computed in T but the sums are accumulated in double, since forming J^T J squares the
+    // condition number. the default implementation materializes the jacobian, the interpreter accumulates
+    // batch by batch
+    virtual auto NormalEquations(Operon::Span<T const> coeff, Operon::Range range, Operon::Span<T const> target, Operon::Span<double> jtj, Operon::Span<double> jtr) const -> double
+    {
+        EXPECT(target.size() == range.Size());
+        auto const len { static_cast<int64_t>(range.Size()) };
+        auto const np { std::ssize(coeff) };
+        std::vector<T> primal(len);
+        Eigen::Array<T, -1, -1> jacobian(len, np);
+        EvaluateJac(coeff, range, primal, { jacobian.data(), static_cast<std::size_t>(jacobian.size()) });
+        Eigen::Map<Eigen::Matrix<T, -1, 1> const> y(target.data(), len);
+        Eigen::VectorXd const r = (Eigen::Map<Eigen::Matrix<T, -1, 1>>(primal.data(), len) - y).template cast<double>();
+        Eigen::MatrixXd const j = jacobian.matrix().template cast<double>();
+        Eigen::Map<Eigen::MatrixXd>(jtj.data(), np, np) = j.transpose() * j;
+        Eigen::Map<Eigen::VectorXd>(jtr.data(), np) = j.transpose() * r;
+        return r.squaredNorm();
+    }
+
     // getters
     [[nodiscard]] virtual auto GetTree() const -> Operon::Tree const& = 0;
     [[nodiscard]] virtual auto GetDataset() const -> Operon::Dataset const& = 0;
@@ -71,24 +121,116 @@ struct Interpreter : public InterpreterBase<T> {
         , dataset_(dataset)
         , tree_(tree) { }
 
+    // use an external tape (e.g. from a TapePool) so that its buffers are reused across interpreters
+    Interpreter(DTable const& dtable, Operon::Dataset const& dataset, Operon::Tree const& tree, Tape<T, DTable>* tape)
+        : dtable_(dtable)
+        , dataset_(dataset)
+        , tree_(tree)
+        , workspace_(tape) { }
+
     auto Primal() const { return primal_; }
     auto Trace() const { return trace_; }
 
+    // the tape is compiled on first use and reused by all subsequent calls
+    auto GetTape() const -> Tape<T, DTable>& { return workspace_ != nullptr ? *workspace_ : tape_; }
+
+    // look up the subtree outputs in the cache when evaluating (nullptr disables the cache)
+    auto SetCache(SubtreeCache<T>* cache) -> void { cache_ = cache; }
+    auto GetCache() const -> SubtreeCache<T>* { return cache_; }
+
+    // the subtrees without optimized coefficients produce the same output whatever the coefficients are.
+    // Freeze evaluates the largest of them (other than single variables and folded subtrees) once over the
+    // range, then the passes over the range (or a part of it) copy their outputs instead of descending into
+    // them, so that a local search only recomputes the nodes above the coefficients. the frozen outputs
+    // depend on the weights in the tree and must be refreshed (or cleared) when the tree is modified. they
+    // are kept in the tape and the subtrees are only frozen if their outputs fit in the memory budget (bytes).
+    // they are dropped when the tape is recompiled or frozen for another tree (see Tape::FrozenEpoch)
+    static constexpr std::size_t DefaultFreezeBudget{ 64UL << 20U };
+
+    auto Freeze(Operon::Range range, std::size_t budget = DefaultFreezeBudget) const -> void {
+        Unfreeze();
+        auto const& nodes = tree_.get().Nodes();
+        auto const nn { std::ssize(nodes) };
+        auto const len { static_cast<int64_t>(range.Size()) };
+        InitContext({}, range);
+        auto const& tape = GetTape();
+
+        // bottom-up: Fixed if there are no optimized coefficients in the subtree. top-down: the largest
+        // fixed subtrees get an output column, their descendants are FrozenInside
+        auto state = tape.FrozenState();
+        for (auto i = 0L; i < nn; ++i) {
+            auto const fixed = !nodes[i].Optimize && std::ranges::all_of(Tree::Indices(nodes, i), [&](auto j) { return state[j] == Fixed; });
+            state[i] = fixed ? Fixed : Unfrozen;
+        }
+        int64_t count{0};
+        for (auto i = nn-1; i >= 0L; --i) {
+            if (state[i] != Fixed) { continue; }
+            if (nodes[i].IsLeaf() || tape[i].Folded) { state[i] = Unfrozen; continue; }
+            state[i] = count++;
+            std::fill(state.begin() + (i - nodes[i].Length), state.begin() + i, FrozenInside);
+        }
+        if (count == 0 || static_cast<std::size_t>(len * count) * sizeof(T) > budget) { return; }
+
+        auto frozen = tape.FrozenValues(len * count);
+        constexpr int64_t S{ BatchSize };
+        auto const start { static_cast<int64_t>(range.Start()) };
+        for (auto row = 0L; row < len; row += S) {
+            auto const rem { std::min(S, len - row) };
+            Operon::Range rg(start + row, start + row + rem);
+            for (auto i : tape.Live()) {
+                if (state[i] == Unfrozen) { continue; }
+                ForwardNode(nodes, tape, i, rg, /*trace=*/false);
+                if (auto const k = state[i]; k >= 0) {
+                    std::ranges::copy_n(primal_.data_handle() + i * S, rem, frozen.data() + k * len + row);
+                }
+            }
+        }
+        frozenState_ = state;
+        frozen_ = frozen;
+        frozenRange_ = range;
+        frozenEpoch_ = tape.FrozenEpoch();
+    }
+
+    // drops the frozen outputs, the tape keeps their buffer for the next Freeze unless it takes more than
+    // `retain` bytes
+    auto Unfreeze(std::size_t retain = std::numeric_limits<std::size_t>::max()) const -> void {
+        frozenState_ = {};
+        frozen_ = {};
+        GetTape().ShrinkFrozen(retain);
+    }
+
     inline auto Evaluate(Operon::Span<T const> coeff, Operon::Range range, Operon::Span<T> result) const -> void final {
         InitContext(coeff, range);
 
+        // the outputs of the range must fit in the cache, otherwise nothing is stored or found
+        if (cache_ != nullptr && cache_->Admits(range.Size())) {
+            EvaluateCached(range, result);
+            return;
+        }
+
         auto const len{ static_cast<int64_t>(range.Size()) };
 
         constexpr int64_t S{ BatchSize };
-        auto* ptr = primal_.data_handle() + (primal_.extent(1) - 1) * S;
-
         for (auto row = 0L; row < len; row += S) {
-            ForwardPass(range, row, /*trace=*/false);
+            EvaluateBlock(range, row, result);
+        }
+    }
 
-            if (std::ssize(result) == len) {
-                auto rem = std::min(S, len - row);
-                std::ranges::copy(std::span(ptr, rem), result.data() + row);
-            }
+    // block-wise evaluation, used to interleave several trees over the same rows (see MultiInterpreter):
+    // Prepare() initializes the tape, then EvaluateBlock() computes the BatchSize rows starting at `row`
+    // (relative to the range start) and writes them to the full-range result
+    auto Prepare(Operon::Span<T const> coeff) const -> void { InitContext(coeff, {}); }
+
+    auto EvaluateBlock(Operon::Range range, int64_t row, Operon::Span<T> result) const -> void {
+        auto const len{ static_cast<int64_t>(range.Size()) };
+        constexpr int64_t S{ BatchSize };
+
+        ForwardPass(range, row, /*trace=*/false);
+
+        if (std::ssize(result) == len) {
+            auto const* ptr = primal_.data_handle() + (primal_.extent(1) - 1) * S;
+            auto rem = std::min(S, len - row);
+            std::ranges::copy(std::span(ptr, rem), result.data() + row);
         }
     }
 
@@ -99,22 +241,13 @@ struct Interpreter : public InterpreterBase<T> {
     }
 
     inline auto JacRev(Operon::Span<T const> coeff, Operon::Range range, Operon::Span<T> jacobian) const -> void final {
-        InitContext(coeff, range);
-        auto const len{ static_cast<int64_t>(range.Size()) };
-        auto const& nodes = tree_.get().Nodes();
-        auto const nn { std::ssize(nodes) };
-
-        constexpr int64_t S{ BatchSize };
-        traceStorage_ = detail::AllocateAligned<T, Backend::DefaultAlignment>(S * nn);
-        trace_ = Backend::View<T, S>(traceStorage_.get(), S, nn);
-        Fill<T, S>(trace_, nn-1, T{1});
-
-        Eigen::Map<Eigen::Array<T, -1, -1>> jac(jacobian.data(), len, coeff.size());
+        Differentiate(coeff, range, jacobian, {}, /*forward=*/false);
+    }
 
-        for (auto row = 0L; row < len; row += S) {
-            ForwardPass(range, row, /*trace=*/true);
-            ReverseTrace(range, row, jac);
-        }
+    // the jacobian rows of the range are written into a column-major matrix with the given leading dimension
+    // (e.g. a block of rows of a larger jacobian, in which case jacobian starts at the first row of the block)
+    inline auto JacRev(Operon::Span<T const> coeff, Operon::Range range, Operon::Span<T> jacobian, int64_t stride) const -> void {
+        Differentiate(coeff, range, jacobian, {}, /*forward=*/false, stride);
     }
 
     inline auto JacRev(Operon::Span<T const> coeff, Operon::Range range) const -> Eigen::Array<T, -1, -1> final {
@@ -125,35 +258,111 @@ struct Interpreter : public InterpreterBase<T> {
     }
 
     auto JacFwd(Operon::Span<T const> coeff, Operon::Range range, Operon::Span<T> jacobian) const -> void final {
+        Differentiate(coeff, range, jacobian, {}, /*forward=*/true);
+    }
+
+    inline auto JacFwd(Operon::Span<T const> coeff, Operon::Range range) const -> Eigen::Array<T, -1, -1> final {
+        auto const nr{ static_cast<int64_t>(range.Size()) };
+        Eigen::Array<T, -1, -1> jacobian(nr, coeff.size());
+        JacFwd(coeff, range, { jacobian.data(), static_cast<size_t>(jacobian.size()) });
+        return jacobian;
+    }
+
+    // the forward mode writes one tangent column per node and coefficient in its subtree (i.e. the sum of
+    // the coefficient depths), the reverse mode one adjoint column per edge and one jacobian column per
+    // coefficient. the forward mode is cheaper for few coefficients close to the root of a large tree
+    [[nodiscard]] auto PreferForward(int64_t p) const -> bool {
+        auto const layout = TangentLayout(p);
+        if (layout.empty()) { return false; }
+        auto const& root { layout.back() };
+        auto const edges { std::ssize(layout) - 1 };
+        return root.Offset + root.Count < edges + p;
+    }
+
+    inline auto Jac(Operon::Span<T const> coeff, Operon::Range range, Operon::Span<T> jacobian) const -> void final {
+        Differentiate(coeff, range, jacobian, {}, PreferForward(std::ssize(coeff)));
+    }
+
+    inline auto EvaluateJac(Operon::Span<T const> coeff, Operon::Range range, Operon::Span<T> result, Operon::Span<T> jacobian) const -> void final {
+        EXPECT(result.size() == range.Size());
+        Differentiate(coeff, range, jacobian, result, PreferForward(std::ssize(coeff)));
+    }
+
+    using InterpreterBase<T>::Vjp;
+    using Seed = typename InterpreterBase<T>::Seed;
+
+    // the adjoint of the output is seeded batch by batch, so only the trace of the current batch is kept in
+    // memory (one column per node) and the jacobian is never materialized
+    auto Vjp(Operon::Span<T const> coeff, Operon::Range range, Seed seed, Operon::Span<T> gradient) const -> void final {
         InitContext(coeff, range);
-        auto const len{ static_cast<int>(range.Size()) };
-        auto const& nodes = tree_.get().Nodes();
-        auto const nn   { std::ssize(nodes) };
+        auto const len{ static_cast<int64_t>(range.Size()) };
+        auto const nn { std::ssize(tree_.get().Nodes()) };
 
         constexpr int64_t S{ BatchSize };
-        traceStorage_ = detail::AllocateAligned<T, Backend::DefaultAlignment>(S * nn);
-        trace_ = Backend::View<T, S>(traceStorage_.get(), S, nn);
-        Fill<T, S>(trace_, nn-1, T{1});
+        trace_ = GetTape().Trace();
+        std::ranges::fill(gradient, T{0});
 
-        Eigen::Map<Eigen::Array<T, -1, -1>> jac(jacobian.data(), len, coeff.size());
-
-        for (int row = 0; row < len; row += S) {
+        for (auto row = 0L; row < len; row += S) {
             ForwardPass(range, row, /*trace=*/true);
-            ForwardTrace(range, row, jac);
+            auto const rem { std::min(S, len - row) };
+            seed(row, { primal_.data_handle() + (nn - 1) * S, static_cast<std::size_t>(rem) },
+                      { trace_.data_handle() + (nn - 1) * S, static_cast<std::size_t>(rem) });
+            ReverseTrace(range, row, std::ssize(gradient), [&](auto k, auto const& d) { gradient[k] += d.sum(); });
         }
     }
 
-    inline auto JacFwd(Operon::Span<T const> coeff, Operon::Range range) const -> Eigen::Array<T, -1, -1> final {
-        auto const nr{ static_cast<int64_t>(range.Size()) };
-        Eigen::Array<T, -1, -1> jacobian(nr, coeff.size());
-        JacFwd(coeff, range, { jacobian.data(), static_cast<size_t>(jacobian.size()) });
-        return jacobian;
+    // the jacobian rows of each batch are folded into J^T J and J^T r as soon as they are computed, so the
+    // memory does not depend on the number of rows (p x p for the system and BatchSize x p for the batch)
+    auto NormalEquations(Operon::Span<T const> coeff, Operon::Range range, Operon::Span<T const> target, Operon::Span<double> jtj, Operon::Span<double> jtr) const -> double final {
+        EXPECT(target.size() == range.Size());
+        InitContext(coeff, range);
+        auto const len{ static_cast<int64_t>(range.Size()) };
+        auto const nn { std::ssize(tree_.get().Nodes()) };
+        auto const np { std::ssize(coeff) };
+
+        constexpr int64_t S{ BatchSize };
+        auto const forward { PreferForward(np) };
+        trace_ = GetTape().Trace();
+        if (!forward) { Fill<T, S>(trace_, nn-1, T{1}); }
+        auto const layout = forward ? TangentLayout(np) : Operon::Span<TangentBlock const>{};
+
+        Eigen::Map<Eigen::MatrixXd> a(jtj.data(), np, np);
+        Eigen::Map<Eigen::VectorXd> b(jtr.data(), np);
+        a.setZero();
+        b.setZero();
+
+        // the rows of the batch are computed in T and converted once before they are folded into the sums
+        Eigen::Map<Eigen::Array<T, S, -1>> jac(GetTape().JacobianBatch(np).data_handle(), S, np);
+        Eigen::Map<Eigen::Matrix<double, S, -1>> jd(GetTape().NormalBatch(np).data(), S, np);
+        Eigen::Matrix<double, S, 1> r;
+        double ssr{0};
+
+        for (auto row = 0L; row < len; row += S) {
+            ForwardPass(range, row, /*trace=*/true);
+            auto const rem { std::min(S, len - row) };
+            if (forward) {
+                ForwardTrace(range, row, layout, jac.topRows(rem));
+            } else {
+                ReverseTrace(range, row, np, [&](auto k, auto const& d) { jac.col(k).head(rem) = d; });
+            }
+            Eigen::Map<Eigen::Matrix<T, -1, 1> const> primal(primal_.data_handle() + (nn - 1) * S, rem);
+            Eigen::Map<Eigen::Matrix<T, -1, 1> const> y(target.data() + row, rem);
+            r.head(rem) = (primal - y).template cast<double>();
+            ssr += r.head(rem).squaredNorm();
+
+            auto j = jd.topRows(rem);
+            j = jac.topRows(rem).matrix().template cast<double>();
+            a.template selfadjointView<Eigen::Lower>().rankUpdate(j.transpose());
+            b.noalias() += j.transpose() * r.head(rem);
+        }
+        a.template triangularView<Eigen::StrictlyUpper>() = a.transpose();
+        return ssr;
     }
 
     [[nodiscard]] auto GetTree() const -> Operon::Tree const& final { return tree_.get(); }
     [[nodiscard]] auto GetDataset() const -> Operon::Dataset const& final { return dataset_.get(); }
 
-    auto GetDispatchTable() const { return dtable_.get(); }
+    auto GetDispatchTable() const -> DTable const& { return dtable_.get(); }
 
     static inline auto Evaluate(Operon::Tree const& tree, Operon::Dataset const& dataset, Operon::Range const range) {
         auto coeff = tree.GetCoefficients();
@@ -168,114 +377,308 @@ struct Interpreter : public InterpreterBase<T> {
 
 private:
     // private members
-    using Data = std::tuple<T,
-          std::span<Operon::Scalar const>,
-          std::optional<Dispatch::Callable<T, BatchSize> const>,
-          std::optional<Dispatch::CallableDiff<T, BatchSize> const> >;
-
     std::reference_wrapper<DTable const> dtable_;
     std::reference_wrapper<Operon::Dataset const> dataset_;
     std::reference_wrapper<Operon::Tree const> tree_;
 
     // mutable internal state (used by all the forward/reverse passes)
-    mutable std::vector<Data> context_;
+    mutable Tape<T, DTable> tape_;
+    Tape<T, DTable>* workspace_{nullptr};
+    mutable bool compiled_{false};
+    SubtreeCache<T>* cache_{nullptr};
+
+    // frozen subtree outputs (see Freeze): the state of a node is the column of its output, Unfrozen or
+    // FrozenInside (below a frozen node)
+    static constexpr int64_t Unfrozen{-1};
+    static constexpr int64_t FrozenInside{-2};
+    static constexpr int64_t Fixed{-3}; // only used while freezing
+    mutable Operon::Span<int64_t const> frozenState_; // views into the tape buffers
+    mutable Operon::Span<T const> frozen_;
+    mutable Operon::Range frozenRange_;
+    mutable uint64_t frozenEpoch_{0};
 
     mutable Backend::View<T, BatchSize> primal_;
     mutable Backend::View<T, BatchSize> trace_;
 
-    mutable detail::AlignedUnique<T> primalStorage_;
-    mutable detail::AlignedUnique<T> traceStorage_;
-
     // private methods
     inline auto ForwardPass(Operon::Range range, int row, bool trace = false) const -> void {
         auto const start { static_cast<int64_t>(range.Start()) };
         auto const len   { static_cast<int64_t>(range.Size()) };
         auto const& nodes = tree_.get().Nodes();
         auto const nn = std::ssize(nodes);
+        auto const& tape = GetTape();
         constexpr int64_t S{ BatchSize };
 
         auto rem = std::min(S, len - row);
         Operon::Range rg(start + row, start + row + rem);
 
-        // forward pass - compute primal and trace
-        for (auto i = 0L; i < nn; ++i) {
-            auto const& [ p, v, f, df ] = context_[i];
-            auto* ptr = primal_.data_handle() + i * S;
+        // forward pass - compute primal and trace. the folded subtrees were already evaluated by the tape,
+        // only the partials need all the nodes
+        if (IsFrozen(rg)) {
+            auto const offset { static_cast<int64_t>(rg.Start() - frozenRange_.Start()) };
+            auto const flen { static_cast<int64_t>(frozenRange_.Size()) };
+            auto node = [&](int64_t i) {
+                if (auto const k = frozenState_[i]; k >= 0) {
+                    std::ranges::copy_n(frozen_.data() + k * flen + offset, rem, primal_.data_handle() + i * S);
+                } else if (k == Unfrozen) {
+                    ForwardNode(nodes, tape, i, rg, trace);
+                }
+            };
+            if (trace) {
+                for (auto i = 0L; i < nn; ++i) { node(i); }
+            } else {
+                for (auto i : tape.Live()) { node(i); }
+            }
+        } else if (trace) {
+            for (auto i = 0L; i < nn; ++i) {
+                ForwardNode(nodes, tape, i, rg, trace);
+            }
+        } else {
+            for (auto i : tape.Live()) {
+                ForwardNode(nodes, tape, i, rg, trace);
+            }
+        }
+    }
 
-            if (nodes[i].IsVariable()) {
-                std::ranges::transform(v.subspan(row, rem), ptr, [p](auto x) { return x * p; });
-            } else if (f) {
-                std::invoke(*f, nodes, primal_, i, rg);
+    // true if the frozen outputs are still valid and cover the rows
+    [[nodiscard]] auto IsFrozen(Operon::Range rg) const -> bool {
+        return std::ssize(frozenState_) == std::ssize(tree_.get().Nodes()) && frozenEpoch_ == GetTape().FrozenEpoch()
+            && rg.Start() >= frozenRange_.Start() && rg.End() <= frozenRange_.End();
+    }
 
-                // first compute the partials
-                if (trace && df) {
+    inline auto ForwardNode(Operon::Vector<Node> const& nodes, Tape<T, DTable> const& tape, int64_t i, Operon::Range rg, bool trace) const -> void {
+        constexpr int64_t S{ BatchSize };
+        auto const rem { static_cast<int64_t>(rg.Size()) };
+        auto const& [ p, v, f, df, s, c, fused, inlined ] = tape[i];
+        auto* ptr = primal_.data_handle() + i * S;
+
+        if (nodes[i].IsVariable()) {
+            // an inlined variable is read directly from the dataset by its parent
+            if (inlined && !trace) { return; }
+            std::ranges::transform(std::span(v + rg.Start(), rem), ptr, [p](auto x) { return x * p; });
+        } else if (f) {
+            if (fused != nullptr && !trace) {
+                if constexpr (std::is_same_v<T, Operon::Scalar>) {
+                    auto& operands = tape.Operands();
+                    operands.clear();
                     for (auto j : Tree::Indices(nodes, i)) {
-                        std::invoke(*df, nodes, primal_, trace_, i, j);
+                        auto const& arg = tape[j];
+                        if (arg.Inlined) {
+                            operands.push_back({ arg.Values + rg.Start(), arg.Coefficient });
+                        } else {
+                            operands.push_back({ primal_.data_handle() + j * S, T{1} });
+                        }
                     }
+                    fused(ptr, { operands.data(), operands.size() }, rem);
                 }
+            } else {
+                f(nodes, primal_, i, rg);
+            }
 
-                // apply weight after partials are computed
-                if (p != T{1}) {
-                    std::ranges::transform(std::span(ptr, rem), ptr, [p](auto x) { return x * p; });
+            // first compute the partials
+            if (trace && df) {
+                for (auto j : Tree::Indices(nodes, i)) {
+                    df(nodes, primal_, trace_, i, j);
                 }
             }
+
+            // apply weight after partials are computed
+            if (p != T{1}) {
+                std::ranges::transform(std::span(ptr, rem), ptr, [p](auto x) { return x * p; });
+            }
         }
     }
 
-    inline auto ForwardTrace(Operon::Range range, int row, Eigen::Ref<Eigen::Array<T, -1, -1>> jac) const -> void {
+    // the subtrees found in the cache are not descended into: their outputs are copied into the primal
+    // buffer, the other subtrees (large enough to be cached) are evaluated and added to the cache. the
+    // strict tree hash cannot serve as key because it ignores the function weights and sorts the children
+    // of commutative functions (which changes the floating point result of n-ary functions), therefore
+    // the key is a strict hash over the symbols, the current weights and the children in tree order
+    auto EvaluateCached(Operon::Range range, Operon::Span<T> result) const -> void {
+        auto const& nodes = tree_.get().Nodes();
+        auto const& tape = GetTape();
+        auto const nn { std::ssize(nodes) };
+        auto const len { static_cast<int64_t>(range.Size()) };
+        auto const minLength { static_cast<int64_t>(cache_->MinLength()) };
+        constexpr int64_t S{ BatchSize };
+
+        // the scratch vectors are kept in the tape
+        auto& scratch = tape.Cached();
+        auto& keys = scratch.Keys;
+        auto& buf = scratch.Words;
+        keys.resize(nn);
+        Operon::Hasher hasher;
+        for (auto i = 0L; i < nn; ++i) {
+            auto const w { static_cast<Operon::Scalar>(tape[i].Coefficient) };
+            buf.assign({ nodes[i].HashValue, 0UL });
+            std::memcpy(&buf[1], &w, sizeof(w));
+            for (auto j : Tree::Indices(nodes, i)) { buf.push_back(keys[j]); }
+            keys[i] = hasher(std::bit_cast<uint8_t const*>(buf.data()), buf.size() * sizeof(uint64_t)); // NOLINT
+        }
+
+        // walk down from the root: the descendants of a cached subtree are skipped (neither looked up nor
+        // evaluated), the leaves and the small subtrees are evaluated without a lookup. the output buffer
+        // of a missing subtree is only allocated once it is known to fit in the cache (see Evaluate)
+        using Action = typename Tape<T, DTable>::CacheScratch::Action;
+        auto& actions = scratch.Actions;
+        auto& loaded = scratch.Loaded;
+        auto& stored = scratch.Stored;
+        actions.assign(nn, Action::Evaluate);
+        loaded.assign(nn, nullptr);
+        stored.assign(nn, nullptr);
+        auto lo { nn };
+        for (auto i = nn-1; i >= 0L; --i) {
+            if (i >= lo || tape[i].Folded || tape[i].Inlined) { actions[i] = Action::Skip; continue; }
+            if (nodes[i].IsLeaf() || nodes[i].Length + 1 < minLength) { continue; }
+            if (auto values = cache_->Find(keys[i], range); values != nullptr) {
+                actions[i] = Action::Load;
+                loaded[i] = std::move(values);
+                lo = i - nodes[i].Length;
+            } else {
+                actions[i] = Action::Store;
+                stored[i] = cache_->Acquire(len);
+            }
+        }
+
+        auto const start { static_cast<int64_t>(range.Start()) };
+        for (auto row = 0L; row < len; row += S) {
+            auto const rem { std::min(S, len - row) };
+            Operon::Range rg(start + row, start + row + rem);
+
+            for (auto i = 0L; i < nn; ++i) {
+                auto* ptr = primal_.data_handle() + i * S;
+                switch (actions[i]) {
+                case Action::Skip: { break; }
+                case Action::Load: { std::ranges::copy_n(loaded[i]->data() + row, rem, ptr); break; }
+                case Action::Evaluate: { ForwardNode(nodes, tape, i, rg, /*trace=*/false); break; }
+                case Action::Store: {
+                    ForwardNode(nodes, tape, i, rg, /*trace=*/false);
+                    std::ranges::copy_n(ptr, rem, stored[i]->data() + row);
+                    break;
+                }
+                }
+            }
+
+            if (std::ssize(result) == len) {
+                std::ranges::copy_n(primal_.data_handle() + (nn - 1) * S, rem, result.data() + row);
+            }
+        }
+
+        for (auto i = 0L; i < nn; ++i) {
+            if (stored[i]) { cache_->Insert(keys[i], range, std::move(stored[i])); }
+        }
+        // the tape must not keep the outputs alive
+        loaded.clear();
+        stored.clear();
+    }
+
+    // the forward pass of the jacobian computes the primal of every batch as well, so the model output is
+    // copied to the result along the way (unless the result is empty). the leading dimension of the jacobian
+    // defaults to the number of rows
+    auto Differentiate(Operon::Span<T const> coeff, Operon::Range range, Operon::Span<T> jacobian, Operon::Span<T> result, bool forward, int64_t stride = 0) const -> void {
+        InitContext(coeff, range);
+        auto const len{ static_cast<int64_t>(range.Size()) };
+        auto const nn { std::ssize(tree_.get().Nodes()) };
+        auto const np { std::ssize(coeff) };
+        if (stride == 0) { stride = len; }
+        EXPECT(np == 0 || std::ssize(jacobian) >= (np - 1) * stride + len);
+
+        constexpr int64_t S{ BatchSize };
+        trace_ = GetTape().Trace();
+        if (!forward) { Fill<T, S>(trace_, nn-1, T{1}); }
+
+        Eigen::Map<Eigen::Array<T, -1, -1>, Eigen::Unaligned, Eigen::OuterStride<>> jac(jacobian.data(), len, np, Eigen::OuterStride<>(stride));
+        auto const layout = forward ? TangentLayout(np) : Operon::Span<TangentBlock const>{};
+
+        for (auto row = 0L; row < len; row += S) {
+            ForwardPass(range, row, /*trace=*/true);
+            if (std::ssize(result) == len) {
+                auto const* ptr = primal_.data_handle() + (nn - 1) * S;
+                std::ranges::copy_n(ptr, std::min(S, len - row), result.data() + row);
+            }
+            if (forward) {
+                ForwardTrace(range, row, layout, jac.middleRows(row, std::min(S, len - row)));
+            } else {
+                ReverseTrace(range, row, jac.cols(), [&](auto k, auto const& d) { jac.col(k).segment(row, d.size()) = d; });
+            }
+        }
+    }
+
+    // the tangent blocks of the forward mode (see TangentBlock), in a buffer of the tape
+    auto TangentLayout(int64_t p) const -> Operon::Span<TangentBlock const> {
+        return GetTape().TangentLayout(tree_.get().Nodes(), p);
+    }
+
+    // vector forward mode: the tangent block of a node holds the derivatives of its output with respect to
+    // the coefficients in its subtree (one column each), so the whole jacobian is computed in a single
+    // traversal and the inner loops run over contiguous blocks of rows and coefficients. each coefficient
+    // belongs to the subtree of exactly one child, therefore the blocks are assigned without accumulation.
+    // the rows of the current batch are written to out (one column per coefficient).
+    inline auto ForwardTrace(Operon::Range range, int64_t row, Operon::Span<TangentBlock const> layout, Eigen::Ref<Eigen::Array<T, -1, -1>> out) const -> void {
         auto const len   { static_cast<int64_t>(range.Size()) };
         auto const& nodes{ tree_.get().Nodes() };
         auto const nn { std::ssize(nodes) };
+        auto const& tape = GetTape();
         constexpr int64_t S{ BatchSize };
         auto const rem   { std::min(S, len - row) };
+        auto const p     { static_cast<int64_t>(out.cols()) };
+        auto const& root { layout.back() };
 
-        Eigen::Array<T, S, -1> dot(S, nn);
-        std::vector<int64_t> cidx(jac.cols());
-
+        Eigen::Map<Eigen::Array<T, S, -1>> dot(tape.Tangent(root.Offset + root.Count).data_handle(), S, root.Offset + root.Count);
         Eigen::Map<Eigen::Array<T, S, -1>> primal(primal_.data_handle(), S, nn);
         Eigen::Map<Eigen::Array<T, S, -1>> trace(trace_.data_handle(), S, nn);
+        Eigen::Array<T, S, 1> w;
 
-        for (auto i = 0L, j = 0L; i < nn; ++i) {
-            if (nodes[i].Optimize) { cidx[j++] = i; }
-        }
+        for (auto i = 0L; i < nn; ++i) {
+            auto const& b = layout[i];
+            if (b.Count == 0) { continue; }
+            auto block = dot.middleCols(b.Offset, b.Count).topRows(rem);
 
-        auto k{0};
-        for (auto c : cidx) {
-            dot.topRows(rem).setConstant(T{0});
-            dot.col(c).head(rem).setConstant(T{1});
-
-            for (auto i = 0; i < nn; ++i) {
-                if (nodes[i].IsLeaf()) { continue; }
-                for (auto x : Tree::Indices(nodes, i)) {
-                    auto j{ static_cast<int64_t>(x) };
-                    if (nodes[j].IsLeaf() && j != c) { continue; }
-                    dot.col(i).head(rem) += dot.col(j).head(rem) * trace.col(j).head(rem) * std::get<0>(context_[i]);
-                }
+            // the partial derivative of a node with respect to its own coefficient
+            if (auto const s = tape[i].Slot; s >= 0 && s < p) {
+                block.col(s - b.First) = primal.col(i).head(rem) / tape[i].Coefficient;
             }
 
-            jac.col(k++).segment(row, rem) = dot.col(nn-1).head(rem) * primal.col(c).head(rem) / std::get<0>(context_[c]);
+            for (auto x : Tree::Indices(nodes, i)) {
+                auto const j { static_cast<int64_t>(x) };
+                auto const& c = layout[j];
+                if (c.Count == 0) { continue; }
+                w.head(rem) = trace.col(j).head(rem) * tape[i].Coefficient;
+                block.middleCols(c.First - b.First, c.Count) = dot.middleCols(c.Offset, c.Count).topRows(rem).colwise() * w.head(rem);
+            }
         }
+
+        out.leftCols(root.Count) = dot.middleCols(root.Offset, root.Count).topRows(rem);
+        out.rightCols(p - root.Count).setZero();
     }
 
-    auto ReverseTrace(Operon::Range range, int row, Eigen::Ref<Eigen::Array<T, -1, -1>> jac) const -> void {
+    // propagates the adjoint of the output (stored in the root column of the trace) to the nodes and passes the
+    // derivative with respect to each of the first p coefficients to emit(k, column)
+    template<typename Emit>
+    auto ReverseTrace(Operon::Range range, int64_t row, int64_t p, Emit&& emit) const -> void {
         auto const len   { static_cast<int64_t>(range.Size()) };
         auto const& nodes{ tree_.get().Nodes() };
         auto const nn    { std::ssize(nodes) };
         constexpr int64_t S{ BatchSize };
         auto const rem   { std::min(S, len - row) };
 
-        auto k{jac.cols()};
+        auto const& tape = GetTape();
+
+        auto k{p};
         Eigen::Map<Eigen::Array<T, S, -1>> primal(primal_.data_handle(), S, nn);
         Eigen::Map<Eigen::Array<T, S, -1>> trace(trace_.data_handle(), S, nn);
+        // the frozen subtrees have no coefficients, there is nothing to propagate into them
+        auto const start { static_cast<int64_t>(range.Start()) + row };
+        auto const frozen { IsFrozen(Operon::Range(start, start + rem)) };
 
         for (auto i = nn-1; i >= 0L; --i) {
-            auto w = std::get<0>(context_[i]);
+            auto w = tape[i].Coefficient;
 
             if (nodes[i].Optimize) {
-                jac.col(--k).segment(row, rem) = trace.col(i).head(rem) * primal.col(i).head(rem) / w;
+                emit(--k, trace.col(i).head(rem) * primal.col(i).head(rem) / w);
             }
 
-            if (nodes[i].IsLeaf()) { continue; }
+            if (nodes[i].IsLeaf() || (frozen && frozenState_[i] != Unfrozen)) { continue; }
 
             for (auto j : Tree::Indices(nodes, i)) {
                 auto const x { static_cast<int64_t>(j) };
@@ -284,45 +687,37 @@ private:
         }
     }
 
-    // init tree info into context_ and initializes primal_ columns
-    auto InitContext(Operon::Span<T const> coeff, Operon::Range range) const {
-        auto const& nodes{ tree_.get().Nodes() };
-        auto const nr { static_cast<int64_t>(range.Size()) };
-        auto const nn { std::ssize(nodes) };
-
-        constexpr int64_t S{ BatchSize };
-        primalStorage_ = detail::AllocateAligned<T, Backend::DefaultAlignment>(S * nn);
-        std::ranges::fill_n(primalStorage_.get(), S * nn, T{0});
-        primal_ = Backend::View<T, BatchSize>(primalStorage_.get(), S, nn);
-
-        context_.clear();
-        context_.reserve(nn);
-
-        auto const& dt = dtable_.get();
-        // aggregate necessary info about the tree into a context object
-        for (int64_t i = 0, j = 0; i < nn; ++i) {
-            auto const& n = nodes[i];
-            auto const* ptr      = n.IsVariable() ? dataset_.get().GetValues(n.HashValue).subspan(range.Start(), range.Size()).data() : nullptr;
-            auto variableValues  = std::tuple_element_t<1, Data>(ptr, nr);
-            auto nodeCoefficient = (!coeff.empty() && n.Optimize) ? T{coeff[j++]} : T{n.Value};
-            auto nodeFunction    = dt.template TryGetFunction<T>(n.HashValue);
-            auto nodeDerivative  = dt.template TryGetDerivative<T>(n.HashValue);
-
-            if (!n.IsLeaf() && !nodeFunction) {
-                throw std::runtime_error(fmt::format("Missing primitive for node {}\n", n.Name()));
-            }
-
-            context_.push_back({ nodeCoefficient, variableValues, nodeFunction, nodeDerivative });
-
-            if (n.IsConstant()) {
-                Fill<T, S>(primal_, i, T{nodeCoefficient});
-            }
+    // compile the tape (only on first use) and update the coefficients
+    auto InitContext(Operon::Span<T const> coeff, Operon::Range /*unused*/) const {
+        auto const& tree = tree_.get();
+        auto& tape = GetTape();
+        // an external tape might have been compiled by another interpreter in the meantime
+        if (!compiled_ || !tape.IsCompiled(dtable_.get(), dataset_.get(), tree)) {
+            Unfreeze();
+            tape.Compile(dtable_.get(), dataset_.get(), tree);
+            compiled_ = true;
         }
+        tape.SetCoefficients(tree.Nodes(), coeff);
+        primal_ = tape.Primal();
     }
 };
 
 // convenience method to interpret many trees in parallel (mostly useful from the python wrapper)
 auto OPERON_EXPORT EvaluateTrees(std::vector<Operon::Tree> const& trees, Operon::Dataset const& dataset, Operon::Range range, size_t nthread = 0) -> std::vector<std::vector<Operon::Scalar>>;
 auto OPERON_EXPORT EvaluateTrees(std::vector<Operon::Tree> const& trees, Operon::Dataset const& dataset, Operon::Range range, std::span<Operon::Scalar> result, size_t nthread = 0) -> void;
+
+// row-parallel evaluation of a single tree over large ranges: the range is split into chunks of rows
+// (rounded up to a multiple of the batch size, chosen automatically when chunkSize is zero) which are
+// evaluated concurrently by the executor workers, each with its own interpreter and primal buffer.
+// the dispatch table is provided by the caller so that repeated calls do not rebuild it
+auto OPERON_EXPORT EvaluateRows(tf::Executor& executor, Operon::DefaultDispatch const& dtable, Operon::Tree const& tree, Operon::Dataset const& dataset, Operon::Range range, Operon::Span<Operon::Scalar const> coeff, Operon::Span<Operon::Scalar> result, std::size_t chunkSize = 0) -> void;
+auto OPERON_EXPORT EvaluateRows(Operon::Tree const& tree, Operon::Dataset const& dataset, Operon::Range range, size_t nthread = 0, std::size_t chunkSize = 0) -> std::vector<Operon::Scalar>;
+
+// row-parallel reverse mode jacobian (range.Size() x coeff.size(), column-major)
+auto OPERON_EXPORT JacRevRows(tf::Executor& executor, Operon::DefaultDispatch const& dtable, Operon::Tree const& tree, Operon::Dataset const& dataset, Operon::Range range, Operon::Span<Operon::Scalar const> coeff, Operon::Span<Operon::Scalar> jacobian, std::size_t chunkSize = 0) -> void;
+
+// row-parallel normal equations (see InterpreterBase::NormalEquations): each chunk accumulates its own
+// J^T J and J^T r, which are then summed. the target holds the values of the range
+auto OPERON_EXPORT NormalEquationsRows(tf::Executor& executor, Operon::DefaultDispatch const& dtable, Operon::Tree const& tree, Operon::Dataset const& dataset, Operon::Range range, Operon::Span<Operon::Scalar const> coeff, Operon::Span<Operon::Scalar const> target, Operon::Span<double> jtj, Operon::Span<double> jtr, std::size_t chunkSize = 0) -> double;
 } // namespace Operon
 #endif
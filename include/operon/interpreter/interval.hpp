@@ -0,0 +1,89 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2024 Heal Research
+
+#ifndef OPERON_INTERPRETER_INTERVAL_HPP
+#define OPERON_INTERPRETER_INTERVAL_HPP
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "operon/core/dataset.hpp"
+#include "operon/core/range.hpp"
+#include "operon/core/tree.hpp"
+#include "operon/core/types.hpp"
+#include "operon/operon_export.hpp"
+
+namespace Operon {
+
+// closed interval [Lower, Upper], NaN bounds mean that the function may be undefined somewhere in the interval
+struct Interval {
+    Operon::Scalar Lower{ -std::numeric_limits<Operon::Scalar>::infinity() };
+    Operon::Scalar Upper{ +std::numeric_limits<Operon::Scalar>::infinity() };
+
+    [[nodiscard]] auto IsDefined() const -> bool { return !std::isnan(Lower) && !std::isnan(Upper); }
+    [[nodiscard]] auto IsFinite() const -> bool { return std::isfinite(Lower) && std::isfinite(Upper); }
+    [[nodiscard]] auto Contains(Operon::Scalar x) const -> bool { return Lower <= x && x <= Upper; }
+    [[nodiscard]] auto Width() const -> Operon::Scalar { return Upper - Lower; }
+
+    static auto Undefined() -> Interval
+    {
+        return { std::numeric_limits<Operon::Scalar>::quiet_NaN(), std::numeric_limits<Operon::Scalar>::quiet_NaN() };
+    }
+};
+
+// propagates the value ranges of the variables through a tree in a single pass over the nodes, without
+// touching the data. the result encloses the tree output for all the rows inside the variable bounds, so
+// it is a cheap (and conservative) way to detect trees that produce NaN or infinite values: logarithms or
+// square roots of negative arguments, divisions by intervals containing zero, overflowing exponentials.
+// the bounds are not rounded outwards, the intervals are meant for validity checks and not as rigorous
+// enclosures.
+//
+// by default only the trees whose output may be undefined (NaN bounds) are invalid: unbounded intervals
+// are propagated, so a division by an interval containing zero or an overflowing exponential is accepted.
+// in strict mode the nodes with unbounded arguments are undefined, so a tree is valid only if all its
+// nodes have finite intervals. the strict check also rejects trees that are finite everywhere except at
+// isolated points (e.g. x / x), so it is only applied when requested. the symbols without an interval rule
+// (the user-registered callables) are unbounded: accepted by default, rejected by the strict check.
+class OPERON_EXPORT IntervalInterpreter {
+public:
+    // the bounds of each variable are the minimum and maximum of its values in the range
+    IntervalInterpreter(Operon::Dataset const& dataset, Operon::Range range, bool strict = false);
+
+    explicit IntervalInterpreter(Operon::Map<Operon::Hash, Interval> bounds, bool strict = false)
+        : bounds_(std::move(bounds))
+        , strict_(strict)
+    {
+    }
+
+    // the intervals of all the nodes (in postfix order), the last one is the interval of the tree
+    auto Evaluate(Operon::Tree const& tree, std::vector<Interval>& result) const -> void;
+
+    [[nodiscard]] auto Evaluate(Operon::Tree const& tree) const -> std::vector<Interval>
+    {
+        std::vector<Interval> result;
+        Evaluate(tree, result);
+        return result;
+    }
+
+    // the interval of the tree output
+    [[nodiscard]] auto operator()(Operon::Tree const& tree) const -> Interval;
+
+    // true if the tree output is defined (and, in strict mode, finite) for every point inside the variable bounds
+    [[nodiscard]] auto IsValid(Operon::Tree const& tree) const -> bool
+    {
+        auto const x = (*this)(tree);
+        return strict_ ? x.IsFinite() : x.IsDefined();
+    }
+
+    [[nodiscard]] auto Bounds() const -> Operon::Map<Operon::Hash, Interval> const& { return bounds_; }
+    [[nodiscard]] auto Strict() const -> bool { return strict_; }
+
+private:
+    Operon::Map<Operon::Hash, Interval> bounds_;
+    bool strict_{false};
+};
+
+} // namespace Operon
+
+#endif
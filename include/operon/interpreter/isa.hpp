@@ -0,0 +1,75 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2024 Heal Research
+
+#ifndef OPERON_INTERPRETER_ISA_HPP
+#define OPERON_INTERPRETER_ISA_HPP
+
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+#include "operon/operon_export.hpp"
+
+// the translation units of the kernel variants (see source/interpreter/isa/variant.cpp.in) define
+// OPERON_ISA_NAMESPACE to a name of their own. the code they instantiate (the dispatch entry points, the
+// primitives and the math backends) is then declared in an inline namespace of that name, so that its
+// symbols differ from the ones of the other variants and of the generic code: otherwise the linker could
+// keep a single out-of-line copy, compiled for another instruction set or with another math backend
+#if defined(OPERON_ISA_NAMESPACE)
+#define OPERON_ISA_NAMESPACE_BEGIN inline namespace OPERON_ISA_NAMESPACE {
+#define OPERON_ISA_NAMESPACE_END }
+#else
+#define OPERON_ISA_NAMESPACE_BEGIN
+#define OPERON_ISA_NAMESPACE_END
+#endif
+
+namespace Operon {
+
+// the built-in primitives of the dispatch tables (for Operon::Scalar and the default batch size) are
+// compiled into the library for several x86-64 instruction sets, so that a single build can use the
+// widest vector units of the processor it runs on. Generic stands for the kernels compiled with the
+// default flags (for the configured math backend, the inline kernels of the code including the interpreter).
+enum class InstructionSet : uint8_t {
+    Generic,
+    Sse42,  // sse4.2, popcnt
+    Avx2,   // avx2, fma, bmi2
+    Avx512  // avx512f/bw/cd/dq/vl
+};
+
+// the instruction set used by the dispatch tables created from now on. it defaults to the best one
+// supported by the processor, unless the OPERON_ISA environment variable requests another one
+// (generic, sse4.2, avx2 or avx512). an unknown or unavailable request is ignored with a warning
+OPERON_EXPORT auto GetInstructionSet() -> InstructionSet;
+
+// throws if the instruction set is not available, the existing dispatch tables keep their kernels
+OPERON_EXPORT auto SetInstructionSet(InstructionSet isa) -> void;
+
+// compiled into the library and supported by the processor
+OPERON_EXPORT auto IsAvailable(InstructionSet isa) -> bool;
+
+OPERON_EXPORT auto InstructionSetName(InstructionSet isa) -> std::string_view;
+OPERON_EXPORT auto ParseInstructionSet(std::string_view name) -> std::optional<InstructionSet>;
+
+// besides the configured one (Default), other header-only math backends may be compiled into the library
+// (MATH_BACKENDS), for every instruction set. a dispatch table can then evaluate some or all of its
+// primitives with them (see DispatchTable::SetBackend), e.g. fast approximations during the search and
+// the exact functions for coefficient fitting and for reporting the final models
+enum class MathBackend : uint8_t {
+    Default,
+    Eigen,
+    Stl,
+    Eve,
+    FastV1,
+    FastV2,
+    FastV3
+};
+
+// compiled into the library (always true for the configured backend)
+OPERON_EXPORT auto IsAvailable(MathBackend backend) -> bool;
+
+OPERON_EXPORT auto MathBackendName(MathBackend backend) -> std::string_view;
+OPERON_EXPORT auto ParseMathBackend(std::string_view name) -> std::optional<MathBackend>;
+
+} // namespace Operon
+
+#endif
@@ -0,0 +1,85 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2024 Heal Research
+
+#ifndef OPERON_INTERPRETER_MULTI_INTERPRETER_HPP
+#define OPERON_INTERPRETER_MULTI_INTERPRETER_HPP
+
+#include <concepts>
+#include <functional>
+#include <ranges>
+#include <vector>
+
+#include "interpreter.hpp"
+
+namespace Operon {
+
+// evaluates a group of trees over the same range with the row blocks in the outer loop and the trees
+// in the inner loop: each block of input values is loaded from memory once and is still in cache when
+// the next tree reads it. this pays off when the dataset does not fit in cache, as long as the primal
+// buffers of the group (BatchSize x tree length each) do, hence groups of a few trees work best.
+template<typename T = Operon::Scalar, typename DTable = DefaultDispatch>
+class MultiInterpreter {
+    using TInterpreter = Interpreter<T, DTable>;
+
+public:
+    static constexpr auto BatchSize = TInterpreter::BatchSize;
+    static constexpr std::size_t DefaultGroupSize{8};
+
+    MultiInterpreter(DTable const& dtable, Operon::Dataset const& dataset)
+        : dtable_(dtable)
+        , dataset_(dataset)
+    {
+    }
+
+    auto GetDispatchTable() const -> DTable const& { return dtable_.get(); }
+    auto GetDataset() const -> Operon::Dataset const& { return dataset_.get(); }
+
+    // the result holds range.Size() values for each tree, one tree after the other
+    template<std::ranges::random_access_range R, typename Proj = std::identity>
+    auto Evaluate(R const& trees, Operon::Range range, Operon::Span<T> result, Proj proj = {}) -> void
+    {
+        auto const len { range.Size() };
+        EXPECT(result.size() >= std::size(trees) * len);
+        Evaluate(trees, range, [&](std::size_t i) { return result.subspan(i * len, len); }, proj);
+    }
+
+    // the output callable returns the result span for the i-th tree
+    template<std::ranges::random_access_range R, typename Out, typename Proj = std::identity>
+    requires std::invocable<Out, std::size_t>
+    auto Evaluate(R const& trees, Operon::Range range, Out&& output, Proj proj = {}) -> void
+    {
+        auto const n { std::ssize(trees) };
+        if (std::ssize(tapes_) < n) { tapes_.resize(n); }
+
+        interpreters_.clear();
+        interpreters_.reserve(n);
+        outputs_.clear();
+        outputs_.reserve(n);
+        for (auto i = 0L; i < n; ++i) {
+            Operon::Tree const& tree = std::invoke(proj, trees[i]);
+            interpreters_.emplace_back(dtable_.get(), dataset_.get(), tree, &tapes_[i]).Prepare({});
+            outputs_.push_back(output(static_cast<std::size_t>(i)));
+        }
+
+        auto const len{ static_cast<int64_t>(range.Size()) };
+        constexpr int64_t S{ BatchSize };
+        for (auto row = 0L; row < len; row += S) {
+            for (auto i = 0L; i < n; ++i) {
+                interpreters_[i].EvaluateBlock(range, row, outputs_[i]);
+            }
+        }
+    }
+
+private:
+    std::reference_wrapper<DTable const> dtable_;
+    std::reference_wrapper<Operon::Dataset const> dataset_;
+
+    // kept between calls so that evaluating another group reuses the buffers
+    std::vector<Tape<T, DTable>> tapes_;
+    std::vector<TInterpreter> interpreters_;
+    std::vector<Operon::Span<T>> outputs_;
+};
+
+} // namespace Operon
+
+#endif
@@ -0,0 +1,210 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2024 Heal Research
+
+#ifndef OPERON_INTERPRETER_SUBTREE_CACHE_HPP
+#define OPERON_INTERPRETER_SUBTREE_CACHE_HPP
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "operon/core/contracts.hpp"
+#include "operon/core/range.hpp"
+#include "operon/core/types.hpp"
+
+namespace Operon {
+
+// bounded cache of subtree outputs shared by the interpreters of all the workers. the outputs are keyed
+// by a strict subtree hash (see Interpreter) and the evaluation range, so the children of an offspring
+// that are identical to subtrees of its parents are not evaluated again. the cache is split into shards
+// with their own lock and least-recently-used list, the memory budget is divided evenly between them.
+// the output buffers and the list entries of the evicted outputs are recycled (unless an interpreter still
+// reads them), so that once the cache is full, the outputs of new subtrees are stored without allocating.
+// the keys do not identify the dataset, hence a cache must only be used with a single dataset.
+template<typename T = Operon::Scalar>
+class SubtreeCache {
+public:
+    using Value = std::shared_ptr<std::vector<T> const>;
+    using Buffer = std::shared_ptr<std::vector<T>>;
+
+    static constexpr std::size_t DefaultCapacity{ 64UL << 20U }; // bytes
+    static constexpr std::size_t DefaultMinLength{ 3 };          // nodes
+    static constexpr std::size_t ShardCount{ 16 };
+
+    explicit SubtreeCache(std::size_t capacity = DefaultCapacity, std::size_t minLength = DefaultMinLength)
+        : capacity_(capacity)
+        , minLength_(minLength)
+    {
+    }
+
+    // returns the cached output (nullptr if missing) and marks it as recently used
+    auto Find(Operon::Hash hash, Operon::Range range) -> Value
+    {
+        auto& shard = GetShard(hash);
+        std::scoped_lock lock(shard.Mutex);
+        if (auto it = shard.Index.find(Combine(hash, range)); it != shard.Index.end() && it->second->Matches(hash, range)) {
+            shard.Entries.splice(shard.Entries.begin(), shard.Entries, it->second);
+            ++hits_;
+            return it->second->Data;
+        }
+        ++misses_;
+        return nullptr;
+    }
+
+    // outputs larger than the shard budget are not cached
+    [[nodiscard]] auto Admits(std::size_t rows) const -> bool { return rows * sizeof(T) <= capacity_ / ShardCount; }
+
+    // a buffer for the output of a missing subtree (to be inserted once computed), recycled from the
+    // evicted outputs when one of them is large enough
+    auto Acquire(std::size_t rows) -> Buffer
+    {
+        {
+            std::scoped_lock lock(poolMutex_);
+            auto it = std::ranges::find_if(pool_, [&](auto const& b) { return b->capacity() >= rows; });
+            if (it != pool_.end()) {
+                auto buffer = std::move(*it);
+                *it = std::move(pool_.back());
+                pool_.pop_back();
+                pooled_ -= buffer->capacity() * sizeof(T);
+                buffer->resize(rows);
+                return buffer;
+            }
+        }
+        return std::make_shared<std::vector<T>>(rows);
+    }
+
+    auto Insert(Operon::Hash hash, Operon::Range range, Buffer data) -> void
+    {
+        EXPECT(data != nullptr && data->size() == range.Size());
+        if (!Admits(data->size())) { return; }
+        auto const bytes { data->size() * sizeof(T) };
+        auto const budget { capacity_ / ShardCount };
+
+        auto& shard = GetShard(hash);
+        std::scoped_lock lock(shard.Mutex);
+        auto const key { Combine(hash, range) };
+        if (auto it = shard.Index.find(key); it != shard.Index.end()) {
+            // another worker inserted it first or the combined keys collide, the newest entry wins
+            Remove(shard, it->second);
+        }
+        while (shard.Bytes + bytes > budget) {
+            Remove(shard, std::prev(shard.Entries.end()));
+            ++evictions_;
+        }
+        if (shard.Free.empty()) {
+            shard.Entries.push_front(Entry{ hash, range, std::move(data) });
+        } else {
+            shard.Entries.splice(shard.Entries.begin(), shard.Free, shard.Free.begin());
+            shard.Entries.front() = Entry{ hash, range, std::move(data) };
+        }
+        shard.Index[key] = shard.Entries.begin();
+        shard.Bytes += bytes;
+        bytes_ += bytes;
+    }
+
+    auto Clear() -> void
+    {
+        for (auto& shard : shards_) {
+            std::scoped_lock lock(shard.Mutex);
+            shard.Entries.clear();
+            shard.Free.clear();
+            shard.Index.clear();
+            shard.Bytes = 0;
+        }
+        {
+            std::scoped_lock lock(poolMutex_);
+            pool_.clear();
+            pooled_ = 0;
+        }
+        bytes_ = 0;
+        hits_ = 0;
+        misses_ = 0;
+        evictions_ = 0;
+    }
+
+    // only subtrees with at least this many nodes are cached (smaller ones are cheaper to recompute)
+    [[nodiscard]] auto MinLength() const -> std::size_t { return minLength_; }
+    [[nodiscard]] auto Capacity() const -> std::size_t { return capacity_; }
+
+    [[nodiscard]] auto Hits() const -> std::size_t { return hits_.load(); }
+    [[nodiscard]] auto Misses() const -> std::size_t { return misses_.load(); }
+    [[nodiscard]] auto Evictions() const -> std::size_t { return evictions_.load(); }
+    [[nodiscard]] auto Bytes() const -> std::size_t { return bytes_.load(); }
+    [[nodiscard]] auto HitRate() const -> double
+    {
+        auto const total { Hits() + Misses() };
+        return total == 0 ? 0.0 : static_cast<double>(Hits()) / static_cast<double>(total);
+    }
+
+private:
+    struct Entry {
+        Operon::Hash Hash;
+        Operon::Range Range;
+        Buffer Data;
+
+        [[nodiscard]] auto Matches(Operon::Hash hash, Operon::Range range) const -> bool
+        {
+            return Hash == hash && Range.Start() == range.Start() && Range.Size() == range.Size();
+        }
+    };
+
+    struct Shard {
+        std::mutex Mutex;
+        std::list<Entry> Entries; // most recently used first
+        std::list<Entry> Free;    // removed entries, reused by the next insertions
+        Operon::Map<Operon::Hash, typename std::list<Entry>::iterator> Index;
+        std::size_t Bytes{0};
+    };
+
+    static auto Combine(Operon::Hash hash, Operon::Range range) -> Operon::Hash
+    {
+        constexpr Operon::Hash prime{ 0x9E3779B97F4A7C15UL };
+        return (hash ^ (range.Start() * prime)) + (range.Size() * prime) + (hash << 6U) + (hash >> 2U);
+    }
+
+    auto GetShard(Operon::Hash hash) -> Shard& { return shards_[hash % ShardCount]; }
+
+    auto Remove(Shard& shard, typename std::list<Entry>::iterator it) -> void
+    {
+        auto const bytes { it->Data->size() * sizeof(T) };
+        shard.Index.erase(Combine(it->Hash, it->Range));
+        Recycle(std::move(it->Data));
+        shard.Free.splice(shard.Free.begin(), shard.Entries, it);
+        shard.Bytes -= bytes;
+        bytes_ -= bytes;
+    }
+
+    // the buffers which are no longer read by an interpreter are kept for Acquire, up to the budget of one
+    // shard. the shard lock is held, so no other reference can be handed out in the meantime
+    auto Recycle(Buffer data) -> void
+    {
+        if (data.use_count() != 1) { return; }
+        auto const bytes { data->capacity() * sizeof(T) };
+        std::scoped_lock lock(poolMutex_);
+        if (pooled_ + bytes > capacity_ / ShardCount) { return; }
+        pool_.push_back(std::move(data));
+        pooled_ += bytes;
+    }
+
+    std::size_t capacity_;
+    std::size_t minLength_;
+    std::array<Shard, ShardCount> shards_;
+
+    std::mutex poolMutex_;
+    std::vector<Buffer> pool_;
+    std::size_t pooled_{0};
+
+    std::atomic_size_t bytes_{0};
+    std::atomic_size_t hits_{0};
+    std::atomic_size_t misses_{0};
+    std::atomic_size_t evictions_{0};
+};
+
+} // namespace Operon
+
+#endif
@@ -0,0 +1,414 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2024 Heal Research
+
+#ifndef OPERON_INTERPRETER_TAPE_HPP
+#define OPERON_INTERPRETER_TAPE_HPP
+
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#include "operon/core/dataset.hpp"
+#include "operon/core/tree.hpp"
+#include "operon/core/types.hpp"
+#include "dispatch_table.hpp"
+
+namespace Operon {
+
+namespace detail {
+    // aligned allocation
+    template<class T>
+    struct Deleter {
+        auto operator()(T* p) const -> void {
+            std::free(p); // NOLINT
+        }
+    };
+
+    template<class T>
+    using AlignedUnique = std::unique_ptr<T[], Deleter<T>>;
+
+    template<class ElementType, size_t ByteAlignment>
+    auto AllocateAligned(auto const numElements) -> AlignedUnique<ElementType>
+    {
+        auto const numBytes = numElements * sizeof(ElementType);
+        auto* ptr = std::aligned_alloc(ByteAlignment, numBytes);
+        return AlignedUnique<ElementType>(static_cast<ElementType*>(ptr));
+    }
+}  // namespace detail
+
+// the coefficients of a subtree are consecutive, so the forward mode tangent of a node only needs columns
+// for the coefficients in its subtree: Count columns starting at coefficient First, stored at column
+// Offset of the tangent buffer (see Interpreter::ForwardTrace)
+struct TangentBlock {
+    int64_t Offset;
+    int64_t First;
+    int64_t Count;
+};
+
+// a tape is the compiled evaluation plan of a tree: the dispatch table lookups, the dataset column
+// lookups and the mapping of coefficients to nodes are resolved once by Compile(). afterwards, an
+// evaluation with new coefficients only needs to update the node weights (SetCoefficients) before
+// running the numeric kernels. the tape holds non-owning pointers into the dispatch table and the
+// dataset, therefore it must be recompiled if either of them (or the tree structure) is modified. the
+// compiled tape is identified by the dispatch table, the dataset and a fingerprint of the node symbols,
+// lengths and optimization flags, so that an in-place mutation of the tree is detected by IsCompiled.
+// subtrees without variables produce the same value on every row: they are folded, i.e. evaluated once
+// over a single batch when their coefficients change, and the evaluation then only runs the live nodes.
+// the add, sub and mul nodes with variable children use a fused primitive which reads the (weighted)
+// dataset values directly, so these variables are only written to the primal buffer when tracing.
+template<typename T, typename DTable>
+class Tape {
+public:
+    static constexpr auto BatchSize = DTable::template BatchSize<T>;
+
+    using Kernel        = typename DTable::template Kernel<T>;
+    using KernelDiff    = typename DTable::template KernelDiff<T>;
+    using CallableFused = Dispatch::CallableFused<T>;
+
+    struct Instruction {
+        T Coefficient{1};                       // node weight (the value for constants)
+        Operon::Scalar const* Values{nullptr};  // dataset column (variables only)
+        Kernel Function{};                      // primitive resolved from the dispatch table
+        KernelDiff Derivative{};                // derivative resolved from the dispatch table
+        int64_t Slot{-1};                       // index in the coefficients vector (-1 if not optimized)
+        bool Folded{false};                     // part of a subtree without variables
+        CallableFused Fused{nullptr};           // fused primitive (functions with variable children)
+        bool Inlined{false};                    // variable read directly by the fused parent
+    };
+
+    Tape() = default;
+
+    Tape(DTable const& dtable, Operon::Dataset const& dataset, Operon::Tree const& tree)
+    {
+        Compile(dtable, dataset, tree);
+    }
+
+    auto Compile(DTable const& dtable, Operon::Dataset const& dataset, Operon::Tree const& tree) -> void
+    {
+        auto const& nodes = tree.Nodes();
+        auto const nn { std::ssize(nodes) };
+        constexpr int64_t S{ BatchSize };
+
+        code_.clear();
+        code_.reserve(nn);
+        constants_.clear();
+        slots_.clear();
+        live_.clear();
+        folded_.clear();
+
+        int64_t slot{0};
+        for (auto i = 0L; i < nn; ++i) {
+            auto const& n = nodes[i];
+            Instruction ins{ .Coefficient = T{n.Value} };
+
+            if (n.IsVariable()) {
+                ins.Values = dataset.GetValues(n.HashValue).data();
+            } else if (auto f = dtable.template TryGetFunction<T>(n.HashValue)) {
+                ins.Function   = *f;
+                ins.Derivative = dtable.template GetDerivative<T>(n.HashValue);
+            }
+
+            if (!n.IsLeaf() && !ins.Function) {
+                throw std::runtime_error(fmt::format("Missing primitive for node {}\n", n.Name()));
+            }
+
+            // the dataset values are only usable as operands when they have the evaluation type
+            if constexpr (std::is_same_v<T, Operon::Scalar>) {
+                if (!n.IsLeaf() && std::ranges::any_of(Tree::Indices(nodes, i), [&](auto j) { return nodes[j].IsVariable(); })) {
+                    ins.Fused = dtable.template GetFused<T>(n.HashValue);
+                }
+                if (ins.Fused != nullptr) {
+                    for (auto j : Tree::Indices(nodes, i)) { code_[j].Inlined = nodes[j].IsVariable(); }
+                }
+            }
+
+            if (n.Optimize) { ins.Slot = slot++; slots_.push_back(i); }
+            if (n.IsConstant()) { constants_.push_back(i); }
+
+            ins.Folded = n.IsLeaf()
+                ? n.IsConstant()
+                : std::ranges::all_of(Tree::Indices(nodes, i), [&](auto j) { return code_[j].Folded; });
+            if (!ins.Folded) { live_.push_back(i); } else if (!n.IsLeaf()) { folded_.push_back(i); }
+            code_.push_back(ins);
+        }
+        coefficientCount_ = slot;
+        foldedValid_ = false;
+        dtable_ = &dtable;
+        dataset_ = &dataset;
+        fingerprint_ = Fingerprint(nodes);
+        ++frozenEpoch_;
+
+        // the buffers only grow, so recompiling for a smaller tree does not allocate
+        if (capacity_ < nn) {
+            primalStorage_ = detail::AllocateAligned<T, Backend::DefaultAlignment>(S * nn);
+            traceStorage_.reset();
+            capacity_ = nn;
+        }
+        std::ranges::fill_n(primalStorage_.get(), S * nn, T{0});
+        primal_ = Backend::View<T, BatchSize>(primalStorage_.get(), S, nn);
+        trace_ = {};
+        nodes_ = &nodes;
+    }
+
+    // update the node weights from the coefficients vector (or from the tree when coeff is empty). the
+    // constants and the folded subtrees are only recomputed when one of their coefficients changed
+    auto SetCoefficients(Operon::Vector<Node> const& nodes, Operon::Span<T const> coeff) -> void
+    {
+        EXPECT(std::ssize(nodes) == std::ssize(code_));
+        auto changed { !foldedValid_ };
+        for (auto i = 0L; i < std::ssize(code_); ++i) {
+            auto& ins = code_[i];
+            auto const value = (!coeff.empty() && ins.Slot >= 0) ? T{coeff[ins.Slot]} : T{nodes[i].Value};
+            changed = changed || (ins.Folded && value != ins.Coefficient);
+            ins.Coefficient = value;
+        }
+        if (!changed) { return; }
+
+        constexpr int64_t S{ BatchSize };
+        for (auto i : constants_) {
+            Fill<T, S>(primal_, static_cast<int>(i), code_[i].Coefficient);
+        }
+
+        // the primitives compute whole batches, one batch holds the (broadcast) value of the subtree
+        for (auto i : folded_) {
+            auto const& ins = code_[i];
+            ins.Function(nodes, primal_, i, Operon::Range{0, S});
+            if (ins.Coefficient != T{1}) {
+                auto* ptr = primal_.data_handle() + i * S;
+                std::ranges::transform(std::span(ptr, S), ptr, [w = ins.Coefficient](auto x) { return x * w; });
+            }
+        }
+        foldedValid_ = true;
+    }
+
+    // true if the tape was compiled for the given tree (in its current state), dispatch table and dataset
+    [[nodiscard]] auto IsCompiled(DTable const& dtable, Operon::Dataset const& dataset, Operon::Tree const& tree) const -> bool
+    {
+        auto const& nodes = tree.Nodes();
+        return nodes_ == &nodes && dtable_ == &dtable && dataset_ == &dataset
+            && std::ssize(code_) == std::ssize(nodes) && fingerprint_ == Fingerprint(nodes);
+    }
+
+    [[nodiscard]] auto Primal() const { return primal_; }
+
+    // the trace buffer is only needed for derivatives and is allocated on first use
+    [[nodiscard]] auto Trace() const
+    {
+        if (trace_.data_handle() == nullptr) {
+            constexpr int64_t S{ BatchSize };
+            if (!traceStorage_) {
+                traceStorage_ = detail::AllocateAligned<T, Backend::DefaultAlignment>(S * capacity_);
+            }
+            trace_ = Backend::View<T, BatchSize>(traceStorage_.get(), S, std::ssize(code_));
+        }
+        return trace_;
+    }
+
+    // scratch buffer for the forward mode tangents (the interpreter decides how many columns each node uses)
+    [[nodiscard]] auto Tangent(int64_t columns) const
+    {
+        constexpr int64_t S{ BatchSize };
+        auto const size { S * std::max(columns, int64_t{1}) };
+        if (tangentSize_ < size) {
+            tangentStorage_ = detail::AllocateAligned<T, Backend::DefaultAlignment>(size);
+            tangentSize_ = size;
+        }
+        return Backend::View<T, BatchSize>(tangentStorage_.get(), S, columns);
+    }
+
+    // scratch for a batch of jacobian rows (see Interpreter::NormalEquations)
+    [[nodiscard]] auto JacobianBatch(int64_t columns) const
+    {
+        constexpr int64_t S{ BatchSize };
+        auto const size { S * std::max(columns, int64_t{1}) };
+        if (jacobianSize_ < size) {
+            jacobianStorage_ = detail::AllocateAligned<T, Backend::DefaultAlignment>(size);
+            jacobianSize_ = size;
+        }
+        return Backend::View<T, BatchSize>(jacobianStorage_.get(), S, columns);
+    }
+
+    // the same batch in double precision, in which the normal equations are accumulated
+    [[nodiscard]] auto NormalBatch(int64_t columns) const -> Operon::Span<double>
+    {
+        constexpr int64_t S{ BatchSize };
+        auto const size { S * std::max(columns, int64_t{1}) };
+        if (normalSize_ < size) {
+            normalStorage_ = detail::AllocateAligned<double, Backend::DefaultAlignment>(size);
+            normalSize_ = size;
+        }
+        return { normalStorage_.get(), static_cast<std::size_t>(size) };
+    }
+
+    // operands of the fused primitives (see Interpreter::ForwardNode)
+    [[nodiscard]] auto Operands() const -> std::vector<Dispatch::Operand<T>>& { return operands_; }
+
+    // scratch of the subtree cache lookups (see Interpreter::EvaluateCached)
+    struct CacheScratch {
+        enum class Action : uint8_t { Evaluate, Skip, Load, Store };
+        std::vector<Operon::Hash> Keys;
+        std::vector<uint64_t> Words;
+        std::vector<Action> Actions;
+        std::vector<std::shared_ptr<std::vector<T> const>> Loaded;
+        std::vector<std::shared_ptr<std::vector<T>>> Stored;
+    };
+    [[nodiscard]] auto Cached() const -> CacheScratch& { return cached_; }
+
+    // the tangent blocks of the nodes when only the first p coefficients are considered, computed in a
+    // buffer owned by the tape (valid until the next call)
+    [[nodiscard]] auto TangentLayout(Operon::Vector<Node> const& nodes, int64_t p) const -> Operon::Span<TangentBlock const>
+    {
+        auto const nn { std::ssize(nodes) };
+        layout_.resize(nn);
+        // the number of coefficients before each node is kept in First until the node is visited
+        int64_t slots{0};
+        for (auto i = 0L; i < nn; ++i) {
+            layout_[i].First = slots;
+            slots += static_cast<int64_t>(nodes[i].Optimize);
+        }
+        // backwards, the first node of each subtree still holds its count
+        for (auto i = nn-1; i >= 0L; --i) {
+            auto const end { layout_[i].First + static_cast<int64_t>(nodes[i].Optimize) };
+            auto const first { layout_[i - nodes[i].Length].First };
+            layout_[i].First = first;
+            layout_[i].Count = std::max(std::min(end, p) - first, int64_t{0});
+        }
+        int64_t offset{0};
+        for (auto& b : layout_) {
+            b.Offset = offset;
+            offset += b.Count;
+        }
+        return { layout_.data(), layout_.size() };
+    }
+
+    // scratch buffers of the frozen subtrees (see Interpreter::Freeze): one state per node and the frozen
+    // outputs. they only grow, so that freezing the trees of a local search does not allocate. the state is
+    // requested once per Freeze, which starts a new epoch
+    [[nodiscard]] auto FrozenState() const -> Operon::Span<int64_t>
+    {
+        ++frozenEpoch_;
+        frozenState_.resize(code_.size());
+        return { frozenState_.data(), frozenState_.size() };
+    }
+
+    [[nodiscard]] auto FrozenValues(std::size_t size) const -> Operon::Span<T>
+    {
+        // exact capacity: the buffer is retained as long as it fits in the freeze budget (see ShrinkFrozen)
+        if (frozenValues_.size() < size) { frozenValues_.reserve(size); frozenValues_.resize(size); }
+        return { frozenValues_.data(), size };
+    }
+
+    // changes when the tape is compiled, frozen again or releases the frozen outputs: the views of an
+    // interpreter into the frozen buffers are only valid within the epoch of its Freeze
+    [[nodiscard]] auto FrozenEpoch() const -> uint64_t { return frozenEpoch_; }
+
+    // releases the frozen outputs when they take more than `retain` bytes (e.g. at the end of a local
+    // search, so that a worker tape does not keep the outputs of a large range)
+    auto ShrinkFrozen(std::size_t retain) const -> void
+    {
+        if (frozenValues_.capacity() * sizeof(T) <= retain) { return; }
+        std::vector<T>{}.swap(frozenValues_);
+        ++frozenEpoch_;
+    }
+
+    // nodes that must be evaluated for every batch (the variables and the functions depending on them),
+    // the inlined variables are skipped by the evaluation and only materialized when tracing
+    [[nodiscard]] auto Live() const -> Operon::Span<int64_t const> { return { live_.data(), live_.size() }; }
+    // function nodes without variables in their subtree, evaluated by SetCoefficients
+    [[nodiscard]] auto Folded() const -> Operon::Span<int64_t const> { return { folded_.data(), folded_.size() }; }
+
+    // node indices of the optimized coefficients, in coefficient order
+    [[nodiscard]] auto Slots() const -> Operon::Span<int64_t const> { return { slots_.data(), slots_.size() }; }
+
+    [[nodiscard]] auto Code() const -> Operon::Span<Instruction const> { return { code_.data(), code_.size() }; }
+    [[nodiscard]] auto Size() const -> std::size_t { return code_.size(); }
+    [[nodiscard]] auto CoefficientCount() const -> int64_t { return coefficientCount_; }
+
+    auto operator[](std::size_t i) const -> Instruction const& { return code_[i]; }
+
+private:
+    // the coefficient values are not part of the fingerprint, they are read by SetCoefficients on every call
+    static auto Fingerprint(Operon::Vector<Node> const& nodes) -> uint64_t
+    {
+        uint64_t h{ static_cast<uint64_t>(nodes.size()) };
+        for (auto const& n : nodes) {
+            auto const v = n.HashValue ^ (static_cast<uint64_t>(n.Length) << 1U) ^ static_cast<uint64_t>(n.Optimize);
+            h ^= v + 0x9e3779b97f4a7c15ULL + (h << 6U) + (h >> 2U); // NOLINT
+        }
+        return h;
+    }
+
+    std::vector<Instruction> code_;
+    std::vector<int64_t> constants_;
+    std::vector<int64_t> slots_;
+    std::vector<int64_t> live_;
+    std::vector<int64_t> folded_;
+    bool foldedValid_{false};
+    int64_t coefficientCount_{0};
+    int64_t capacity_{0};
+    Operon::Vector<Node> const* nodes_{nullptr};
+    DTable const* dtable_{nullptr};
+    Operon::Dataset const* dataset_{nullptr};
+    uint64_t fingerprint_{0};
+
+    Backend::View<T, BatchSize> primal_;
+    mutable Backend::View<T, BatchSize> trace_;
+
+    detail::AlignedUnique<T> primalStorage_;
+    mutable detail::AlignedUnique<T> traceStorage_;
+    mutable detail::AlignedUnique<T> tangentStorage_;
+    mutable int64_t tangentSize_{0};
+    mutable std::vector<int64_t> frozenState_;
+    mutable std::vector<T> frozenValues_;
+    mutable uint64_t frozenEpoch_{0};
+    mutable std::vector<TangentBlock> layout_;
+    mutable detail::AlignedUnique<T> jacobianStorage_;
+    mutable int64_t jacobianSize_{0};
+    mutable detail::AlignedUnique<double> normalStorage_;
+    mutable int64_t normalSize_{0};
+    mutable std::vector<Dispatch::Operand<T>> operands_;
+    mutable CacheScratch cached_;
+};
+
+// per-worker scratch memory (e.g. one tape per executor worker): the owner (an evaluator or optimizer) is
+// told how many workers there are and how to identify the calling worker (e.g. tf::Executor::this_worker_id),
+// so that consecutive evaluations on the same worker reuse the same (monotonically growing) buffers
+template<typename V>
+class WorkerPool {
+public:
+    WorkerPool() = default;
+    ~WorkerPool() = default;
+
+    // the workspaces are scratch memory: copies start out empty and unconfigured
+    WorkerPool(WorkerPool const& /*unused*/) { }
+    WorkerPool(WorkerPool&&) noexcept = default;
+    auto operator=(WorkerPool const& /*unused*/) -> WorkerPool& { return *this; } // NOLINT
+    auto operator=(WorkerPool&&) noexcept -> WorkerPool& = default;
+
+    auto Configure(std::size_t count, std::function<int()> workerId) -> void
+    {
+        if (items_.size() < count) { items_.resize(count); }
+        workerId_ = std::move(workerId);
+    }
+
+    // returns nullptr when called outside of a configured worker
+    [[nodiscard]] auto Local() -> V*
+    {
+        if (!workerId_) { return nullptr; }
+        auto const id = workerId_();
+        return (id >= 0 && id < std::ssize(items_)) ? &items_[id] : nullptr;
+    }
+
+private:
+    std::vector<V> items_;
+    std::function<int()> workerId_;
+};
+
+template<typename T, typename DTable>
+using TapePool = WorkerPool<Tape<T, DTable>>;
+} // namespace Operon
+
+#endif
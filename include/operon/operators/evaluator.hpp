@@ -6,14 +6,19 @@
 
 #include <atomic>
 #include <functional>
+#include <optional>
 #include <utility>
+#include <vector>
 
 #include "operon/collections/projection.hpp"
 #include "operon/core/individual.hpp"
 #include "operon/core/operator.hpp"
 #include "operon/core/problem.hpp"
 #include "operon/core/types.hpp"
+#include "operon/interpreter/dag_interpreter.hpp"
 #include "operon/interpreter/interpreter.hpp"
+#include "operon/interpreter/multi_interpreter.hpp"
+#include "operon/interpreter/subtree_cache.hpp"
 #include "operon/operon_export.hpp"
 #include "operon/optimizer/likelihood/likelihood_base.hpp"
 #include "operon/optimizer/optimizer.hpp"
@@ -28,6 +33,8 @@ struct OPERON_EXPORT ErrorMetric {
 
     explicit ErrorMetric(ErrorType type) : type_(type) { }
 
+    [[nodiscard]] auto Type() const -> ErrorType { return type_; }
+
     auto operator()(Operon::Span<Operon::Scalar const> x, Operon::Span<Operon::Scalar const> y) const -> double;
     auto operator()(Operon::Span<Operon::Scalar const> x, Operon::Span<Operon::Scalar const> y, Operon::Span<Operon::Scalar const> w) const -> double;
     auto operator()(Iterator beg1, Iterator end1, Iterator beg2) const -> double;
@@ -71,6 +78,8 @@ auto OPERON_EXPORT FitLeastSquares(Operon::Span<double const> estimated, Operon:
 struct EvaluatorBase : public OperatorBase<Operon::Vector<Operon::Scalar>, Individual&, Operon::Span<Operon::Scalar>> {
     mutable std::atomic_ulong ResidualEvaluations { 0 }; // NOLINT
     mutable std::atomic_ulong JacobianEvaluations { 0 }; // NOLINT
+    mutable std::atomic_ulong CoefficientCacheHits { 0 }; // NOLINT
+    mutable std::atomic_ulong CoefficientCacheSkips { 0 }; // NOLINT
     mutable std::atomic_ulong CallCount { 0 }; // NOLINT
     mutable std::atomic_ulong CostFunctionTime { 0 }; // NOLINT
 
@@ -91,6 +100,64 @@ struct EvaluatorBase : public OperatorBase<Operon::Vector<Operon::Scalar>, Indiv
 
     virtual auto ObjectiveCount() const -> std::size_t { return 1UL; }
 
+    // evaluate a group of individuals and assign their fitness. by default they are evaluated one by one,
+    // evaluators that can share work within the group override this. the buffer should be large enough
+    // for the model responses of the whole group (group size x training rows)
+    virtual auto Evaluate(Operon::Span<Operon::RandomGenerator> rngs, Operon::Span<Individual> individuals, Operon::Span<Operon::Scalar> buf) const -> void
+    {
+        auto const n { GetProblem().TrainingRange().Size() };
+        auto slot = buf.size() > n ? buf.first(n) : buf;
+        for (auto i = 0UL; i < individuals.size(); ++i) {
+            individuals[i].Fitness = (*this)(rngs[i], individuals[i], slot);
+        }
+    }
+
+    // true if the evaluator merges the identical subtrees of all the individuals passed to Evaluate (see
+    // DagEvaluator): the algorithms then pass larger groups, whose size is not limited by the buffer
+    [[nodiscard]] virtual auto SharesSubtrees() const -> bool { return false; }
+
+    // evaluate an individual that is rejected anyway if its (single) fitness is worse than the threshold.
+    // evaluators supporting it may then stop early and return a lower bound of the fitness which is still
+    // worse than the threshold. by default the individual is fully evaluated
+    virtual auto EvaluateWithThreshold(Operon::RandomGenerator& rng, Individual& ind, Operon::Span<Operon::Scalar> buf, Operon::Scalar /*threshold*/) const -> ReturnType
+    {
+        return (*this)(rng, ind, buf);
+    }
+
+    // progressive evaluation: evaluators scoring the individuals on a sample of the training rows mark
+    // their fitness as approximate (full evaluations leave the flag as is). the algorithms promote the
+    // individuals which survive the selection (the new parents), i.e. evaluate them again on all the
+    // training rows, which clears the flag. returns true if the individual was evaluated again
+    auto Promote(Operon::RandomGenerator& rng, Individual& ind, Operon::Span<Operon::Scalar> buf) const -> bool
+    {
+        if (!ind.Approximate) { return false; }
+        FullEvaluation scope;
+        ind.Fitness = (*this)(rng, ind, buf);
+        ind.Approximate = false;
+        return true;
+    }
+
+    // evaluate a group of individuals on all the training rows, also when subsampling (e.g. the initial
+    // population, which becomes the parent population without a selection)
+    auto EvaluateFull(Operon::Span<Operon::RandomGenerator> rngs, Operon::Span<Individual> individuals, Operon::Span<Operon::Scalar> buf) const -> void
+    {
+        FullEvaluation scope;
+        Evaluate(rngs, individuals, buf);
+    }
+
+    // reuse the outputs of subtrees evaluated before (see SubtreeCache), attached by the algorithms for
+    // the duration of a run. evaluators that do not evaluate trees ignore it
+    virtual auto SetSubtreeCache(SubtreeCache<Operon::Scalar>* /*cache*/) const -> void
+    {
+    }
+
+    // per-worker memory: the algorithms pass the number of executor workers and a function returning
+    // the id of the calling worker (or -1), so that evaluators can reuse their buffers across calls.
+    // an empty function disables the reuse (the buffers are kept for the next configuration)
+    virtual auto SetWorkers(std::size_t /*count*/, std::function<int()> const& /*workerId*/) const -> void
+    {
+    }
+
     auto TotalEvaluations() const -> size_t { return ResidualEvaluations + JacobianEvaluations; }
 
     void SetBudget(size_t value) { budget_ = value; }
@@ -118,11 +185,28 @@ struct EvaluatorBase : public OperatorBase<Operon::Vector<Operon::Scalar>, Indiv
     {
         ResidualEvaluations = 0;
         JacobianEvaluations = 0;
+        CoefficientCacheHits = 0;
+        CoefficientCacheSkips = 0;
         CallCount = 0;
         CostFunctionTime = 0;
     }
 
+protected:
+    // true while an individual is promoted: the row sample must not be used (also when the evaluation
+    // goes through other evaluators, e.g. a MultiEvaluator)
+    static auto FullEvaluationRequested() -> bool { return fullEvaluation_; }
+
 private:
+    struct FullEvaluation {
+        FullEvaluation() { fullEvaluation_ = true; }
+        ~FullEvaluation() { fullEvaluation_ = false; }
+        FullEvaluation(FullEvaluation const&) = delete;
+        FullEvaluation(FullEvaluation&&) = delete;
+        auto operator=(FullEvaluation const&) -> FullEvaluation& = delete;
+        auto operator=(FullEvaluation&&) -> FullEvaluation& = delete;
+    };
+    static inline thread_local bool fullEvaluation_{false}; // NOLINT
+
     mutable Operon::Span<Operon::Individual const> population_;
     std::reference_wrapper<Problem> problem_;
     size_t budget_ = DefaultEvaluationBudget;
@@ -155,10 +239,37 @@ private:
     std::function<typename EvaluatorBase::ReturnType(Operon::RandomGenerator*, Operon::Individual&)> fptr_; // workaround for pybind11
 };
 
+namespace detail {
+    // moments of the (prediction, target) pairs accumulated block by block by the fused fitness mode
+    // (see Evaluator::SetFusedFitness). declared here so that the evaluators can keep them per worker
+    struct FitnessMoments {
+        bool Full{true}; // false: only the count and the unscaled sum of squared errors
+        double Count{0};
+        double MeanX{0};
+        double MeanY{0};
+        double Sxx{0};
+        double Syy{0};
+        double Sxy{0};
+        double Sse{0}; // unscaled
+
+        auto Add(Operon::Scalar const* x, Operon::Scalar const* y, int64_t n) -> void;
+
+        // sum of squared errors after the optimal scaling (a constant prediction is only shifted)
+        [[nodiscard]] auto ScaledSse() const -> double;
+    };
+} // namespace detail
+
 template <typename DTable>
 class OPERON_EXPORT Evaluator : public EvaluatorBase {
     using TInterpreter = Operon::Interpreter<Operon::Scalar, DTable>;
 
+    // per-worker memory, reused across calls
+    struct Workspace {
+        Operon::Tape<Operon::Scalar, DTable> Tape;
+        std::optional<Operon::MultiInterpreter<Operon::Scalar, DTable>> Group; // created on first use
+        Operon::Vector<Operon::Scalar> Sample; // predictions on the row sample (when the caller's buffer is smaller)
+    };
+
 public:
     explicit Evaluator(Problem& problem, DTable const& dtable, ErrorMetric error = MSE{}, bool linearScaling = true)
         : EvaluatorBase(problem)
@@ -168,15 +279,155 @@ public:
     {
     }
 
-    auto GetDispatchTable() const { return dtable_.get(); }
+    auto GetDispatchTable() const -> DTable const& { return dtable_.get(); }
+    auto GetErrorMetric() const -> ErrorMetric const& { return error_; }
+    auto LinearScaling() const -> bool { return scaling_; }
+
+    auto SetWorkers(std::size_t count, std::function<int()> const& workerId) const -> void override
+    {
+        workspaces_.Configure(count, workerId);
+    }
+
+    // true if the fitness is the error metric of the model response, as computed by this class. the group
+    // evaluation and the early abandon mode compute it without calling operator(), evaluators deriving
+    // a different fitness (e.g. the information criteria) return false
+    virtual auto SupportsGroupEvaluation() const -> bool { return true; }
+
+    // reuse the outputs of subtrees evaluated before (e.g. the parts of an offspring inherited from its
+    // parents). the cache is not owned by the evaluator and must be used with a single dataset
+    auto SetSubtreeCache(SubtreeCache<Operon::Scalar>* cache) const -> void override { cache_ = cache; }
+    auto GetSubtreeCache() const -> SubtreeCache<Operon::Scalar>* { return cache_; }
+
+    // early abandon mode: the squared error (SSE, MSE, RMSE, NMSE) is accumulated block by block when a
+    // threshold is given and the evaluation stops as soon as the partial error exceeds it. the partial
+    // error is a lower bound of the final one (also with linear scaling, using the best scaling of the
+    // rows evaluated so far), so only individuals that would be rejected anyway are abandoned. the budget
+    // counts the rows actually evaluated: the abandoned rows add up to whole evaluations
+    auto SetEarlyAbandon(bool value) { earlyAbandon_ = value; }
+    auto EarlyAbandon() const -> bool { return earlyAbandon_; }
+    auto AbandonedCount() const -> std::size_t { return abandoned_.load(); }
+
+    // fused mode: the fitness is computed from the moments of the (prediction, target) pairs accumulated
+    // block by block during the evaluation, so the predictions are never stored (buf is not written).
+    // the linear scaling and all the error metrics except the MAE are derived from the moments. off by
+    // default, since the callers may read the predictions from buf. the group evaluation stores the
+    // predictions but derives the fitness from the moments of the same row blocks, so all the paths give
+    // the same fitness for the same predictions
+    auto SetFusedFitness(bool value) { fusedFitness_ = value; }
+    auto FusedFitness() const -> bool { return fusedFitness_; }
+
+    // progressive mode: the individuals are scored on a sample of the training rows (a random window in
+    // each of `strata` equal segments of the training range), drawn again by every call to Prepare (once
+    // per generation), and their fitness is marked as approximate until they are promoted. the budget
+    // counts the rows actually evaluated: the sampled rows add up to whole evaluations
+    auto SetSubsample(double fraction, std::size_t strata = DefaultStrata, uint64_t seed = 0)
+    {
+        EXPECT(fraction > 0 && fraction <= 1);
+        EXPECT(strata > 0);
+        sampleFraction_ = fraction;
+        sampleStrata_ = strata;
+        sampleRng_ = Operon::RandomGenerator{seed};
+        sample_.clear();
+        sampleTarget_.clear();
+    }
+    auto SubsampleFraction() const -> double { return sampleFraction_; }
+    // the row windows of the current sample (empty before the first Prepare or without subsampling)
+    auto Sample() const -> Operon::Span<Operon::Range const> { return { sample_.data(), sample_.size() }; }
+
+    static constexpr std::size_t DefaultStrata{ 16 };
+
+    // draws a new row sample when subsampling
+    auto Prepare(Operon::Span<Individual const> pop) const -> void override;
 
     auto
     operator()(Operon::RandomGenerator& /*random*/, Individual& ind, Operon::Span<Operon::Scalar> buf) const -> typename EvaluatorBase::ReturnType override;
 
+    // the group is evaluated with a MultiInterpreter (trees interleaved over row blocks)
+    auto Evaluate(Operon::Span<Operon::RandomGenerator> rngs, Operon::Span<Individual> individuals, Operon::Span<Operon::Scalar> buf) const -> void override;
+
+    auto EvaluateWithThreshold(Operon::RandomGenerator& rng, Individual& ind, Operon::Span<Operon::Scalar> buf, Operon::Scalar threshold) const -> typename EvaluatorBase::ReturnType override;
+
+protected:
+    // the workspace of the calling worker (nullptr if no workers are configured)
+    auto LocalWorkspace() const -> Workspace* { return workspaces_.Local(); }
+    auto LocalTape() const -> Operon::Tape<Operon::Scalar, DTable>* {
+        auto* ws = LocalWorkspace();
+        return ws != nullptr ? &ws->Tape : nullptr;
+    }
+
+    // the rows of the partial evaluations (abandoned or sampled) add up to whole residual evaluations
+    auto CountRows(std::size_t rows) const -> void
+    {
+        auto const n { GetProblem().TrainingRange().Size() };
+        auto const before { partialRows_.fetch_add(rows) };
+        ResidualEvaluations += (before + rows) / n - before / n;
+    }
+
+    auto Sampling() const -> bool { return !sample_.empty() && !FullEvaluationRequested(); }
+
 private:
     std::reference_wrapper<DTable const> dtable_;
     ErrorMetric error_;
     bool scaling_{false};
+    mutable Operon::WorkerPool<Workspace> workspaces_;
+    mutable SubtreeCache<Operon::Scalar>* cache_{nullptr};
+    bool earlyAbandon_{false};
+    bool fusedFitness_{false};
+    mutable std::atomic_ulong abandoned_{0};
+    mutable std::atomic_ulong partialRows_{0};
+
+    double sampleFraction_{1};
+    std::size_t sampleStrata_{DefaultStrata};
+    mutable Operon::RandomGenerator sampleRng_{0};
+    mutable std::vector<Operon::Range> sample_;
+    mutable std::vector<Operon::Scalar> sampleTarget_; // target values of the sampled rows
+};
+
+// evaluates the groups of individuals with a DagInterpreter: identical subtrees within a group are
+// only evaluated once. when the fitness is computed from the moments (see SetFusedFitness) all the
+// individuals passed to Evaluate form a single graph and the predictions are never stored, so the
+// algorithms pass them a whole share of the population per worker (see SharesSubtrees). otherwise they
+// are evaluated in groups that fit into the buffer. single individuals are evaluated like by the Evaluator
+template <typename DTable>
+class OPERON_EXPORT DagEvaluator final : public Evaluator<DTable> {
+    using Base = Evaluator<DTable>;
+    using TInterpreter = Operon::DagInterpreter<Operon::Scalar, DTable>;
+
+    // per-worker memory, reused across calls
+    struct Workspace {
+        std::optional<TInterpreter> Interpreter; // created on first use
+        std::vector<detail::FitnessMoments> Moments; // one per individual of the group (fused mode)
+    };
+
+public:
+    explicit DagEvaluator(Problem& problem, DTable const& dtable, ErrorMetric error = MSE{}, bool linearScaling = true)
+        : Base(problem, dtable, error, linearScaling)
+    {
+    }
+
+    auto Evaluate(Operon::Span<Operon::RandomGenerator> rngs, Operon::Span<Individual> individuals, Operon::Span<Operon::Scalar> buf) const -> void override;
+
+    [[nodiscard]] auto SharesSubtrees() const -> bool override { return true; }
+
+    auto SetWorkers(std::size_t count, std::function<int()> const& workerId) const -> void override
+    {
+        Base::SetWorkers(count, workerId);
+        workspaces_.Configure(count, workerId);
+    }
+
+    // total number of evaluated tree nodes and number of nodes actually computed after merging
+    auto TotalNodes() const -> std::size_t { return totalNodes_.load(); }
+    auto UniqueNodes() const -> std::size_t { return uniqueNodes_.load(); }
+    auto DedupRatio() const -> double
+    {
+        auto const total { TotalNodes() };
+        return total == 0 ? 0.0 : 1.0 - static_cast<double>(UniqueNodes()) / static_cast<double>(total);
+    }
+
+private:
+    mutable std::atomic_ulong totalNodes_ { 0 };
+    mutable std::atomic_ulong uniqueNodes_ { 0 };
+    mutable Operon::WorkerPool<Workspace> workspaces_;
 };
 
 class MultiEvaluator : public EvaluatorBase {
@@ -198,6 +449,20 @@ public:
         }
     }
 
+    auto SetWorkers(std::size_t count, std::function<int()> const& workerId) const -> void override
+    {
+        for (auto const& e : evaluators_) {
+            e.get().SetWorkers(count, workerId);
+        }
+    }
+
+    auto SetSubtreeCache(SubtreeCache<Operon::Scalar>* cache) const -> void override
+    {
+        for (auto const& e : evaluators_) {
+            e.get().SetSubtreeCache(cache);
+        }
+    }
+
     auto ObjectiveCount() const -> std::size_t override
     {
         return std::transform_reduce(evaluators_.begin(), evaluators_.end(), 0UL, std::plus {}, [](auto const& eval) { return eval.get().ObjectiveCount(); });
@@ -209,6 +474,8 @@ public:
         EvaluatorBase::ReturnType fit;
         fit.reserve(ind.Size());
 
+        // set again by the evaluators using a row sample
+        ind.Approximate = false;
         for (auto const& ev : evaluators_) {
             auto f = ev(rng, ind, buf);
             std::copy(f.begin(), f.end(), std::back_inserter(fit));
@@ -263,6 +530,11 @@ public:
     {
     }
 
+    auto SetWorkers(std::size_t count, std::function<int()> const& workerId) const -> void override
+    {
+        evaluator_.get().SetWorkers(count, workerId);
+    }
+
     auto SetAggregateType(AggregateType type) { aggtype_ = type; }
     auto GetAggregateType() const { return aggtype_; }
 
@@ -329,6 +601,8 @@ public:
     auto Sigma() const { return std::span<Operon::Scalar const>{sigma_}; }
     auto SetSigma(std::vector<Operon::Scalar> sigma) const { sigma_ = std::move(sigma); }
 
+    auto SupportsGroupEvaluation() const -> bool override { return false; }
+
     auto operator()(Operon::RandomGenerator& /*random*/, Individual& ind, Operon::Span<Operon::Scalar> buf) const -> typename EvaluatorBase::ReturnType override {
         ++Base::CallCount;
 
@@ -432,6 +706,8 @@ public:
     {
     }
 
+    auto SupportsGroupEvaluation() const -> bool override { return false; }
+
     auto
     operator()(Operon::RandomGenerator& /*random*/, Individual& ind, Operon::Span<Operon::Scalar> buf) const -> typename EvaluatorBase::ReturnType override;
 };
@@ -446,6 +722,8 @@ public:
     {
     }
 
+    auto SupportsGroupEvaluation() const -> bool override { return false; }
+
     auto
     operator()(Operon::RandomGenerator& /*random*/, Individual& ind, Operon::Span<Operon::Scalar> buf) const -> typename EvaluatorBase::ReturnType override;
 };
@@ -461,6 +739,8 @@ class OPERON_EXPORT LikelihoodEvaluator final : public Evaluator<DTable> {
     {
     }
 
+    auto SupportsGroupEvaluation() const -> bool override { return false; }
+
     auto
     operator()(Operon::RandomGenerator&  /*rng*/, Individual& ind, Operon::Span<Operon::Scalar> buf) const -> typename EvaluatorBase::ReturnType override {
         ++Base::CallCount;
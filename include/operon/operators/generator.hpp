@@ -4,7 +4,10 @@
 #ifndef OPERON_GENERATOR_HPP
 #define OPERON_GENERATOR_HPP
 
+#include <atomic>
+
 #include "operon/core/operator.hpp"
+#include "operon/interpreter/interval.hpp"
 #include "operon/operators/crossover.hpp"
 #include "operon/operators/evaluator.hpp"
 #include "operon/operators/mutation.hpp"
@@ -40,6 +43,17 @@ public:
     [[nodiscard]] auto Evaluator() const -> EvaluatorBase& { return evaluator_.get(); }
     [[nodiscard]] auto Optimizer() const -> CoefficientOptimizer const* { return coeffOptimizer_; }
 
+    // offspring that fail the interval check (see IntervalInterpreter::IsValid) are rejected before any
+    // row-wise evaluation (they receive the worst fitness), nullptr disables the check
+    auto SetIntervalCheck(IntervalInterpreter const* interval) -> void { interval_ = interval; }
+    [[nodiscard]] auto IntervalCheck() const -> IntervalInterpreter const* { return interval_; }
+    [[nodiscard]] auto IntervalRejections() const -> std::size_t { return rejected_.load(); }
+
+    // the local search of the generated children is a first pass, the algorithms run the second pass on
+    // the children selected by the scheduler (nullptr: a single pass)
+    auto SetScheduler(LocalSearchScheduler const* scheduler) -> void { scheduler_ = scheduler; }
+    [[nodiscard]] auto Scheduler() const -> LocalSearchScheduler const* { return scheduler_; }
+
     virtual auto Prepare(Operon::Span<Individual const> pop) const -> void
     {
         this->FemaleSelector().Prepare(pop);
@@ -47,8 +61,21 @@ public:
         this->Evaluator().Prepare(pop);
     }
 
+    // per-worker memory for the evaluator and the coefficient optimizer (see EvaluatorBase::SetWorkers)
+    auto SetWorkers(std::size_t count, std::function<int()> const& workerId) const -> void
+    {
+        this->Evaluator().SetWorkers(count, workerId);
+        if (coeffOptimizer_ != nullptr) { coeffOptimizer_->SetWorkers(count, workerId); }
+    }
+
     [[nodiscard]] virtual auto Terminate() const -> bool { return evaluator_.get().BudgetExhausted(); }
 
+    // offspring whose fitness is worse than this value are rejected (see EvaluatorBase::EvaluateWithThreshold)
+    [[nodiscard]] virtual auto RejectionThreshold(RecombinationResult const& /*res*/) const -> Operon::Scalar
+    {
+        return std::numeric_limits<Operon::Scalar>::max();
+    }
+
     auto Generate(Operon::RandomGenerator& random, double pCrossover, double pMutation, double pLocal, Operon::Span<Operon::Scalar> buf, RecombinationResult& res) const -> void {
         auto pop = FemaleSelector().Population();
         if (!res.Parent1) {
@@ -73,13 +100,26 @@ public:
             }
         }
 
+        // a rejection counts as one evaluation, otherwise a generator that keeps producing invalid children never exhausts the budget
+        if (interval_ != nullptr && !interval_->IsValid(res.Child->Genotype)) {
+            res.Child->Fitness.assign(Evaluator().ObjectiveCount(), EvaluatorBase::ErrMax);
+            ++Evaluator().ResidualEvaluations;
+            ++rejected_;
+            return;
+        }
+
         if (BernoulliTrial{pLocal}(random)) {
-            auto summary = (*coeffOptimizer_)(random, res.Child->Genotype);
+            auto summary = scheduler_ != nullptr
+                ? (*coeffOptimizer_)(random, res.Child->Genotype, scheduler_->FirstPass())
+                : (*coeffOptimizer_)(random, res.Child->Genotype);
             Evaluator().ResidualEvaluations += summary.FunctionEvaluations;
             Evaluator().JacobianEvaluations += summary.JacobianEvaluations;
+            Evaluator().CoefficientCacheHits += static_cast<unsigned long>(summary.WarmStart || summary.Skipped);
+            Evaluator().CoefficientCacheSkips += static_cast<unsigned long>(summary.Skipped);
+            res.Child->LocalSearchRate = LocalSearchScheduler::Rate(summary);
         }
 
-        res.Child->Fitness = Evaluator()(random, res.Child.value(), buf);
+        res.Child->Fitness = Evaluator().EvaluateWithThreshold(random, res.Child.value(), buf, RejectionThreshold(res));
         for (auto& v : res.Child->Fitness) {
             if (!std::isfinite(v)) { v = std::numeric_limits<Operon::Scalar>::max(); }
         }
@@ -98,6 +138,9 @@ private:
     std::reference_wrapper<SelectorBase>  femaleSelector_;
     std::reference_wrapper<SelectorBase>  maleSelector_;
     CoefficientOptimizer const*           coeffOptimizer_;
+    IntervalInterpreter const*            interval_{nullptr};
+    LocalSearchScheduler const*           scheduler_{nullptr};
+    mutable std::atomic_size_t            rejected_{0};
 };
 
 class OPERON_EXPORT BasicOffspringGenerator final : public OffspringGeneratorBase {
@@ -157,6 +200,9 @@ public:
 
     auto operator()(Operon::RandomGenerator& random, double pCrossover, double pMutation, double pLocal, Operon::Span<Operon::Scalar> buf) const -> std::optional<Individual> final;
 
+    // the comparison value of the parents (single objective only)
+    [[nodiscard]] auto RejectionThreshold(RecombinationResult const& res) const -> Operon::Scalar override;
+
     void MaxSelectionPressure(size_t value) { maxSelectionPressure_ = value; }
     auto MaxSelectionPressure() const -> size_t { return maxSelectionPressure_; }
 
@@ -4,6 +4,11 @@
 #ifndef OPERON_LOCAL_SEARCH_HPP
 #define OPERON_LOCAL_SEARCH_HPP
 
+#include <atomic>
+#include <functional>
+#include <stdexcept>
+#include <vector>
+
 #include "operon/core/operator.hpp"
 #include "operon/operon_export.hpp"
 
@@ -13,6 +18,9 @@ namespace Operon {
 // forward declarations
 class Tree;
 class OptimizerBase;
+class CoefficientCache;
+struct EvaluatorBase;
+struct Individual;
 struct OptimizerSummary;
 
 class OPERON_EXPORT CoefficientOptimizer : public OperatorBase<OptimizerSummary, Operon::Tree&> {
@@ -24,11 +32,103 @@ public:
 
     // convenience
     auto operator()(Operon::RandomGenerator& rng, Operon::Tree& tree) const -> OptimizerSummary override;
+    // with the given number of iterations instead of the ones of the optimizer
+    auto operator()(Operon::RandomGenerator& rng, Operon::Tree& tree, std::size_t iterations) const -> OptimizerSummary;
+
+    [[nodiscard]] auto GetOptimizer() const -> OptimizerBase const& { return optimizer_.get(); }
+
+    // forwarded to the optimizer (see OptimizerBase::SetWorkers)
+    auto SetWorkers(std::size_t count, std::function<int()> const& workerId) const -> void;
+
+    // the optimizations start from the best coefficients found so far for the same structure, and are
+    // skipped for the structures that have converged (nullptr disables it)
+    auto SetCache(CoefficientCache* cache) -> void { cache_ = cache; }
+    [[nodiscard]] auto GetCache() const -> CoefficientCache* { return cache_; }
 
 private:
+    auto Optimize(Operon::RandomGenerator& rng, Operon::Tree const& tree, std::size_t iterations) const -> OptimizerSummary;
 
     std::reference_wrapper<Operon::OptimizerBase const> optimizer_;
     double lamarckianProbability_{1.0};
+    CoefficientCache* cache_{nullptr};
+};
+
+// which children of a generation get the second local search pass
+enum class LocalSearchPolicy : int {
+    Uniform,        // all of them
+    Best,           // the best fraction of them (according to the first objective)
+    Improving,      // the ones whose cost was still dropping quickly at the end of the first pass
+    BestOrImproving
+};
+
+// allocates the local search budget at the population level. the offspring generator runs a cheap first
+// pass on every child (possibly of zero iterations), although most of them are discarded by the reinserter.
+// once the generation is complete, the scheduler ranks the children which got the first pass and only the
+// selected ones are optimized again and re-evaluated. the iterations of the passes are given to each call,
+// the settings of the (shared) optimizer are left untouched.
+class OPERON_EXPORT LocalSearchScheduler {
+public:
+    // statistics of the second pass in the last generation
+    struct Stats {
+        std::size_t Candidates{}; // children with a finite fitness
+        std::size_t Refined{};    // children selected for the second pass
+        double Time{};            // seconds (summed over the workers)
+        double Gain{};            // decrease of the first objective (summed over the children)
+    };
+
+    static constexpr double DefaultFraction{0.1};
+    static constexpr double DefaultThreshold{0.01};
+
+    // the improving policies rank the children by the rate of their first pass, which must not be empty
+    LocalSearchScheduler(CoefficientOptimizer const& optimizer, EvaluatorBase& evaluator, LocalSearchPolicy policy, std::size_t firstPass, std::size_t secondPass)
+        : optimizer_(optimizer)
+        , evaluator_(evaluator)
+        , policy_(policy)
+        , firstPass_(firstPass)
+        , secondPass_(secondPass)
+    {
+        if (firstPass == 0 && (policy == LocalSearchPolicy::Improving || policy == LocalSearchPolicy::BestOrImproving)) {
+            throw std::invalid_argument("local search scheduler: the improving policies need a first pass of at least one iteration");
+        }
+    }
+
+    // true for the children which get the second pass, resets the statistics
+    [[nodiscard]] auto Select(Operon::Span<Individual const> offspring) const -> std::vector<bool>;
+
+    // second pass on a selected child (thread-safe)
+    auto Refine(Operon::RandomGenerator& rng, Individual& child, Operon::Span<Operon::Scalar> buf) const -> void;
+
+    [[nodiscard]] auto GetStats() const -> Stats { return { candidates_, refined_, time_.load(), gain_.load() }; }
+
+    // relative decrease of the cost per iteration, stored in the children by the generator (the children
+    // without local search keep a NaN rate)
+    static auto Rate(OptimizerSummary const& summary) -> Operon::Scalar;
+
+    [[nodiscard]] auto Policy() const -> LocalSearchPolicy { return policy_; }
+    [[nodiscard]] auto FirstPass() const -> std::size_t { return firstPass_; }
+    [[nodiscard]] auto SecondPass() const -> std::size_t { return secondPass_; }
+
+    // fraction of the children selected by the Best policy
+    auto SetFraction(double fraction) -> void { fraction_ = fraction; }
+    [[nodiscard]] auto Fraction() const -> double { return fraction_; }
+
+    // minimum rate of the children selected by the Improving policy
+    auto SetThreshold(Operon::Scalar threshold) -> void { threshold_ = threshold; }
+    [[nodiscard]] auto Threshold() const -> Operon::Scalar { return threshold_; }
+
+private:
+    std::reference_wrapper<CoefficientOptimizer const> optimizer_;
+    std::reference_wrapper<EvaluatorBase> evaluator_;
+    LocalSearchPolicy policy_;
+    std::size_t firstPass_;
+    std::size_t secondPass_;
+    double fraction_{DefaultFraction};
+    Operon::Scalar threshold_{DefaultThreshold};
+
+    mutable std::size_t candidates_{0};
+    mutable std::size_t refined_{0};
+    mutable std::atomic<double> time_{0};
+    mutable std::atomic<double> gain_{0};
 };
 
 } // namespace Operon
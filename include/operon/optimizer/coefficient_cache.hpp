@@ -0,0 +1,164 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2024 Heal Research
+
+#ifndef OPERON_OPTIMIZER_COEFFICIENT_CACHE_HPP
+#define OPERON_OPTIMIZER_COEFFICIENT_CACHE_HPP
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+#include "operon/core/tree.hpp"
+#include "operon/core/types.hpp"
+#include "operon/hash/hash.hpp"
+
+namespace Operon {
+
+// best coefficients found so far for each tree structure, shared by the local search of all the workers.
+// crossover and mutation keep producing structures that were already optimized, their coefficients are
+// then used as the starting point of the optimizer, or the optimization is skipped altogether once two
+// solves agree on the cost (the structure has converged). the entries are keyed by the relaxed tree hash,
+// which sorts the arguments of commutative functions and ignores the node values, together with the exact
+// layout of the tree: the order of its nodes and of its coefficients, and the values of the nodes that are
+// not optimized (the fixed constants and weights take part in the evaluation, so they change the solution).
+// the costs are only comparable for a single problem and optimizer, a cache must not be shared between them.
+class CoefficientCache {
+public:
+    struct Key {
+        Operon::Hash Structure; // relaxed hash
+        Operon::Hash Layout;    // order of the nodes and of the coefficients, fixed values
+    };
+
+    struct Entry {
+        std::vector<Operon::Scalar> Coefficients;
+        Operon::Scalar Cost{};
+        bool Converged{};
+    };
+
+    static constexpr std::size_t DefaultCapacity{ 1UL << 16U }; // entries
+    static constexpr Operon::Scalar DefaultTolerance{ 1e-6 };   // relative cost difference
+    static constexpr std::size_t ShardCount{ 16 };
+
+    explicit CoefficientCache(std::size_t capacity = DefaultCapacity, Operon::Scalar tolerance = DefaultTolerance)
+        : capacity_(capacity)
+        , tolerance_(tolerance)
+    {
+    }
+
+    // computes the relaxed hash of the tree (overwriting the calculated hash values of its nodes)
+    static auto MakeKey(Operon::Tree const& tree) -> Key
+    {
+        auto const structure { tree.Hash(Operon::HashMode::Relaxed).HashValue() };
+        std::vector<Operon::Hash> layout;
+        layout.reserve(2 * tree.Length());
+        for (auto const& n : tree.Nodes()) {
+            layout.push_back((n.HashValue << 1U) | static_cast<Operon::Hash>(n.Optimize));
+            if (!n.Optimize) { layout.push_back(Bits(n.Value)); }
+        }
+        return { structure, Operon::Hasher{}(std::bit_cast<uint8_t const*>(layout.data()), sizeof(Operon::Hash) * layout.size()) };
+    }
+
+    auto Find(Key key) -> std::optional<Entry>
+    {
+        auto& shard = GetShard(key);
+        std::scoped_lock lock(shard.Mutex);
+        if (auto it = shard.Index.find(key.Structure); it != shard.Index.end() && it->second->Layout == key.Layout) {
+            shard.Entries.splice(shard.Entries.begin(), shard.Entries, it->second);
+            ++hits_;
+            if (it->second->Value.Converged) { ++skips_; }
+            return it->second->Value;
+        }
+        ++misses_;
+        return std::nullopt;
+    }
+
+    // records the outcome of a solve: the entry keeps the lowest cost, and becomes converged when another
+    // solve ends within the tolerance of it (it would not move the coefficients anymore)
+    auto Update(Key key, Operon::Span<Operon::Scalar const> coefficients, Operon::Scalar cost) -> void
+    {
+        if (!std::isfinite(cost)) { return; }
+
+        auto& shard = GetShard(key);
+        std::scoped_lock lock(shard.Mutex);
+        if (auto it = shard.Index.find(key.Structure); it != shard.Index.end()) {
+            auto& e = it->second->Value;
+            if (it->second->Layout == key.Layout) {
+                auto const close { std::abs(e.Cost - cost) <= tolerance_ * std::abs(e.Cost) };
+                if (cost < e.Cost) { e.Coefficients.assign(coefficients.begin(), coefficients.end()); e.Cost = cost; }
+                e.Converged = e.Converged || close;
+                shard.Entries.splice(shard.Entries.begin(), shard.Entries, it->second);
+                return;
+            }
+            // same structure with the coefficients in a different order, the newest layout wins
+            shard.Entries.erase(it->second);
+            shard.Index.erase(it);
+        }
+        while (!shard.Entries.empty() && shard.Entries.size() >= capacity_ / ShardCount) {
+            shard.Index.erase(shard.Entries.back().Structure);
+            shard.Entries.pop_back();
+        }
+        shard.Entries.push_front(Item{ key.Structure, key.Layout, Entry{ { coefficients.begin(), coefficients.end() }, cost, false } });
+        shard.Index[key.Structure] = shard.Entries.begin();
+    }
+
+    auto Clear() -> void
+    {
+        for (auto& shard : shards_) {
+            std::scoped_lock lock(shard.Mutex);
+            shard.Entries.clear();
+            shard.Index.clear();
+        }
+        hits_ = 0;
+        skips_ = 0;
+        misses_ = 0;
+    }
+
+    [[nodiscard]] auto Capacity() const -> std::size_t { return capacity_; }
+    [[nodiscard]] auto Tolerance() const -> Operon::Scalar { return tolerance_; }
+
+    // hits include the skipped optimizations
+    [[nodiscard]] auto Hits() const -> std::size_t { return hits_.load(); }
+    [[nodiscard]] auto Skips() const -> std::size_t { return skips_.load(); }
+    [[nodiscard]] auto Misses() const -> std::size_t { return misses_.load(); }
+
+private:
+    static auto Bits(Operon::Scalar value) -> Operon::Hash
+    {
+        Operon::Hash bits{0};
+        std::memcpy(&bits, &value, sizeof(value));
+        return bits;
+    }
+
+    struct Item {
+        Operon::Hash Structure;
+        Operon::Hash Layout;
+        Entry Value;
+    };
+
+    struct Shard {
+        std::mutex Mutex;
+        std::list<Item> Entries; // most recently used first
+        Operon::Map<Operon::Hash, typename std::list<Item>::iterator> Index;
+    };
+
+    auto GetShard(Key key) -> Shard& { return shards_[key.Structure % ShardCount]; }
+
+    std::size_t capacity_;
+    Operon::Scalar tolerance_;
+    std::array<Shard, ShardCount> shards_;
+
+    std::atomic_size_t hits_{0};
+    std::atomic_size_t skips_{0};
+    std::atomic_size_t misses_{0};
+};
+
+} // namespace Operon
+
+#endif
@@ -41,7 +41,6 @@ struct GaussianLikelihood : public LikelihoodBase<T> {
         , bs_{batchSize == 0 ? range.Size() : batchSize}
         , np_{static_cast<std::size_t>(interpreter.GetTree().CoefficientsCount())}
         , nr_{range_.Size()}
-        , jac_{bs_, np_}
     { }
 
     using Scalar   = typename LikelihoodBase<T>::Scalar;
@@ -57,19 +56,27 @@ struct GaussianLikelihood : public LikelihoodBase<T> {
         auto const& interpreter = this->GetInterpreter();
         Operon::Span<Operon::Scalar const> c{x.data(), static_cast<std::size_t>(x.size())};
         auto range = SelectRandomRange();
-        auto primal = interpreter.Evaluate(c, range);
         auto target = target_.segment(range.Start(), range.Size());
-        Eigen::Map<Eigen::Array<Scalar, -1, 1> const> primalMap{primal.data(), std::ssize(primal)};
-        auto e = primalMap - target;
 
         if (grad.size() != 0) {
+            // the residuals seed the reverse pass, so the gradient is accumulated without the jacobian
             assert(grad.size() == x.size());
             ++jeval_;
-            interpreter.JacRev(c, range, {jac_.data(), np_ * bs_});
-            grad = (e.matrix().asDiagonal() * jac_.matrix()).colwise().sum();
+            Scalar ssr{0};
+            interpreter.Vjp(c, range, [&](int64_t row, Span<Scalar const> primal, Span<Scalar> adjoint) {
+                for (auto i = 0UL; i < primal.size(); ++i) {
+                    auto const e { primal[i] - target(row + static_cast<int64_t>(i)) };
+                    adjoint[i] = e;
+                    ssr += e * e;
+                }
+            }, { grad.data(), static_cast<std::size_t>(grad.size()) });
+            return ssr * Operon::Scalar{0.5};
         }
 
-        return static_cast<Operon::Scalar>(e.square().sum()) * Operon::Scalar{0.5};
+        std::vector<Scalar> primal(range.Size());
+        interpreter.Evaluate(c, range, primal);
+        Eigen::Map<Eigen::Array<Scalar, -1, 1> const> primalMap{primal.data(), std::ssize(primal)};
+        return static_cast<Operon::Scalar>((primalMap - target).square().sum()) * Operon::Scalar{0.5};
     }
 
     static auto ComputeLikelihood(Span<Scalar const> x, Span<Scalar const> y, Span<Scalar const> s) noexcept -> Scalar {
@@ -135,7 +142,6 @@ private:
     std::size_t bs_; // batch size
     std::size_t np_; // number of parameters to optimize
     std::size_t nr_; // number of data points (rows)
-    mutable Eigen::Array<Scalar, -1, -1> jac_;
     mutable std::size_t feval_{};
     mutable std::size_t jeval_{};
 };
@@ -52,7 +52,6 @@ struct PoissonLikelihood : public LikelihoodBase<T> {
         , batchSize_(batchSize == 0 ? range.Size() : batchSize)
         , numParameters_{static_cast<std::size_t>(interpreter.GetTree().CoefficientsCount())}
         , numResiduals_{range_.Size()}
-        , jac_{batchSize_, numParameters_}
     { }
 
     using Scalar   = typename LikelihoodBase<T>::Scalar;
@@ -69,24 +68,34 @@ struct PoissonLikelihood : public LikelihoodBase<T> {
         auto const& interpreter = this->GetInterpreter();
         Operon::Span<Operon::Scalar const> c{x.data(), static_cast<std::size_t>(x.size())};
         auto r = SelectRandomRange();
-        auto p = interpreter.Evaluate(c, r);
         auto t = target_.subspan(r.Start(), r.Size());
+
+        if (g.size() != 0) {
+            // the loss derivative seeds the reverse pass, so the gradient is accumulated without the jacobian
+            ++jeval_;
+            Scalar loss{0};
+            interpreter.Vjp(c, r, [&](int64_t row, Span<Scalar const> p, Span<Scalar> adjoint) {
+                for (auto i = 0UL; i < p.size(); ++i) {
+                    auto const ti { t[row + i] };
+                    if constexpr (LogInput) {
+                        adjoint[i] = std::exp(p[i]) - ti;
+                        loss += std::exp(p[i]) - ti * p[i];
+                    } else {
+                        adjoint[i] = 1 - ti / p[i];
+                        loss += p[i] - ti * std::log(p[i]);
+                    }
+                }
+            }, { g.data(), static_cast<std::size_t>(g.size()) });
+            return loss;
+        }
+
+        std::vector<Scalar> p(r.Size());
+        interpreter.Evaluate(c, r, p);
         auto pmap = Eigen::Map<Eigen::Array<Operon::Scalar, -1, 1> const>(p.data(), std::ssize(p));
         auto tmap = Eigen::Map<Eigen::Array<Operon::Scalar, -1, 1> const>(t.data(), std::ssize(t));
-
-        // compute jacobian
         if constexpr (LogInput) {
-            if (g.size() != 0) {
-                interpreter.JacRev(c, r, { jac_.data(), numParameters_ * batchSize_ });
-                g = ((pmap.exp() - tmap).matrix().asDiagonal() * jac_.matrix()).colwise().sum();
-            }
             return (pmap.exp() - tmap * pmap).sum();
         } else {
-            auto tmap = Eigen::Map<Eigen::Array<Operon::Scalar, -1, 1> const>(t.data(), std::ssize(t));
-            if (g.size() != 0) {
-                interpreter.JacRev(c, r, { jac_.data(), numParameters_ * batchSize_ });
-                g = ((1 - tmap * pmap.inverse()).matrix().asDiagonal() * jac_.matrix()).colwise().sum();
-            }
             return (pmap - tmap * pmap.log()).sum();
         }
     }
@@ -146,7 +155,6 @@ private:
     std::size_t batchSize_; // batch size
     std::size_t numParameters_; // number of parameters to optimize
     std::size_t numResiduals_; // number of data points (rows)
-    mutable Eigen::Array<Scalar, -1, -1> jac_;
     mutable std::size_t feval_{};
     mutable std::size_t jeval_{};
 };
@@ -38,14 +38,19 @@ struct LMCostFunction {
         EXPECT(parameters != nullptr);
         Operon::Span<Operon::Scalar const> params{ parameters, numParameters_ };
 
-        if (jacobian != nullptr) {
-            Operon::Span<Operon::Scalar> jac{jacobian, static_cast<size_t>(numResiduals_ * numParameters_)};
-            interpreter_.get().JacRev(params, range_, jac);
+        Operon::Span<Operon::Scalar> jac{ jacobian, jacobian == nullptr ? 0UL : static_cast<size_t>(numResiduals_ * numParameters_) };
+        Operon::Span<Operon::Scalar> res{ residuals, residuals == nullptr ? 0UL : static_cast<size_t>(numResiduals_) };
+
+        // the residuals and the jacobian come from the same forward pass
+        if (jacobian != nullptr && residuals != nullptr) {
+            interpreter_.get().EvaluateJac(params, range_, res, jac);
+        } else if (jacobian != nullptr) {
+            interpreter_.get().Jac(params, range_, jac);
+        } else if (residuals != nullptr) {
+            interpreter_.get().Evaluate(params, range_, res);
         }
 
         if (residuals != nullptr) {
-            Operon::Span<Operon::Scalar> res{ residuals, static_cast<size_t>(numResiduals_) };
-            interpreter_.get().Evaluate(params, range_, res);
             Eigen::Map<Eigen::Array<Operon::Scalar, -1, 1>> x(residuals, numResiduals_);
             Eigen::Map<Eigen::Array<Operon::Scalar, -1, 1> const> y(target_.data(), numResiduals_);
             x -= y;
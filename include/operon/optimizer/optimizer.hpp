@@ -8,6 +8,7 @@
 #include "operon/error_metrics/sum_of_squared_errors.hpp"
 #include "operon/interpreter/dispatch_table.hpp"
 #include <functional>
+#include <utility>
 #if defined(HAVE_CERES)
 #include <ceres/tiny_solver.h>
 #else
@@ -27,7 +28,7 @@
 
 namespace Operon {
 
-enum class OptimizerType : int { Tiny, Eigen, Ceres };
+enum class OptimizerType : int { Tiny, Eigen, Ceres, Streaming };
 
 struct OptimizerSummary {
     std::vector<Operon::Scalar> InitialParameters;
@@ -38,6 +39,8 @@ struct OptimizerSummary {
     int FunctionEvaluations{};
     int JacobianEvaluations{};
     bool Success{};
+    bool WarmStart{}; // started from the cached coefficients (see CoefficientCache)
+    bool Skipped{};   // the cached coefficients have converged, no optimization was done
 };
 
 class OptimizerBase {
@@ -45,6 +48,7 @@ std::reference_wrapper<Problem const> problem_;
 // batch size for loss functions (default = 0 -> use entire data range)
 mutable std::size_t batchSize_{0};
 mutable std::size_t iterations_{100}; // NOLINT
+mutable std::size_t freezeBudget_{0}; // freezing is opt-in (see SetFreezeBudget)
 
 public:
     explicit OptimizerBase(Problem const& problem)
@@ -66,7 +70,19 @@ public:
     auto SetBatchSize(std::size_t batchSize) const { batchSize_ = batchSize; }
     auto SetIterations(std::size_t iterations) const { iterations_ = iterations; }
 
+    // the levenberg-marquardt optimizers freeze the subtrees without coefficients over the training range
+    // (see Interpreter::Freeze) if their outputs fit in the budget (bytes). zero (the default) disables it,
+    // otherwise each worker tape keeps a buffer of up to the budget across the local searches
+    [[nodiscard]] auto FreezeBudget() const -> std::size_t { return freezeBudget_; }
+    auto SetFreezeBudget(std::size_t budget) const { freezeBudget_ = budget; }
+
+    // per-worker memory (see EvaluatorBase::SetWorkers)
+    virtual auto SetWorkers(std::size_t /*count*/, std::function<int()> const& /*workerId*/) const -> void { }
+
     [[nodiscard]] virtual auto Optimize(Operon::RandomGenerator& rng, Tree const& tree) const -> OptimizerSummary = 0;
+    // the iterations given per call (e.g. by the passes of a LocalSearchScheduler). the optimizers of the
+    // library override it, by default they are ignored and Optimize(rng, tree) runs Iterations()
+    [[nodiscard]] virtual auto Optimize(Operon::RandomGenerator& rng, Tree const& tree, std::size_t /*iterations*/) const -> OptimizerSummary { return Optimize(rng, tree); }
     [[nodiscard]] virtual auto ComputeLikelihood(Operon::Span<Operon::Scalar const> x, Operon::Span<Operon::Scalar const> y, Operon::Span<Operon::Scalar const> w) const -> Operon::Scalar = 0;
     [[nodiscard]] virtual auto ComputeFisherMatrix(Operon::Span<Operon::Scalar const> pred, Operon::Span<Operon::Scalar const> jac, Operon::Span<Operon::Scalar const> sigma) const -> Eigen::Matrix<Operon::Scalar, -1, -1> = 0;
 };
@@ -76,6 +92,83 @@ namespace detail {
         constexpr auto CHECK_NAN{true};
         return Operon::Less<CHECK_NAN>{}(finalCost, initialCost);
     }
+
+    // freezes the subtrees without coefficients for the duration of a local search (nothing if the budget is
+    // zero). the frozen outputs are dropped afterwards, the worker tape keeps their buffer (at most the budget)
+    // for the next local search, so that the searches over a large range do not allocate it every time
+    template<typename TInterpreter>
+    class FreezeScope {
+    public:
+        FreezeScope(TInterpreter const& interpreter, Operon::Range range, std::size_t budget)
+            : interpreter_(interpreter)
+            , budget_(budget)
+        {
+            if (budget > 0) { interpreter.Freeze(range, budget); }
+        }
+
+        FreezeScope(FreezeScope const&) = delete;
+        FreezeScope(FreezeScope&&) = delete;
+        auto operator=(FreezeScope const&) -> FreezeScope& = delete;
+        auto operator=(FreezeScope&&) -> FreezeScope& = delete;
+
+        ~FreezeScope() { interpreter_.get().Unfreeze(budget_); }
+
+    private:
+        std::reference_wrapper<TInterpreter const> interpreter_;
+        std::size_t budget_;
+    };
+
+    // levenberg-marquardt iterations on the normal equations (J^T J, J^T r) of a least squares cost, shared by
+    // the optimizers that accumulate them in a streaming pass. the caller provides the system of the free
+    // coefficients at the current point, the cost of a trial step from it and the acceptance of the last trial
+    // step (returning the new cost). the coefficients are scaled by 1 / (1 + |J_i|) from the first system (as
+    // in the tiny solver) and the damping follows the update of nielsen. returns the final cost
+    template<typename System, typename Trial, typename Accept>
+    auto LevenbergMarquardt(double cost, std::size_t iterations, Eigen::VectorXd const& x, System&& system, Trial&& trial, Accept&& accept, OptimizerSummary& summary) -> double
+    {
+        using Vector = Eigen::VectorXd;
+        using Matrix = Eigen::MatrixXd;
+
+        constexpr double minDiagonal{1e-6};
+        constexpr double maxDiagonal{1e32};
+        constexpr double gradientTolerance{1e-10};
+        constexpr double parameterTolerance{1e-8};
+        constexpr double functionTolerance{1e-6};
+        double lambda{1e-4};
+        double nu{2};
+
+        Vector scale;
+        for (auto i = 0UL; i < iterations && std::isfinite(cost); ++i) {
+            ++summary.Iterations;
+            auto const [s, g] = system();
+            if (i == 0) { scale = (1 + s.diagonal().array().max(0.0).sqrt()).inverse().matrix(); }
+
+            Matrix m = scale.asDiagonal() * s * scale.asDiagonal();
+            Vector const gs = scale.cwiseProduct(g);
+            if (gs.template lpNorm<Eigen::Infinity>() < gradientTolerance) { break; }
+
+            m.diagonal() += lambda * m.diagonal().cwiseMax(minDiagonal).cwiseMin(maxDiagonal);
+            Vector const step = scale.cwiseProduct(m.ldlt().solve(-gs));
+            if (!step.allFinite() || step.norm() < parameterTolerance * (x.norm() + parameterTolerance)) { break; }
+
+            auto const cost1 = trial(step);
+            // the actual cost reduction relative to the one predicted by the linear model
+            auto const predicted = -step.dot(g + 0.5 * (s * step)); // NOLINT
+            auto const rho = (cost - cost1) / predicted;
+            auto const converged = std::abs(cost - cost1) < functionTolerance * cost;
+            if (std::isfinite(cost1) && rho > 0) {
+                cost = accept();
+                auto const t { 2 * rho - 1 };
+                lambda *= std::max(1.0 / 3, 1 - t * t * t);
+                nu = 2;
+            } else {
+                lambda *= nu;
+                nu *= 2;
+            }
+            if (converged) { break; }
+        }
+        return cost;
+    }
 } // namespace detail
 
 template <typename DTable, OptimizerType = OptimizerType::Tiny>
@@ -85,16 +178,19 @@ struct LevenbergMarquardtOptimizer : public OptimizerBase {
     {
     }
 
-    [[nodiscard]] auto Optimize(Operon::RandomGenerator& /*unused*/, Operon::Tree const& tree) const -> OptimizerSummary final
+    [[nodiscard]] auto Optimize(Operon::RandomGenerator& rng, Operon::Tree const& tree) const -> OptimizerSummary final { return Optimize(rng, tree, this->Iterations()); }
+
+    [[nodiscard]] auto Optimize(Operon::RandomGenerator& /*unused*/, Operon::Tree const& tree, std::size_t iterations) const -> OptimizerSummary final
     {
         auto const& dtable = this->GetDispatchTable();
         auto const& problem = this->GetProblem();
         auto const& dataset = problem.GetDataset();
         auto range  = problem.TrainingRange();
         auto target = problem.TargetValues(range);
-        auto iterations = this->Iterations();
 
-        Operon::Interpreter<Operon::Scalar, DTable> interpreter{dtable, dataset, tree};
+        Operon::Interpreter<Operon::Scalar, DTable> interpreter{dtable, dataset, tree, tapes_.Local()};
+        // the subtrees without coefficients are evaluated only once for all iterations
+        detail::FreezeScope frozen{interpreter, range, this->FreezeBudget()};
         Operon::LMCostFunction cf{interpreter, target, range};
         ceres::TinySolver<decltype(cf)> solver;
         solver.options.max_num_iterations = static_cast<int>(iterations);
@@ -119,6 +215,8 @@ struct LevenbergMarquardtOptimizer : public OptimizerBase {
 
     auto GetDispatchTable() const -> DTable const& { return dtable_.get(); }
 
+    auto SetWorkers(std::size_t count, std::function<int()> const& workerId) const -> void final { tapes_.Configure(count, workerId); }
+
     [[nodiscard]] auto ComputeLikelihood(Operon::Span<Operon::Scalar const> x, Operon::Span<Operon::Scalar const> y, Operon::Span<Operon::Scalar const> w) const -> Operon::Scalar final
     {
         return GaussianLikelihood<Operon::Scalar>::ComputeLikelihood(x, y, w);
@@ -130,6 +228,7 @@ struct LevenbergMarquardtOptimizer : public OptimizerBase {
 
     private:
     std::reference_wrapper<DTable const> dtable_;
+    mutable TapePool<Operon::Scalar, DTable> tapes_;
 };
 
 template <typename DTable>
@@ -139,16 +238,18 @@ struct LevenbergMarquardtOptimizer<DTable, OptimizerType::Eigen> final : public
     {
     }
 
-    [[nodiscard]] auto Optimize(Operon::RandomGenerator& /*unused*/, Operon::Tree const& tree) const -> OptimizerSummary final
+    [[nodiscard]] auto Optimize(Operon::RandomGenerator& rng, Operon::Tree const& tree) const -> OptimizerSummary final { return Optimize(rng, tree, this->Iterations()); }
+
+    [[nodiscard]] auto Optimize(Operon::RandomGenerator& /*unused*/, Operon::Tree const& tree, std::size_t iterations) const -> OptimizerSummary final
     {
         auto const& dtable = this->GetDispatchTable();
         auto const& problem = this->GetProblem();
         auto const& dataset = problem.GetDataset();
         auto range  = problem.TrainingRange();
         auto target = problem.TargetValues(range);
-        auto iterations = this->Iterations();
 
-        Operon::Interpreter<Operon::Scalar, DTable> interpreter{dtable, dataset, tree};
+        Operon::Interpreter<Operon::Scalar, DTable> interpreter{dtable, dataset, tree, tapes_.Local()};
+        detail::FreezeScope frozen{interpreter, range, this->FreezeBudget()};
         Operon::LMCostFunction<Operon::Scalar> cf{interpreter, target, range};
         Eigen::LevenbergMarquardt<decltype(cf)> lm(cf);
         lm.setMaxfev(static_cast<int>(iterations));
@@ -181,6 +282,8 @@ struct LevenbergMarquardtOptimizer<DTable, OptimizerType::Eigen> final : public
 
     auto GetDispatchTable() const -> DTable const& { return dtable_.get(); }
 
+    auto SetWorkers(std::size_t count, std::function<int()> const& workerId) const -> void final { tapes_.Configure(count, workerId); }
+
     [[nodiscard]] auto ComputeLikelihood(Operon::Span<Operon::Scalar const> x, Operon::Span<Operon::Scalar const> y, Operon::Span<Operon::Scalar const> w) const -> Operon::Scalar final
     {
         return GaussianLikelihood<Operon::Scalar>::ComputeLikelihood(x, y, w);
@@ -192,6 +295,7 @@ struct LevenbergMarquardtOptimizer<DTable, OptimizerType::Eigen> final : public
 
     private:
     std::reference_wrapper<DTable const> dtable_;
+    mutable TapePool<Operon::Scalar, DTable> tapes_;
 };
 
 #if defined(HAVE_CERES)
@@ -202,19 +306,21 @@ struct LevenbergMarquardtOptimizer<DTable, OptimizerType::Ceres> final : public
     {
     }
 
-    [[nodiscard]] auto Optimize(Operon::RandomGenerator& /*unused*/, Operon::Tree const& tree) const -> OptimizerSummary final
+    [[nodiscard]] auto Optimize(Operon::RandomGenerator& rng, Operon::Tree const& tree) const -> OptimizerSummary final { return Optimize(rng, tree, this->Iterations()); }
+
+    [[nodiscard]] auto Optimize(Operon::RandomGenerator& /*unused*/, Operon::Tree const& tree, std::size_t iterations) const -> OptimizerSummary final
     {
         auto const& dtable = this->GetDispatchTable();
         auto const& problem = this->GetProblem();
         auto const& dataset = problem.GetDataset();
         auto range  = problem.TrainingRange();
         auto target = problem.TargetValues(range);
-        auto iterations = this->Iterations();;
 
         auto initialParameters = tree.GetCoefficients();
         auto finalParameters   = initialParameters;
 
-        Operon::Interpreter<Operon::Scalar, DTable> interpreter{dtable, dataset, tree};
+        Operon::Interpreter<Operon::Scalar, DTable> interpreter{dtable, dataset, tree, tapes_.Local()};
+        detail::FreezeScope frozen{interpreter, range, this->FreezeBudget()};
         Operon::LMCostFunction<Operon::Scalar, Eigen::RowMajor> cf{interpreter, target, range};
         auto* dynamicCostFunction = new Operon::DynamicCostFunction{cf};
         ceres::Solver::Summary s;
@@ -249,6 +355,8 @@ struct LevenbergMarquardtOptimizer<DTable, OptimizerType::Ceres> final : public
 
     auto GetDispatchTable() const -> DTable const& { return dtable_.get(); }
 
+    auto SetWorkers(std::size_t count, std::function<int()> const& workerId) const -> void final { tapes_.Configure(count, workerId); }
+
     [[nodiscard]] auto ComputeLikelihood(Operon::Span<Operon::Scalar const> x, Operon::Span<Operon::Scalar const> y, Operon::Span<Operon::Scalar const> w) const -> Operon::Scalar final
     {
         return GaussianLikelihood<Operon::Scalar>::ComputeLikelihood(x, y, w);
@@ -260,9 +368,257 @@ struct LevenbergMarquardtOptimizer<DTable, OptimizerType::Ceres> final : public
 
     private:
     std::reference_wrapper<DTable const> dtable_;
+    mutable TapePool<Operon::Scalar, DTable> tapes_;
 };
 #endif
 
+// levenberg-marquardt on the normal equations: J^T J and J^T r are accumulated batch by batch by the
+// interpreter and the damped p x p system is solved with LDLT, so the n x p jacobian is never stored.
+// the normal equations and the solver work in double precision, whatever the scalar type
+template <typename DTable>
+struct LevenbergMarquardtOptimizer<DTable, OptimizerType::Streaming> final : public OptimizerBase {
+    explicit LevenbergMarquardtOptimizer(DTable const& dtable, Problem const& problem)
+        : OptimizerBase{problem}, dtable_{dtable}
+    {
+    }
+
+    [[nodiscard]] auto Optimize(Operon::RandomGenerator& rng, Operon::Tree const& tree) const -> OptimizerSummary final { return Optimize(rng, tree, this->Iterations()); }
+
+    // the normal equations are accumulated over chunks of rows by the executor workers (see
+    // NormalEquationsRows), e.g. when a few models are fitted to a large dataset. nullptr disables it
+    auto SetExecutor(tf::Executor* executor, std::size_t chunkSize = 0) const -> void
+    requires std::is_same_v<DTable, Operon::DefaultDispatch>
+    {
+        executor_ = executor;
+        chunkSize_ = chunkSize;
+    }
+
+    [[nodiscard]] auto Optimize(Operon::RandomGenerator& /*unused*/, Operon::Tree const& tree, std::size_t iterations) const -> OptimizerSummary final
+    {
+        using Vector = Eigen::VectorXd;
+        using Matrix = Eigen::MatrixXd;
+
+        auto const& dtable = this->GetDispatchTable();
+        auto const& problem = this->GetProblem();
+        auto const& dataset = problem.GetDataset();
+        auto range  = problem.TrainingRange();
+        auto target = problem.TargetValues(range);
+
+        Operon::Interpreter<Operon::Scalar, DTable> interpreter{dtable, dataset, tree, tapes_.Local()};
+        // the interpreters of the row-parallel path are created for every call, they do not freeze
+        detail::FreezeScope frozen{interpreter, range, executor_ == nullptr ? this->FreezeBudget() : 0};
+
+        auto x0 = tree.GetCoefficients();
+        auto const np { std::ssize(x0) };
+        OptimizerSummary summary;
+        summary.InitialParameters = x0;
+
+        Vector x = Eigen::Map<Eigen::Matrix<Operon::Scalar, -1, 1> const>(x0.data(), np).template cast<double>();
+        Matrix a(np, np);
+        Vector g(np);
+        std::vector<Operon::Scalar> coeff(np);
+        auto normal = [&](Vector const& c, Matrix& jtj, Vector& jtr) -> double {
+            ++summary.FunctionEvaluations;
+            ++summary.JacobianEvaluations;
+            Eigen::Map<Eigen::Matrix<Operon::Scalar, -1, 1>>(coeff.data(), np) = c.template cast<Operon::Scalar>();
+            Operon::Span<double> sa{jtj.data(), static_cast<std::size_t>(jtj.size())};
+            Operon::Span<double> sg{jtr.data(), static_cast<std::size_t>(jtr.size())};
+            if constexpr (std::is_same_v<DTable, Operon::DefaultDispatch>) {
+                if (executor_ != nullptr) {
+                    return 0.5 * NormalEquationsRows(*executor_, dtable, tree, dataset, range, coeff, target, sa, sg, chunkSize_); // NOLINT
+                }
+            }
+            return 0.5 * interpreter.NormalEquations(coeff, range, target, sa, sg); // NOLINT
+        };
+
+        auto cost = normal(x, a, g);
+        summary.InitialCost = summary.FinalCost = static_cast<Operon::Scalar>(cost);
+        if (np == 0 || !std::isfinite(cost)) {
+            summary.FinalParameters = x0;
+            return summary;
+        }
+
+        Matrix a1(np, np);
+        Vector g1(np);
+        Vector x1(np);
+        double cost1{};
+        cost = detail::LevenbergMarquardt(cost, iterations, x,
+            [&]() { return std::pair{ a, g }; },
+            [&](Vector const& step) { x1 = x + step; return cost1 = normal(x1, a1, g1); },
+            [&]() { x.swap(x1); a.swap(a1); g.swap(g1); return cost1; },
+            summary);
+
+        Eigen::Map<Eigen::Matrix<Operon::Scalar, -1, 1>>(x0.data(), np) = x.template cast<Operon::Scalar>();
+        summary.FinalParameters = x0;
+        summary.FinalCost = static_cast<Operon::Scalar>(cost);
+        summary.Success = detail::CheckSuccess(summary.InitialCost, summary.FinalCost);
+        return summary;
+    }
+
+    auto GetDispatchTable() const -> DTable const& { return dtable_.get(); }
+
+    auto SetWorkers(std::size_t count, std::function<int()> const& workerId) const -> void final { tapes_.Configure(count, workerId); }
+
+    [[nodiscard]] auto ComputeLikelihood(Operon::Span<Operon::Scalar const> x, Operon::Span<Operon::Scalar const> y, Operon::Span<Operon::Scalar const> w) const -> Operon::Scalar final
+    {
+        return GaussianLikelihood<Operon::Scalar>::ComputeLikelihood(x, y, w);
+    }
+
+    [[nodiscard]] auto ComputeFisherMatrix(Operon::Span<Operon::Scalar const> pred, Operon::Span<Operon::Scalar const> jac, Operon::Span<Operon::Scalar const> sigma) const -> Eigen::Matrix<Operon::Scalar, -1, -1> final {
+        return GaussianLikelihood<Operon::Scalar>::ComputeFisherMatrix(pred, jac, sigma);
+    }
+
+    private:
+    std::reference_wrapper<DTable const> dtable_;
+    mutable TapePool<Operon::Scalar, DTable> tapes_;
+    mutable tf::Executor* executor_{nullptr};
+    mutable std::size_t chunkSize_{0};
+};
+
+// variable projection for separable least squares problems. the coefficients that enter the model output
+// linearly (the weights of the terms reached from the root only through non-optimized additions and
+// subtractions) are eliminated with a linear least squares solve after every step, and levenberg-marquardt
+// runs only over the remaining (nonlinear) coefficients. the residual is affine in the linear coefficients,
+// so the elimination is exact and the reduced normal equations are the schur complement of the linear block
+template <typename DTable>
+struct VarProOptimizer final : public OptimizerBase {
+    explicit VarProOptimizer(DTable const& dtable, Problem const& problem)
+        : OptimizerBase{problem}, dtable_{dtable}
+    {
+    }
+
+    // one flag per coefficient (in the order of Tree::GetCoefficients), true if the output is linear in it
+    static auto LinearCoefficients(Operon::Tree const& tree) -> std::vector<bool>
+    {
+        auto const& nodes = tree.Nodes();
+        std::vector<bool> linear;
+        if (nodes.empty()) { return linear; }
+
+        // the output is linear in the value of the node (the root and the arguments of linear sums)
+        std::vector<bool> path(nodes.size(), false);
+        path.back() = true;
+        for (auto i = std::ssize(nodes) - 1; i >= 0; --i) {
+            auto const& n = nodes[i];
+            if (!path[i] || n.IsLeaf() || n.Optimize || !n.Is<NodeType::Add, NodeType::Sub>()) { continue; }
+            for (auto j : Tree::Indices(nodes, i)) { path[j] = true; }
+        }
+        for (auto i = 0UL; i < nodes.size(); ++i) {
+            if (nodes[i].Optimize) { linear.push_back(path[i]); }
+        }
+        return linear;
+    }
+
+    [[nodiscard]] auto Optimize(Operon::RandomGenerator& rng, Operon::Tree const& tree) const -> OptimizerSummary final { return Optimize(rng, tree, this->Iterations()); }
+
+    [[nodiscard]] auto Optimize(Operon::RandomGenerator& /*unused*/, Operon::Tree const& tree, std::size_t iterations) const -> OptimizerSummary final
+    {
+        using Vector = Eigen::VectorXd;
+        using Matrix = Eigen::MatrixXd;
+
+        auto const& dtable = this->GetDispatchTable();
+        auto const& problem = this->GetProblem();
+        auto const& dataset = problem.GetDataset();
+        auto range  = problem.TrainingRange();
+        auto target = problem.TargetValues(range);
+
+        Operon::Interpreter<Operon::Scalar, DTable> interpreter{dtable, dataset, tree, tapes_.Local()};
+        detail::FreezeScope frozen{interpreter, range, this->FreezeBudget()};
+
+        auto x0 = tree.GetCoefficients();
+        auto const np { std::ssize(x0) };
+        OptimizerSummary summary;
+        summary.InitialParameters = x0;
+
+        std::vector<int64_t> lin;
+        std::vector<int64_t> nonlin;
+        for (auto k = 0L; auto f : LinearCoefficients(tree)) { (f ? lin : nonlin).push_back(k++); }
+
+        // the solves work in double precision, like the normal equations
+        Vector x = Eigen::Map<Eigen::Matrix<Operon::Scalar, -1, 1> const>(x0.data(), np).template cast<double>();
+        Matrix a(np, np);
+        Vector g(np);
+        std::vector<Operon::Scalar> coeff(np);
+        auto normal = [&](Vector const& c, Matrix& jtj, Vector& jtr) -> double {
+            ++summary.FunctionEvaluations;
+            ++summary.JacobianEvaluations;
+            Eigen::Map<Eigen::Matrix<Operon::Scalar, -1, 1>>(coeff.data(), np) = c.template cast<Operon::Scalar>();
+            return 0.5 * interpreter.NormalEquations(coeff, range, target, // NOLINT
+                {jtj.data(), static_cast<std::size_t>(jtj.size())}, {jtr.data(), static_cast<std::size_t>(jtr.size())});
+        };
+
+        // moves the linear coefficients to their least squares solution and returns the new cost, which follows
+        // exactly from the normal equations (the minimum norm solution is used when the terms are collinear)
+        auto eliminate = [&](Vector& c, Matrix const& jtj, Vector const& jtr, double cost) {
+            if (lin.empty()) { return cost; }
+            Matrix const all = jtj(lin, lin);
+            Vector const d = all.completeOrthogonalDecomposition().solve(-jtr(lin));
+            if (!d.allFinite()) { return cost; }
+            c(lin) += d;
+            return cost + jtr(lin).dot(d) + 0.5 * d.dot(all * d); // NOLINT
+        };
+
+        auto cost = normal(x, a, g);
+        summary.InitialCost = summary.FinalCost = static_cast<Operon::Scalar>(cost);
+        if (np == 0 || !std::isfinite(cost)) {
+            summary.FinalParameters = x0;
+            return summary;
+        }
+        if (!lin.empty()) {
+            eliminate(x, a, g, cost);
+            cost = normal(x, a, g);
+        }
+
+        // normal equations of the nonlinear coefficients, with the linear ones eliminated
+        auto reduce = [&](Matrix const& jtj) -> Matrix {
+            if (lin.empty()) { return jtj; }
+            Matrix const anl = jtj(nonlin, lin);
+            return jtj(nonlin, nonlin) - anl * Matrix(jtj(lin, lin)).completeOrthogonalDecomposition().solve(anl.transpose());
+        };
+
+        Matrix a1(np, np);
+        Vector g1(np);
+        Vector x1(np);
+        double cost1{};
+        if (!nonlin.empty()) {
+            // the gradient of the linear coefficients vanishes after the elimination
+            cost = detail::LevenbergMarquardt(cost, iterations, x,
+                [&]() { return std::pair{ reduce(a), Vector(g(nonlin)) }; },
+                [&](Vector const& step) { x1 = x; x1(nonlin) += step; return cost1 = eliminate(x1, a1, g1, normal(x1, a1, g1)); },
+                [&]() {
+                    x.swap(x1);
+                    if (!lin.empty()) { return normal(x, a, g); }
+                    a.swap(a1);
+                    g.swap(g1);
+                    return cost1;
+                },
+                summary);
+        }
+
+        Eigen::Map<Eigen::Matrix<Operon::Scalar, -1, 1>>(x0.data(), np) = x.template cast<Operon::Scalar>();
+        summary.FinalParameters = x0;
+        summary.FinalCost = static_cast<Operon::Scalar>(cost);
+        summary.Success = detail::CheckSuccess(summary.InitialCost, summary.FinalCost);
+        return summary;
+    }
+
+    auto GetDispatchTable() const -> DTable const& { return dtable_.get(); }
+
+    auto SetWorkers(std::size_t count, std::function<int()> const& workerId) const -> void final { tapes_.Configure(count, workerId); }
+
+    [[nodiscard]] auto ComputeLikelihood(Operon::Span<Operon::Scalar const> x, Operon::Span<Operon::Scalar const> y, Operon::Span<Operon::Scalar const> w) const -> Operon::Scalar final
+    {
+        return GaussianLikelihood<Operon::Scalar>::ComputeLikelihood(x, y, w);
+    }
+
+    [[nodiscard]] auto ComputeFisherMatrix(Operon::Span<Operon::Scalar const> pred, Operon::Span<Operon::Scalar const> jac, Operon::Span<Operon::Scalar const> sigma) const -> Eigen::Matrix<Operon::Scalar, -1, -1> final {
+        return GaussianLikelihood<Operon::Scalar>::ComputeFisherMatrix(pred, jac, sigma);
+    }
+
+    private:
+    std::reference_wrapper<DTable const> dtable_;
+    mutable TapePool<Operon::Scalar, DTable> tapes_;
+};
+
 template<typename DTable, Concepts::Likelihood LossFunction = GaussianLikelihood<Operon::Scalar>>
 struct LBFGSOptimizer final : public OptimizerBase {
     LBFGSOptimizer(DTable const& dtable, Problem const& problem)
@@ -270,18 +626,20 @@ struct LBFGSOptimizer final : public OptimizerBase {
     {
     }
 
-    [[nodiscard]] auto Optimize(Operon::RandomGenerator& rng, Operon::Tree const& tree) const -> OptimizerSummary final
+    [[nodiscard]] auto Optimize(Operon::RandomGenerator& rng, Operon::Tree const& tree) const -> OptimizerSummary final { return Optimize(rng, tree, this->Iterations()); }
+
+    [[nodiscard]] auto Optimize(Operon::RandomGenerator& rng, Operon::Tree const& tree, std::size_t iterations) const -> OptimizerSummary final
     {
         auto const& dtable = this->GetDispatchTable();
         auto const& problem = this->GetProblem();
         auto const& dataset = problem.GetDataset();
         auto range  = problem.TrainingRange();
         auto target = problem.TargetValues(range);
-        auto iterations = this->Iterations();
         auto batchSize = this->BatchSize();
         if (batchSize == 0) { batchSize = range.Size(); }
 
-        Operon::Interpreter<Operon::Scalar, DTable> interpreter{dtable, dataset, tree};
+        // no frozen subtrees: every step only evaluates a mini-batch of the rows
+        Operon::Interpreter<Operon::Scalar, DTable> interpreter{dtable, dataset, tree, tapes_.Local()};
         LossFunction loss{rng, interpreter, target, range, batchSize};
 
         auto cost = [&](auto const& coeff) {
@@ -319,6 +677,8 @@ struct LBFGSOptimizer final : public OptimizerBase {
 
     auto GetDispatchTable() const -> DTable const& { return dtable_.get(); }
 
+    auto SetWorkers(std::size_t count, std::function<int()> const& workerId) const -> void final { tapes_.Configure(count, workerId); }
+
     [[nodiscard]] auto ComputeLikelihood(Operon::Span<Operon::Scalar const> x, Operon::Span<Operon::Scalar const> y, Operon::Span<Operon::Scalar const> w) const -> Operon::Scalar override
     {
         return LossFunction::ComputeLikelihood(x, y, w);
@@ -330,6 +690,7 @@ struct LBFGSOptimizer final : public OptimizerBase {
 
     private:
     std::reference_wrapper<DTable const> dtable_;
+    mutable TapePool<Operon::Scalar, DTable> tapes_;
 };
 
 template<typename DTable, Concepts::Likelihood LossFunction = GaussianLikelihood<Operon::Scalar>>
@@ -348,18 +709,22 @@ struct SGDOptimizer final : public OptimizerBase {
 
     auto GetDispatchTable() const -> DTable const& { return dtable_.get(); }
 
-    [[nodiscard]] auto Optimize(Operon::RandomGenerator& rng, Operon::Tree const& tree) const -> OptimizerSummary final
+    auto SetWorkers(std::size_t count, std::function<int()> const& workerId) const -> void final { tapes_.Configure(count, workerId); }
+
+    [[nodiscard]] auto Optimize(Operon::RandomGenerator& rng, Operon::Tree const& tree) const -> OptimizerSummary final { return Optimize(rng, tree, this->Iterations()); }
+
+    [[nodiscard]] auto Optimize(Operon::RandomGenerator& rng, Operon::Tree const& tree, std::size_t iterations) const -> OptimizerSummary final
     {
         auto const& dtable = this->GetDispatchTable();
         auto const& problem = this->GetProblem();
         auto const& dataset = problem.GetDataset();
         auto range  = problem.TrainingRange();
         auto target = problem.TargetValues(range);
-        auto iterations = this->Iterations();
         auto batchSize = this->BatchSize();
         if (batchSize == 0) { batchSize = range.Size(); }
 
-        Operon::Interpreter<Operon::Scalar, DTable> interpreter{dtable, dataset, tree};
+        // no frozen subtrees: every step only evaluates a mini-batch of the rows
+        Operon::Interpreter<Operon::Scalar, DTable> interpreter{dtable, dataset, tree, tapes_.Local()};
         LossFunction loss{rng, interpreter, target, range, batchSize};
 
         auto cost = [&](auto const& coeff) {
@@ -409,6 +774,7 @@ struct SGDOptimizer final : public OptimizerBase {
 
     private:
     std::reference_wrapper<DTable const> dtable_;
+    mutable TapePool<Operon::Scalar, DTable> tapes_;
     std::unique_ptr<UpdateRule::LearningRateUpdateRule const> update_{nullptr};
 };
 } // namespace Operon
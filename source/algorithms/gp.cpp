@@ -52,6 +52,22 @@ auto GeneticProgrammingAlgorithm::Run(tf::Executor& executor, Operon::RandomGene
 
     ENSURE(executor.num_workers() > 0);
     std::vector<Operon::Vector<Operon::Scalar>> slots(executor.num_workers());
+    // the population is evaluated in groups of trees sharing the same row blocks (see MultiInterpreter).
+    // an evaluator merging the identical subtrees gets one share of the population per worker instead,
+    // the buffers still hold the predictions of at most EvaluationGroupSize trees
+    auto const bufferGroup = std::max(config.EvaluationGroupSize, size_t{1});
+    auto const workers = executor.num_workers();
+    auto const group = evaluator.SharesSubtrees() ? std::max((config.PopulationSize + workers - 1) / workers, size_t{1}) : bufferGroup;
+
+    // the evaluator and the optimizer keep one tape per worker, reused across generations
+    generator.SetWorkers(executor.num_workers(), [&executor]() { return executor.this_worker_id(); });
+
+    // the offspring inherit most of their subtrees from their parents, their outputs are kept for the run
+    std::optional<SubtreeCache<Operon::Scalar>> cache;
+    if (config.SubtreeCacheSize > 0) {
+        cache.emplace(config.SubtreeCacheSize);
+        evaluator.SetSubtreeCache(&cache.value());
+    }
 
     tf::Taskflow taskflow;
 
@@ -62,6 +78,19 @@ auto GeneticProgrammingAlgorithm::Run(tf::Executor& executor, Operon::RandomGene
     auto parents = Parents();
     auto offspring = Offspring();
 
+    // the children selected for the second local search pass (see LocalSearchScheduler)
+    auto const* scheduler = generator.Scheduler();
+    std::vector<bool> selected;
+
+    // the individuals with an approximate fitness (evaluated on a row sample) which made it into the
+    // parent population are evaluated on all the training rows
+    auto promote = [&](tf::Subflow& subflow) {
+        return subflow.for_each_index(size_t{0}, parents.size(), size_t{1}, [&](size_t i) {
+            auto& slot = slots[executor.this_worker_id()];
+            evaluator.Promote(rngs[i], parents[i], Operon::Span<Operon::Scalar>(slot.data(), std::min(slot.size(), trainSize)));
+        }).name("promote parents");
+    };
+
     // while loop control flow
     auto [init, cond, body, back, done] = taskflow.emplace(
         [&](tf::Subflow& subflow) {
@@ -70,13 +99,14 @@ auto GeneticProgrammingAlgorithm::Run(tf::Executor& executor, Operon::RandomGene
                 coeffInit(rngs[i], parents[i].Genotype);
             }).name("initialize population");
             auto prepareEval = subflow.emplace([&]() { evaluator.Prepare(parents); }).name("prepare evaluator");
-            auto eval = subflow.for_each_index(size_t{0}, parents.size(), size_t{1}, [&](size_t i) {
+            auto eval = subflow.for_each_index(size_t{0}, parents.size(), group, [&](size_t i) {
                 auto id = executor.this_worker_id();
+                auto n = std::min(group, parents.size() - i);
                 // make sure the worker has a large enough buffer
-                if (slots[id].size() < trainSize) {
-                    slots[id].resize(trainSize);
+                if (auto const size = std::min(n, bufferGroup) * trainSize; slots[id].size() < size) {
+                    slots[id].resize(size);
                 }
-                parents[i].Fitness = evaluator(rngs[i], parents[i], slots[id]);
+                evaluator.EvaluateFull({ rngs.data() + i, n }, parents.subspan(i, n), slots[id]);
             }).name("evaluate population");
             auto reportProgress = subflow.emplace([&](){ if (report) { std::invoke(report); } }).name("report progress");
             init.precede(prepareEval);
@@ -90,7 +120,8 @@ auto GeneticProgrammingAlgorithm::Run(tf::Executor& executor, Operon::RandomGene
             }).name("keep elite");
             auto prepareGenerator = subflow.emplace([&]() { generator.Prepare(parents); }).name("prepare generator");
             auto generateOffspring = subflow.for_each_index(size_t{1}, offspring.size(), size_t{1}, [&](size_t i) {
-                auto buf = Operon::Span<Operon::Scalar>(slots[executor.this_worker_id()]);
+                auto& slot = slots[executor.this_worker_id()];
+                auto buf = Operon::Span<Operon::Scalar>(slot.data(), std::min(slot.size(), trainSize));
                 while (!stop()) {
                     if (auto result = generator(rngs[i], config.CrossoverProbability, config.MutationProbability, config.LocalSearchProbability, buf); result.has_value()) {
                         offspring[i] = std::move(result.value());
@@ -98,15 +129,27 @@ auto GeneticProgrammingAlgorithm::Run(tf::Executor& executor, Operon::RandomGene
                     }
                 }
             }).name("generate offspring");
+            auto selectOffspring = subflow.emplace([&]() {
+                if (scheduler != nullptr) { selected = scheduler->Select(offspring.subspan(1)); }
+            }).name("select offspring");
+            auto refineOffspring = subflow.for_each_index(size_t{1}, offspring.size(), size_t{1}, [&](size_t i) {
+                if (scheduler == nullptr || !selected[i - 1] || generator.Terminate()) { return; }
+                auto& slot = slots[executor.this_worker_id()];
+                scheduler->Refine(rngs[i], offspring[i], Operon::Span<Operon::Scalar>(slot.data(), std::min(slot.size(), trainSize)));
+            }).name("refine offspring");
             auto reinsert = subflow.emplace([&]() { reinserter(random, Parents(), offspring); }).name("reinsert");
+            auto promoteParents = promote(subflow);
             auto incrementGeneration = subflow.emplace([&]() { ++Generation(); }).name("increment generation");
             auto reportProgress = subflow.emplace([&](){ if (report) { std::invoke(report); } }).name("report progress");
 
             // set-up subflow graph
             keepElite.precede(prepareGenerator);
             prepareGenerator.precede(generateOffspring);
-            generateOffspring.precede(reinsert);
-            reinsert.precede(incrementGeneration);
+            generateOffspring.precede(selectOffspring);
+            selectOffspring.precede(refineOffspring);
+            refineOffspring.precede(reinsert);
+            reinsert.precede(promoteParents);
+            promoteParents.precede(incrementGeneration);
             incrementGeneration.precede(reportProgress);
         }, // loop body (evolutionary main loop)
         [&]() { return 0; }, // jump back to the next iteration
@@ -127,6 +170,10 @@ auto GeneticProgrammingAlgorithm::Run(tf::Executor& executor, Operon::RandomGene
 
     executor.run(taskflow);
     executor.wait_for_all();
+
+    // the executor (and the cache) might not outlive the operators
+    generator.SetWorkers(executor.num_workers(), {});
+    if (cache) { evaluator.SetSubtreeCache(nullptr); }
 }
 
 auto GeneticProgrammingAlgorithm::Run(Operon::RandomGenerator& random, std::function<void()> report, size_t threads) -> void {
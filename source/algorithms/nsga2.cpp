@@ -126,6 +126,22 @@ auto NSGA2::Run(tf::Executor& executor, Operon::RandomGenerator& random, std::fu
 
     ENSURE(executor.num_workers() > 0);
     std::vector<Operon::Vector<Operon::Scalar>> slots(executor.num_workers());
+    // the population is evaluated in groups of trees sharing the same row blocks (see MultiInterpreter).
+    // an evaluator merging the identical subtrees gets one share of the population per worker instead,
+    // the buffers still hold the predictions of at most EvaluationGroupSize trees
+    auto const bufferGroup = std::max(config.EvaluationGroupSize, size_t{1});
+    auto const workers = executor.num_workers();
+    auto const group = evaluator.SharesSubtrees() ? std::max((config.PopulationSize + workers - 1) / workers, size_t{1}) : bufferGroup;
+
+    // the evaluator and the optimizer keep one tape per worker, reused across generations
+    generator.SetWorkers(executor.num_workers(), [&executor]() { return executor.this_worker_id(); });
+
+    // the offspring inherit most of their subtrees from their parents, their outputs are kept for the run
+    std::optional<SubtreeCache<Operon::Scalar>> cache;
+    if (config.SubtreeCacheSize > 0) {
+        cache.emplace(config.SubtreeCacheSize);
+        evaluator.SetSubtreeCache(&cache.value());
+    }
 
     tf::Taskflow taskflow;
 
@@ -137,6 +153,22 @@ auto NSGA2::Run(tf::Executor& executor, Operon::RandomGenerator& random, std::fu
     auto parents      = Parents();
     auto offspring    = Offspring();
 
+    // the children selected for the second local search pass (see LocalSearchScheduler)
+    auto const* scheduler = generator.Scheduler();
+    std::vector<bool> selected;
+
+    // the individuals with an approximate fitness (evaluated on a row sample) which made it into the
+    // parent population are evaluated on all the training rows, their ranks are then updated
+    std::atomic_bool promoted{false};
+    auto promote = [&](tf::Subflow& subflow) {
+        return subflow.for_each_index(size_t{0}, parents.size(), size_t{1}, [&](size_t i) {
+            auto& slot = slots[executor.this_worker_id()];
+            if (evaluator.Promote(rngs[i], parents[i], Operon::Span<Operon::Scalar>(slot.data(), std::min(slot.size(), trainSize)))) {
+                promoted = true;
+            }
+        }).name("promote parents");
+    };
+
     // while loop control flow
     auto [init, cond, body, back, done] = taskflow.emplace(
         [&](tf::Subflow& subflow) {
@@ -145,13 +177,14 @@ auto NSGA2::Run(tf::Executor& executor, Operon::RandomGenerator& random, std::fu
                 coeffInit(rngs[i], parents[i].Genotype);
             }).name("initialize population");
             auto prepareEval = subflow.emplace([&]() { evaluator.Prepare(parents); }).name("prepare evaluator");
-            auto eval = subflow.for_each_index(size_t{0}, parents.size(), size_t{1}, [&](size_t i) {
+            auto eval = subflow.for_each_index(size_t{0}, parents.size(), group, [&](size_t i) {
                 auto id = executor.this_worker_id();
+                auto n = std::min(group, parents.size() - i);
                 // make sure the worker has a large enough buffer
-                if (slots[id].size() < trainSize) {
-                    slots[id].resize(trainSize);
+                if (auto const size = std::min(n, bufferGroup) * trainSize; slots[id].size() < size) {
+                    slots[id].resize(size);
                 }
-                parents[i].Fitness = evaluator(rngs[i], parents[i], slots[id]);
+                evaluator.EvaluateFull({ rngs.data() + i, n }, parents.subspan(i, n), slots[id]);
             }).name("evaluate population");
             auto nonDominatedSort = subflow.emplace([&]() { Sort(parents); }).name("non-dominated sort");
             auto reportProgress = subflow.emplace([&]() { if (report) { std::invoke(report); } }).name("report progress");
@@ -164,7 +197,8 @@ auto NSGA2::Run(tf::Executor& executor, Operon::RandomGenerator& random, std::fu
         [&](tf::Subflow& subflow) {
             auto prepareGenerator = subflow.emplace([&]() { generator.Prepare(parents); }).name("prepare generator");
             auto generateOffspring = subflow.for_each_index(size_t{0}, offspring.size(), size_t{1}, [&](size_t i) {
-                auto buf = Operon::Span<Operon::Scalar>(slots[executor.this_worker_id()]);
+                auto& slot = slots[executor.this_worker_id()];
+                auto buf = Operon::Span<Operon::Scalar>(slot.data(), std::min(slot.size(), trainSize));
                 while (!stop()) {
                     auto result = generator(rngs[i], config.CrossoverProbability, config.MutationProbability, config.LocalSearchProbability, buf);
                     if (result) {
@@ -174,16 +208,30 @@ auto NSGA2::Run(tf::Executor& executor, Operon::RandomGenerator& random, std::fu
                     }
                 }
             }).name("generate offspring");
+            auto selectOffspring = subflow.emplace([&]() {
+                if (scheduler != nullptr) { selected = scheduler->Select(offspring); }
+            }).name("select offspring");
+            auto refineOffspring = subflow.for_each_index(size_t{0}, offspring.size(), size_t{1}, [&](size_t i) {
+                if (scheduler == nullptr || !selected[i] || generator.Terminate()) { return; }
+                auto& slot = slots[executor.this_worker_id()];
+                scheduler->Refine(rngs[i], offspring[i], Operon::Span<Operon::Scalar>(slot.data(), std::min(slot.size(), trainSize)));
+            }).name("refine offspring");
             auto nonDominatedSort = subflow.emplace([&]() { Sort(individuals); }).name("non-dominated sort");
             auto reinsert = subflow.emplace([&]() { reinserter.Sort(individuals); }).name("reinsert");
+            auto promoteParents = promote(subflow);
+            auto sortParents = subflow.emplace([&]() { if (promoted.exchange(false)) { Sort(parents); } }).name("sort promoted parents");
             auto incrementGeneration = subflow.emplace([&]() { ++Generation(); }).name("increment generation");
             auto reportProgress = subflow.emplace([&]() { if (report) { std::invoke(report); } }).name("report progress");
 
             // set-up subflow graph
             prepareGenerator.precede(generateOffspring);
-            generateOffspring.precede(nonDominatedSort);
+            generateOffspring.precede(selectOffspring);
+            selectOffspring.precede(refineOffspring);
+            refineOffspring.precede(nonDominatedSort);
             nonDominatedSort.precede(reinsert);
-            reinsert.precede(incrementGeneration);
+            reinsert.precede(promoteParents);
+            promoteParents.precede(sortParents);
+            sortParents.precede(incrementGeneration);
             incrementGeneration.precede(reportProgress);
         }, // loop body (evolutionary main loop)
         [&]() { return 0; }, // jump back to the next iteration
@@ -204,6 +252,10 @@ auto NSGA2::Run(tf::Executor& executor, Operon::RandomGenerator& random, std::fu
 
     executor.run(taskflow);
     executor.wait_for_all();
+
+    // the executor (and the cache) might not outlive the operators
+    generator.SetWorkers(executor.num_workers(), {});
+    if (cache) { evaluator.SetSubtreeCache(nullptr); }
 }
 
 auto NSGA2::Run(Operon::RandomGenerator& random, std::function<void()> report, size_t threads) -> void
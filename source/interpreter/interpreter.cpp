@@ -4,38 +4,131 @@
 #include <taskflow/taskflow.hpp>
 #include <taskflow/algorithm/for_each.hpp>   // for taskflow.for_each_index
 #include "operon/interpreter/interpreter.hpp"
+#include "operon/interpreter/multi_interpreter.hpp"
 
 namespace Operon {
+    namespace {
+        // the trees are evaluated in groups, each worker keeps its own multi-interpreter
+        template<typename Out>
+        auto EvaluateGroups(std::vector<Operon::Tree> const& trees, Operon::Dataset const& dataset, Operon::Range range, Out&& output, size_t nthread) -> void {
+            if (nthread == 0) { nthread = std::thread::hardware_concurrency(); }
+            tf::Executor executor(nthread);
+            tf::Taskflow taskflow;
+            Operon::DefaultDispatch dtable;
+            using MINT = Operon::MultiInterpreter<Operon::Scalar, Operon::DefaultDispatch>;
+            std::vector<MINT> interpreters;
+            interpreters.reserve(executor.num_workers());
+            for (auto i = 0UL; i < executor.num_workers(); ++i) {
+                interpreters.emplace_back(dtable, dataset);
+            }
+
+            auto constexpr group{ MINT::DefaultGroupSize };
+            taskflow.for_each_index(size_t{0}, size_t{trees.size()}, group, [&](size_t i) {
+                auto const n = std::min(group, trees.size() - i);
+                auto& interpreter = interpreters[executor.this_worker_id()];
+                interpreter.Evaluate(std::span{trees}.subspan(i, n), range, [&](size_t j) { return output(i + j); });
+            });
+            executor.run(taskflow);
+            executor.wait_for_all();
+        }
+
+        // the chunks are a multiple of the batch size, a few per worker so that the load is balanced
+        auto ChunkSize(tf::Executor const& executor, Operon::Range range, std::size_t chunkSize) -> std::size_t {
+            constexpr auto batch { Operon::Interpreter<Operon::Scalar, Operon::DefaultDispatch>::BatchSize };
+            constexpr std::size_t chunksPerWorker{4};
+            constexpr std::size_t minChunkSize{4096};
+            if (chunkSize == 0) {
+                chunkSize = std::max(minChunkSize, range.Size() / (chunksPerWorker * executor.num_workers()));
+            }
+            return (chunkSize + batch - 1) / batch * batch;
+        }
+
+        // each worker evaluates its chunks with its own interpreter (and its own primal buffer), all of them
+        // share the dispatch table of the caller
+        template<typename DTable, typename F>
+        auto ForEachChunk(tf::Executor& executor, DTable const& dtable, Operon::Tree const& tree, Operon::Dataset const& dataset, Operon::Range range, std::size_t chunkSize, F&& f) -> void {
+            using TInterpreter = Operon::Interpreter<Operon::Scalar, DTable>;
+            std::vector<TInterpreter> interpreters;
+            interpreters.reserve(executor.num_workers());
+            for (auto i = 0UL; i < executor.num_workers(); ++i) {
+                interpreters.emplace_back(dtable, dataset, tree);
+            }
+
+            auto const chunk { ChunkSize(executor, range, chunkSize) };
+            tf::Taskflow taskflow;
+            taskflow.for_each_index(size_t{0}, range.Size(), chunk, [&](size_t i) {
+                Operon::Range rg{range.Start() + i, range.Start() + std::min(i + chunk, range.Size())};
+                std::invoke(f, interpreters[executor.this_worker_id()], rg, i);
+            });
+            // the caller might itself be running on one of the executor workers
+            if (executor.this_worker_id() >= 0) {
+                executor.corun(taskflow);
+            } else {
+                executor.run(taskflow).wait();
+            }
+        }
+    } // namespace
+
     auto EvaluateTrees(std::vector<Operon::Tree> const& trees, Operon::Dataset const& dataset, Operon::Range range, size_t nthread) -> std::vector<std::vector<Operon::Scalar>> {
-        if (nthread == 0) { nthread = std::thread::hardware_concurrency(); }
-        tf::Executor executor(nthread);
-        tf::Taskflow taskflow;
         std::vector<std::vector<Operon::Scalar>> result(trees.size());
-        Operon::DefaultDispatch dtable;
-        using INT = Operon::Interpreter<Operon::Scalar, Operon::DefaultDispatch>;
-
-        taskflow.for_each_index(size_t{0}, size_t{trees.size()}, size_t{1}, [&](size_t i) {
+        EvaluateGroups(trees, dataset, range, [&](size_t i) {
             result[i].resize(range.Size());
-            Operon::Span<Operon::Scalar> s{result[i].data(), result[i].size()};
-            INT{dtable, dataset, trees[i]}.Evaluate({}, range, s);
-        });
-        executor.run(taskflow);
-        executor.wait_for_all();
+            return Operon::Span<Operon::Scalar>{result[i].data(), result[i].size()};
+        }, nthread);
         return result;
     }
 
     auto EvaluateTrees(std::vector<Operon::Tree> const& trees, Operon::Dataset const& dataset, Operon::Range range, std::span<Operon::Scalar> result, size_t nthread) -> void {
+        EvaluateGroups(trees, dataset, range, [&](size_t i) { return result.subspan(i * range.Size(), range.Size()); }, nthread);
+    }
+
+    auto EvaluateRows(tf::Executor& executor, Operon::DefaultDispatch const& dtable, Operon::Tree const& tree, Operon::Dataset const& dataset, Operon::Range range, Operon::Span<Operon::Scalar const> coeff, Operon::Span<Operon::Scalar> result, std::size_t chunkSize) -> void {
+        EXPECT(result.size() == range.Size());
+        ForEachChunk(executor, dtable, tree, dataset, range, chunkSize, [&](auto const& interpreter, Operon::Range rg, size_t offset) {
+            interpreter.Evaluate(coeff, rg, result.subspan(offset, rg.Size()));
+        });
+    }
+
+    auto EvaluateRows(Operon::Tree const& tree, Operon::Dataset const& dataset, Operon::Range range, size_t nthread, std::size_t chunkSize) -> std::vector<Operon::Scalar> {
         if (nthread == 0) { nthread = std::thread::hardware_concurrency(); }
         tf::Executor executor(nthread);
-        tf::Taskflow taskflow;
         Operon::DefaultDispatch dtable;
-        using INT = Operon::Interpreter<Operon::Scalar, Operon::DefaultDispatch>;
+        std::vector<Operon::Scalar> result(range.Size());
+        EvaluateRows(executor, dtable, tree, dataset, range, {}, result, chunkSize);
+        return result;
+    }
 
-        taskflow.for_each_index(size_t{0}, size_t{trees.size()}, size_t{1}, [&](size_t i) {
-            auto res = result.subspan(i * range.Size(), range.Size());
-            INT{dtable, dataset, trees[i]}.Evaluate({}, range, res);
+    auto JacRevRows(tf::Executor& executor, Operon::DefaultDispatch const& dtable, Operon::Tree const& tree, Operon::Dataset const& dataset, Operon::Range range, Operon::Span<Operon::Scalar const> coeff, Operon::Span<Operon::Scalar> jacobian, std::size_t chunkSize) -> void {
+        auto const rows { static_cast<int64_t>(range.Size()) };
+        auto const cols { static_cast<int64_t>(coeff.size()) };
+        EXPECT(std::ssize(jacobian) == rows * cols);
+        // the jacobian is column-major, each chunk writes its rows in place (leading dimension = rows)
+        ForEachChunk(executor, dtable, tree, dataset, range, chunkSize, [&](auto const& interpreter, Operon::Range rg, size_t offset) {
+            interpreter.JacRev(coeff, rg, jacobian.subspan(offset), rows);
         });
-        executor.run(taskflow);
-        executor.wait_for_all();
+    }
+
+    auto NormalEquationsRows(tf::Executor& executor, Operon::DefaultDispatch const& dtable, Operon::Tree const& tree, Operon::Dataset const& dataset, Operon::Range range, Operon::Span<Operon::Scalar const> coeff, Operon::Span<Operon::Scalar const> target, Operon::Span<double> jtj, Operon::Span<double> jtr, std::size_t chunkSize) -> double {
+        auto const np { std::ssize(coeff) };
+        EXPECT(target.size() == range.Size());
+        EXPECT(std::ssize(jtj) == np * np && std::ssize(jtr) == np);
+        // every chunk writes its partial sums (J^T J, J^T r and the squared residuals) to its own slot, the
+        // slots are added in chunk order so that the result does not depend on the scheduling
+        auto const chunk { ChunkSize(executor, range, chunkSize) };
+        auto const chunks { static_cast<int64_t>((range.Size() + chunk - 1) / chunk) };
+        auto const stride { np * np + np + 1 };
+        std::vector<double> partial(chunks * stride);
+        ForEachChunk(executor, dtable, tree, dataset, range, chunk, [&](auto const& interpreter, Operon::Range rg, size_t offset) {
+            auto* p = partial.data() + static_cast<int64_t>(offset / chunk) * stride;
+            p[stride-1] = interpreter.NormalEquations(coeff, rg, target.subspan(offset, rg.Size()), {p, static_cast<std::size_t>(np * np)}, {p + np * np, static_cast<std::size_t>(np)});
+        });
+
+        Eigen::Map<Eigen::VectorXd> sum(partial.data(), stride);
+        for (auto i = 1L; i < chunks; ++i) {
+            sum += Eigen::Map<Eigen::VectorXd const>(partial.data() + i * stride, stride);
+        }
+        std::ranges::copy_n(partial.begin(), np * np, jtj.begin());
+        std::ranges::copy_n(partial.begin() + np * np, np, jtr.begin());
+        return partial[stride-1];
     }
 } // namespace Operon
@@ -0,0 +1,244 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2024 Heal Research
+
+#include <algorithm>
+#include <fmt/format.h>
+#include <numbers>
+#include <stdexcept>
+
+#include "operon/interpreter/interval.hpp"
+
+namespace Operon {
+    namespace {
+        using T = Operon::Scalar;
+        constexpr T Pi { std::numbers::pi_v<T> };
+
+        // zero times infinity is zero: a zero bound is an exact zero and the infinite bound is only a limit
+        auto Times(T a, T b) -> T { return (a == T{0} || b == T{0}) ? T{0} : a * b; }
+
+        auto Hull(T a, T b, T c, T d) -> Interval { return { std::min({a, b, c, d}), std::max({a, b, c, d}) }; }
+
+        auto Increasing(Interval x, auto&& f) -> Interval { return { f(x.Lower), f(x.Upper) }; }
+
+        auto Neg(Interval x) -> Interval { return { -x.Upper, -x.Lower }; }
+
+        auto Add(Interval x, Interval y) -> Interval { return { x.Lower + y.Lower, x.Upper + y.Upper }; }
+
+        auto Mul(Interval x, Interval y) -> Interval
+        {
+            return Hull(Times(x.Lower, y.Lower), Times(x.Lower, y.Upper), Times(x.Upper, y.Lower), Times(x.Upper, y.Upper));
+        }
+
+        // a zero weight does not cancel infinite values (the evaluation would produce NaN)
+        auto Scale(Interval x, T w) -> Interval
+        {
+            if (w == T{0}) { return x.IsFinite() ? Interval{ 0, 0 } : Interval::Undefined(); }
+            return w < 0 ? Interval{ w * x.Upper, w * x.Lower } : Interval{ w * x.Lower, w * x.Upper };
+        }
+
+        auto Inv(Interval x) -> Interval
+        {
+            if (x.Contains(T{0})) { return {}; }
+            return { T{1} / x.Upper, T{1} / x.Lower };
+        }
+
+        auto Abs(Interval x) -> Interval
+        {
+            if (x.Lower >= 0) { return x; }
+            if (x.Upper <= 0) { return Neg(x); }
+            return { T{0}, std::max(-x.Lower, x.Upper) };
+        }
+
+        auto Square(Interval x) -> Interval
+        {
+            auto a = Abs(x);
+            return { a.Lower * a.Lower, a.Upper * a.Upper };
+        }
+
+        // true if the interval contains a point p + k * period for some integer k
+        auto ContainsPeriodic(Interval x, T p, T period) -> bool
+        {
+            return p + std::ceil((x.Lower - p) / period) * period <= x.Upper;
+        }
+
+        auto Sin(Interval x) -> Interval
+        {
+            if (!x.IsFinite() || x.Width() >= 2 * Pi) { return { -1, 1 }; }
+            auto lo = std::min(std::sin(x.Lower), std::sin(x.Upper));
+            auto hi = std::max(std::sin(x.Lower), std::sin(x.Upper));
+            if (ContainsPeriodic(x, Pi / 2, 2 * Pi)) { hi = T{1}; }
+            if (ContainsPeriodic(x, -Pi / 2, 2 * Pi)) { lo = T{-1}; }
+            return { lo, hi };
+        }
+
+        auto Cos(Interval x) -> Interval { return Sin({ x.Lower + Pi / 2, x.Upper + Pi / 2 }); }
+
+        auto Tan(Interval x) -> Interval
+        {
+            if (!x.IsFinite() || x.Width() >= Pi || ContainsPeriodic(x, Pi / 2, Pi)) { return {}; }
+            return Increasing(x, [](auto v) { return std::tan(v); });
+        }
+
+        auto Cosh(Interval x) -> Interval
+        {
+            auto a = Abs(x);
+            return Increasing(a, [](auto v) { return std::cosh(v); });
+        }
+
+        auto Pow(Interval x, Interval y) -> Interval
+        {
+            // non-negative base: x^y = exp(y * log(x)) is a composition of monotonic functions
+            if (x.Lower >= 0) {
+                auto z = Mul(y, Increasing(x, [](auto v) { return std::log(v); }));
+                return Increasing(z, [](auto v) { return std::exp(v); });
+            }
+            // otherwise only constant integer exponents are defined everywhere
+            if (y.Lower != y.Upper || std::trunc(y.Lower) != y.Lower) { return Interval::Undefined(); }
+            auto const n { y.Lower };
+            if (n == 0) { return { 1, 1 }; }
+            auto p = std::fmod(n, T{2}) == 0
+                ? Increasing(Abs(x), [n](auto v) { return std::pow(v, std::abs(n)); })
+                : Increasing(x, [n](auto v) { return std::pow(v, std::abs(n)); });
+            return n > 0 ? p : Inv(p);
+        }
+
+        auto Function(Operon::NodeType type, Interval x) -> Interval
+        {
+            using F = T(*)(T);
+            auto inc = [&](F f) { return Increasing(x, f); };
+            switch (type) {
+            case NodeType::Abs: return Abs(x);
+            case NodeType::Acos: return Neg(inc([](auto v) { return -std::acos(v); }));
+            case NodeType::Asin: return inc([](auto v) { return std::asin(v); });
+            case NodeType::Atan: return inc([](auto v) { return std::atan(v); });
+            case NodeType::Cbrt: return inc([](auto v) { return std::cbrt(v); });
+            case NodeType::Ceil: return inc([](auto v) { return std::ceil(v); });
+            case NodeType::Cos: return Cos(x);
+            case NodeType::Cosh: return Cosh(x);
+            case NodeType::Exp: return inc([](auto v) { return std::exp(v); });
+            case NodeType::Floor: return inc([](auto v) { return std::floor(v); });
+            case NodeType::Log: return inc([](auto v) { return std::log(v); });
+            case NodeType::Logabs: return Increasing(Abs(x), [](auto v) { return std::log(v); });
+            case NodeType::Log1p: return inc([](auto v) { return std::log1p(v); });
+            case NodeType::Sin: return Sin(x);
+            case NodeType::Sinh: return inc([](auto v) { return std::sinh(v); });
+            case NodeType::Sqrt: return inc([](auto v) { return std::sqrt(v); });
+            case NodeType::Sqrtabs: return Increasing(Abs(x), [](auto v) { return std::sqrt(v); });
+            case NodeType::Tan: return Tan(x);
+            case NodeType::Tanh: return inc([](auto v) { return std::tanh(v); });
+            case NodeType::Square: return Square(x);
+            // no interval rule (e.g. the user-registered callables): the output may take any value
+            default: return {};
+            }
+        }
+    } // namespace
+
+    IntervalInterpreter::IntervalInterpreter(Operon::Dataset const& dataset, Operon::Range range, bool strict)
+        : strict_(strict)
+    {
+        for (auto const& v : dataset.GetVariables()) {
+            auto values = dataset.GetValues(v.Index).subspan(range.Start(), range.Size());
+            if (values.empty() || std::ranges::any_of(values, [](auto x) { return std::isnan(x); })) {
+                bounds_[v.Hash] = Interval::Undefined();
+                continue;
+            }
+            auto [lo, hi] = std::ranges::minmax(values);
+            bounds_[v.Hash] = { lo, hi };
+        }
+    }
+
+    auto IntervalInterpreter::Evaluate(Operon::Tree const& tree, std::vector<Interval>& result) const -> void
+    {
+        auto const& nodes = tree.Nodes();
+        result.resize(nodes.size());
+
+        for (auto i = 0UL; i < nodes.size(); ++i) {
+            auto const& n = nodes[i];
+            auto children = Tree::Indices(nodes, i);
+
+            if (n.IsVariable()) {
+                auto it = bounds_.find(n.HashValue);
+                if (it == bounds_.end()) {
+                    throw std::runtime_error(fmt::format("interval interpreter: no bounds for variable hash {}\n", n.HashValue));
+                }
+                result[i] = it->second.IsDefined() ? Scale(it->second, n.Value) : Interval::Undefined();
+                continue;
+            }
+            if (n.IsLeaf()) {
+                result[i] = { n.Value, n.Value };
+                continue;
+            }
+            // unbounded arguments may take infinite values, for which most functions are undefined (inf - inf, 0 * inf, sin(inf)),
+            // only the strict check treats them as undefined
+            auto const bounded = [&](auto j) { return strict_ ? result[j].IsFinite() : result[j].IsDefined(); };
+            if (!std::ranges::all_of(children, bounded)) {
+                result[i] = Interval::Undefined();
+                continue;
+            }
+
+            // the first argument is the child closest to the parent (see NaryOp)
+            auto const first { result[i - 1] };
+            auto const second { n.Arity > 1 ? result[i - 1 - (nodes[i - 1].Length + 1)] : Interval{} };
+            // combines the arguments starting from the k-th one
+            auto const fold = [&](std::size_t k, auto&& op) {
+                Interval x;
+                std::size_t a{0};
+                for (auto j : children) {
+                    if (a > k) { x = op(x, result[j]); } else if (a == k) { x = result[j]; }
+                    ++a;
+                }
+                return x;
+            };
+
+            Interval x;
+            switch (n.Type) {
+            case NodeType::Add: {
+                x = fold(0, Add);
+                break;
+            }
+            case NodeType::Sub: {
+                x = n.Arity == 1 ? Neg(first) : Add(first, Neg(fold(1, Add)));
+                break;
+            }
+            case NodeType::Mul: {
+                x = fold(0, Mul);
+                break;
+            }
+            case NodeType::Div: {
+                auto const inv = Inv(n.Arity == 1 ? first : fold(1, Mul));
+                x = !inv.IsFinite() || n.Arity == 1 ? inv : Mul(first, inv);
+                break;
+            }
+            case NodeType::Fmin: {
+                x = fold(0, [](auto a, auto b) { return Interval{ std::min(a.Lower, b.Lower), std::min(a.Upper, b.Upper) }; });
+                break;
+            }
+            case NodeType::Fmax: {
+                x = fold(0, [](auto a, auto b) { return Interval{ std::max(a.Lower, b.Lower), std::max(a.Upper, b.Upper) }; });
+                break;
+            }
+            case NodeType::Aq: {
+                auto d = Increasing(Square(second), [](auto v) { return std::sqrt(T{1} + v); });
+                x = Mul(first, Inv(d));
+                break;
+            }
+            case NodeType::Pow: {
+                x = Pow(first, second);
+                break;
+            }
+            default: {
+                x = Function(n.Type, first);
+                break;
+            }
+            }
+            result[i] = x.IsDefined() ? Scale(x, n.Value) : Interval::Undefined();
+        }
+    }
+
+    auto IntervalInterpreter::operator()(Operon::Tree const& tree) const -> Interval
+    {
+        std::vector<Interval> result;
+        Evaluate(tree, result);
+        return result.empty() ? Interval::Undefined() : result.back();
+    }
+} // namespace Operon
@@ -0,0 +1,173 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2024 Heal Research
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <fmt/format.h>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "operon/interpreter/isa.hpp"
+#include "isa/builtins.hpp"
+#include "operon_variants.hpp"
+
+namespace Operon {
+    namespace {
+        constexpr std::array IsaNames {
+            std::pair{ InstructionSet::Generic, std::string_view{"generic"} },
+            std::pair{ InstructionSet::Sse42, std::string_view{"sse4.2"} },
+            std::pair{ InstructionSet::Avx2, std::string_view{"avx2"} },
+            std::pair{ InstructionSet::Avx512, std::string_view{"avx512"} }
+        };
+
+        // same names as the MATH_BACKEND values (case insensitive)
+        constexpr std::array BackendNames {
+            std::pair{ MathBackend::Default, std::string_view{"default"} },
+            std::pair{ MathBackend::Eigen, std::string_view{"eigen"} },
+            std::pair{ MathBackend::Stl, std::string_view{"stl"} },
+            std::pair{ MathBackend::Eve, std::string_view{"eve"} },
+            std::pair{ MathBackend::FastV1, std::string_view{"fast_v1"} },
+            std::pair{ MathBackend::FastV2, std::string_view{"fast_v2"} },
+            std::pair{ MathBackend::FastV3, std::string_view{"fast_v3"} }
+        };
+
+        template<typename E, std::size_t N>
+        auto Name(std::array<std::pair<E, std::string_view>, N> const& names, E value) -> std::string_view
+        {
+            auto const* it = std::ranges::find(names, value, &std::pair<E, std::string_view>::first);
+            return it == names.end() ? std::string_view{"unknown"} : it->second;
+        }
+
+        template<typename E, std::size_t N>
+        auto Parse(std::array<std::pair<E, std::string_view>, N> const& names, std::string_view name) -> std::optional<E>
+        {
+            std::string s(name);
+            std::ranges::transform(s, s.begin(), [](unsigned char c) { return std::tolower(c); });
+            auto const* it = std::ranges::find(names, std::string_view{s}, &std::pair<E, std::string_view>::second);
+            if (it == names.end()) { return std::nullopt; }
+            return it->first;
+        }
+
+        // the backend of the inline kernels, it has no variants of its own
+        constexpr auto Configured {
+#if defined(OPERON_MATH_EIGEN)
+            MathBackend::Eigen
+#elif defined(OPERON_MATH_STL)
+            MathBackend::Stl
+#elif defined(OPERON_MATH_EVE)
+            MathBackend::Eve
+#elif defined(OPERON_MATH_FAST_V1)
+            MathBackend::FastV1
+#elif defined(OPERON_MATH_FAST_V2)
+            MathBackend::FastV2
+#elif defined(OPERON_MATH_FAST_V3)
+            MathBackend::FastV3
+#else
+            MathBackend::Default
+#endif
+        };
+
+        auto Normalize(MathBackend backend) -> MathBackend { return backend == Configured ? MathBackend::Default : backend; }
+
+        // the processor features enabled by the compile flags of each variant (the checks include the
+        // operating system support for the wider registers)
+        auto Supports(InstructionSet isa) -> bool
+        {
+#if defined(OPERON_ISA_DISPATCH)
+            __builtin_cpu_init();
+            auto const sse42 = __builtin_cpu_supports("sse4.2") && __builtin_cpu_supports("popcnt");
+            auto const avx2 = sse42 && __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")
+                && __builtin_cpu_supports("bmi") && __builtin_cpu_supports("bmi2");
+            auto const avx512 = avx2 && __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")
+                && __builtin_cpu_supports("avx512cd") && __builtin_cpu_supports("avx512dq") && __builtin_cpu_supports("avx512vl");
+            switch (isa) {
+            case InstructionSet::Generic: return true;
+            case InstructionSet::Sse42: return sse42;
+            case InstructionSet::Avx2: return avx2;
+            case InstructionSet::Avx512: return avx512;
+            }
+            return false;
+#else
+            return isa == InstructionSet::Generic;
+#endif
+        }
+
+        auto Compiled([[maybe_unused]] MathBackend backend, [[maybe_unused]] InstructionSet isa) -> detail::IsaBuiltinTable const*
+        {
+#define OPERON_VARIANT(B, I) if (backend == MathBackend::B && isa == InstructionSet::I) { return detail::CompiledBuiltins<MathBackend::B, InstructionSet::I>(); } // NOLINT
+            OPERON_VARIANTS
+#undef OPERON_VARIANT
+            return nullptr;
+        }
+
+        auto Initial() -> InstructionSet
+        {
+            // called from a static initializer: an invalid request falls back to the detected instruction set
+            if (auto const* env = std::getenv("OPERON_ISA"); env != nullptr && *env != '\0') { // NOLINT
+                auto const isa = ParseInstructionSet(env);
+                if (!isa) {
+                    fmt::print(stderr, "warning: unknown instruction set OPERON_ISA={}, using the detected one\n", env);
+                } else if (!IsAvailable(*isa)) {
+                    fmt::print(stderr, "warning: instruction set {} is not available, using the detected one\n", env);
+                } else {
+                    return *isa;
+                }
+            }
+            for (auto isa : { InstructionSet::Avx512, InstructionSet::Avx2, InstructionSet::Sse42 }) {
+                if (IsAvailable(isa)) { return isa; }
+            }
+            return InstructionSet::Generic;
+        }
+
+        auto Current() -> std::atomic<InstructionSet>&
+        {
+            static std::atomic<InstructionSet> isa{ Initial() };
+            return isa;
+        }
+    } // namespace
+
+    auto IsAvailable(InstructionSet isa) -> bool
+    {
+        return (isa == InstructionSet::Generic || Compiled(MathBackend::Default, isa) != nullptr) && Supports(isa);
+    }
+
+    auto IsAvailable(MathBackend backend) -> bool
+    {
+        backend = Normalize(backend);
+        return backend == MathBackend::Default || Compiled(backend, InstructionSet::Generic) != nullptr;
+    }
+
+    auto GetInstructionSet() -> InstructionSet { return Current().load(); }
+
+    auto SetInstructionSet(InstructionSet isa) -> void
+    {
+        if (!IsAvailable(isa)) {
+            throw std::runtime_error(fmt::format("instruction set {} is not available", InstructionSetName(isa)));
+        }
+        Current().store(isa);
+    }
+
+    auto InstructionSetName(InstructionSet isa) -> std::string_view { return Name(IsaNames, isa); }
+    auto ParseInstructionSet(std::string_view name) -> std::optional<InstructionSet> { return Parse(IsaNames, name); }
+
+    auto MathBackendName(MathBackend backend) -> std::string_view { return Name(BackendNames, backend); }
+    auto ParseMathBackend(std::string_view name) -> std::optional<MathBackend> { return Parse(BackendNames, name); }
+
+    namespace detail {
+        // the other backends are always compiled for the generic instruction set
+        auto VariantBuiltins(MathBackend backend) -> IsaBuiltinTable const*
+        {
+            if (!IsAvailable(backend)) {
+                throw std::runtime_error(fmt::format("math backend {} is not available", MathBackendName(backend)));
+            }
+            backend = Normalize(backend);
+            if (auto const* builtins = Compiled(backend, GetInstructionSet()); builtins != nullptr) { return builtins; }
+            return Compiled(backend, InstructionSet::Generic);
+        }
+    } // namespace detail
+} // namespace Operon
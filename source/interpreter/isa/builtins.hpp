@@ -0,0 +1,20 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2024 Heal Research
+
+#ifndef OPERON_SOURCE_INTERPRETER_ISA_BUILTINS_HPP
+#define OPERON_SOURCE_INTERPRETER_ISA_BUILTINS_HPP
+
+#include "operon/interpreter/dispatch_table.hpp"
+#include "operon/interpreter/isa.hpp"
+
+namespace Operon::detail {
+    using IsaBuiltinTable = Dispatch::Builtins<Operon::Scalar, Dispatch::DefaultBatchSize<Operon::Scalar>>;
+
+    // one translation unit per math backend and instruction set, generated from variant.cpp.in and
+    // compiled with the corresponding flags (see CMakeLists.txt). the compiled variants are listed in
+    // the generated operon_variants.hpp
+    template<MathBackend B, InstructionSet I>
+    auto CompiledBuiltins() -> IsaBuiltinTable const*;
+} // namespace Operon::detail
+
+#endif
@@ -0,0 +1,68 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2024 Heal Research
+
+#ifndef OPERON_SOURCE_INTERPRETER_ISA_KERNELS_HPP
+#define OPERON_SOURCE_INTERPRETER_ISA_KERNELS_HPP
+
+// the built-in primitives compiled with the instruction set flags of the including translation unit. the
+// kernel templates (and the backend code) are declared in the inline namespace OPERON_ISA_NAMESPACE of the
+// variant (see isa.hpp), so that their out-of-line copies (e.g. at -O0) are not merged with the ones of
+// the other variants. the entry points below have internal linkage and are flattened, so that the code
+// shared with the rest of the library (the standard library, Eigen) is inlined into them as well. what is
+// not inlined (e.g. everything at -O0) is renamed by the build (see cmake/kernel-variants.cmake)
+#if !defined(OPERON_ISA_NAMESPACE)
+#error "the kernel variants must define OPERON_ISA_NAMESPACE"
+#endif
+
+#include "builtins.hpp"
+
+namespace Operon::detail::isa {
+namespace {
+    using T = Operon::Scalar;
+    constexpr auto S = Dispatch::DefaultBatchSize<T>;
+
+    template<NodeType Type>
+    [[gnu::flatten]] auto Call(Operon::Vector<Node> const& nodes, Backend::View<T, S> primal, size_t i, Operon::Range range) -> void
+    {
+        if constexpr (Node::IsNary<Type>) {
+            Dispatch::NaryOp<Type, T, S>(nodes, primal, i, range);
+        } else if constexpr (Node::IsBinary<Type>) {
+            Dispatch::BinaryOp<Type, T, S>(nodes, primal, i, range);
+        } else {
+            Dispatch::UnaryOp<Type, T, S>(nodes, primal, i, range);
+        }
+    }
+
+    template<NodeType Type>
+    [[gnu::flatten]] auto Diff(Operon::Vector<Node> const& nodes, Backend::View<T const, S> primal, Backend::View<T, S> trace, int i, int j) -> void
+    {
+        Dispatch::DiffOp<Type, T, S>(nodes, primal, trace, i, j);
+    }
+
+    template<NodeType Type>
+    [[gnu::flatten]] auto Fuse(T* result, Operon::Span<Dispatch::Operand<T> const> args, int64_t n) -> void
+    {
+        Dispatch::FusedOp<Type, T, S>(result, args, n);
+    }
+
+    template<NodeType Type>
+    [[gnu::flatten]] auto Index(Backend::View<T, S> primal, int64_t result, Operon::Span<int64_t const> args) -> void
+    {
+        Dispatch::IndexedOp<Type, T, S>(primal, result, args);
+    }
+
+    struct Entries {
+        template<NodeType Type> static constexpr auto Function() -> Dispatch::Function<T, S> { return &Call<Type>; }
+        template<NodeType Type> static constexpr auto Derivative() -> Dispatch::Derivative<T, S> { return &Diff<Type>; }
+        template<NodeType Type> static constexpr auto Fused() -> Dispatch::CallableFused<T>
+        {
+            if constexpr (Dispatch::Fusable<Type>) { return &Fuse<Type>; } else { return nullptr; }
+        }
+        template<NodeType Type> static constexpr auto Indexed() -> Dispatch::IndexedFunction<T, S> { return &Index<Type>; }
+    };
+
+    constexpr IsaBuiltinTable Builtins = Dispatch::MakeBuiltins<T, S, Entries>();
+} // namespace
+} // namespace Operon::detail::isa
+
+#endif
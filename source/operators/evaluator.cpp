@@ -2,9 +2,12 @@
 // SPDX-FileCopyrightText: Copyright 2019-2023 Heal Research
 
 #include "operon/core/distance.hpp"
+#include "operon/error_metrics/sum_of_squared_errors.hpp"
 #include "operon/formatter/formatter.hpp"
+#include "operon/interpreter/dag_interpreter.hpp"
 #include "operon/interpreter/dispatch_table.hpp"
 #include "operon/interpreter/interpreter.hpp"
+#include "operon/interpreter/multi_interpreter.hpp"
 #include "operon/operators/evaluator.hpp"
 #include "operon/optimizer/likelihood/gaussian_likelihood.hpp"
 #include "operon/optimizer/optimizer.hpp"
@@ -13,6 +16,8 @@
 #include <operon/operon_export.hpp>
 #include <taskflow/taskflow.hpp>
 #include <chrono>
+#include <random>
+#include <optional>
 #include <type_traits>
 
 namespace Operon {
@@ -37,6 +42,109 @@ namespace Operon {
         return FitLeastSquaresImpl<double>(estimated, target);
     }
 
+    namespace {
+        // fitness from the model responses (optionally linearly scaled in place)
+        auto ComputeFitness(ErrorMetric const& error, bool scaling, Operon::Span<Operon::Scalar> estimated, Operon::Span<Operon::Scalar const> target) -> Operon::Scalar {
+            if (scaling) {
+                auto [a, b] = FitLeastSquaresImpl<Operon::Scalar>(estimated, target);
+                std::transform(estimated.begin(), estimated.end(), estimated.begin(), [a=a,b=b](auto x) { return a * x + b; });
+            }
+            ENSURE(estimated.size() >= target.size());
+            auto fit = static_cast<Operon::Scalar>(error(estimated, target));
+            if (!std::isfinite(fit)) {
+                fit = EvaluatorBase::ErrMax;
+            }
+            return fit;
+        }
+
+        // moments of the (prediction, target) pairs, accumulated one block of rows at a time: the sums of a
+        // block come from the simd accumulators of vstat and are merged with the pairwise update (chan et al.).
+        // they give the squared errors with or without the optimal linear scaling and the correlation,
+        // without storing the predictions. the unscaled SSE, MSE and RMSE only need the squared errors
+        using Moments = detail::FitnessMoments;
+
+        // the unscaled SSE, MSE and RMSE are computed from the squared errors alone
+        auto NeedsMoments(ErrorType type, bool scaling) -> bool {
+            return scaling || !(type == ErrorType::SSE || type == ErrorType::MSE || type == ErrorType::RMSE);
+        }
+
+        // the metrics which can be computed from the moments (all but the MAE)
+        auto SupportsMoments(ErrorType type) -> bool { return type != ErrorType::MAE; }
+
+        auto ComputeFitness(ErrorType type, bool scaling, Moments const& m) -> Operon::Scalar {
+            auto const n { m.Count };
+            auto const sse { scaling ? m.ScaledSse() : m.Sse };
+            double fit{0};
+            switch (type) {
+            case ErrorType::SSE: { fit = sse; break; }
+            case ErrorType::MSE: { fit = sse / n; break; }
+            case ErrorType::RMSE: { fit = std::sqrt(sse / n); break; }
+            case ErrorType::NMSE: { fit = m.Syy > 0 ? sse / m.Syy : 0.0; break; }
+            case ErrorType::R2: {
+                fit = m.Syy < std::numeric_limits<double>::epsilon() ? std::numeric_limits<double>::max() : sse / m.Syy - 1;
+                break;
+            }
+            case ErrorType::C2: { fit = -(m.Sxy * m.Sxy / (m.Sxx * m.Syy)); break; }
+            default: { throw std::runtime_error("unsupported error type"); }
+            }
+            auto result { static_cast<Operon::Scalar>(fit) };
+            if (!std::isfinite(result)) { result = EvaluatorBase::ErrMax; }
+            return result;
+        }
+
+        // evaluates one block of rows and adds it to the moments. the predictions are copied to the
+        // result when it spans the whole range, otherwise they are read from the root primal column
+        template<typename Interpreter>
+        auto AccumulateBlock(Interpreter const& interpreter, Operon::Range range, int64_t row, Operon::Span<Operon::Scalar> result, Operon::Span<Operon::Scalar const> target, Moments& m) -> int64_t {
+            constexpr int64_t S{ Interpreter::BatchSize };
+            auto const len { static_cast<int64_t>(range.Size()) };
+            auto const rem { std::min(S, len - row) };
+            interpreter.EvaluateBlock(range, row, result);
+
+            auto const primal { interpreter.Primal() };
+            auto const* x = std::ssize(result) == len
+                ? result.data() + row
+                : primal.data_handle() + (primal.extent(1) - 1) * S;
+            m.Add(x, target.data() + row, rem);
+            return rem;
+        }
+
+        // the fitness of stored predictions, from the moments of the same blocks as the fused evaluation
+        // (so both give the same result for the same predictions)
+        template<int64_t S>
+        auto ComputeFitness(ErrorType type, bool scaling, Operon::Span<Operon::Scalar const> estimated, Operon::Span<Operon::Scalar const> target) -> Operon::Scalar {
+            Moments m{ .Full = NeedsMoments(type, scaling) };
+            auto const len { std::ssize(target) };
+            for (auto row = 0L; row < len; row += S) {
+                m.Add(estimated.data() + row, target.data() + row, std::min(S, len - row));
+            }
+            return ComputeFitness(type, scaling, m);
+        }
+    } // namespace
+
+    auto detail::FitnessMoments::Add(Operon::Scalar const* x, Operon::Scalar const* y, int64_t n) -> void {
+        auto const nb { static_cast<double>(n) };
+        Sse += SumOfSquaredErrors(x, x + n, y);
+        if (Full) {
+            auto const s { vstat::bivariate::accumulate<Operon::Scalar>(x, x + n, y) };
+            auto const total { Count + nb };
+            auto const dx { s.mean_x - MeanX };
+            auto const dy { s.mean_y - MeanY };
+            auto const f { Count * nb / total };
+            Sxx += s.variance_x * nb + dx * dx * f;
+            Syy += s.variance_y * nb + dy * dy * f;
+            Sxy += s.covariance * nb + dx * dy * f;
+            MeanX += dx * nb / total;
+            MeanY += dy * nb / total;
+        }
+        Count += nb;
+    }
+
+    auto detail::FitnessMoments::ScaledSse() const -> double {
+        if (!std::isfinite(Sxx) || !std::isfinite(Sxy)) { return std::numeric_limits<double>::infinity(); }
+        return std::max(0.0, Syy - (Sxx > 0 ? Sxy * Sxy / Sxx : 0.0));
+    }
+
     template<> auto OPERON_EXPORT
     Evaluator<DefaultDispatch>::operator()(Operon::RandomGenerator& /*rng*/, Individual& ind, Operon::Span<Operon::Scalar> buf) const -> typename EvaluatorBase::ReturnType
     {
@@ -49,30 +157,248 @@ namespace Operon {
 
         auto& tree = ind.Genotype;
         auto const& dtable = GetDispatchTable();
-        TInterpreter const interpreter{dtable, dataset, tree};
+        TInterpreter interpreter{dtable, dataset, tree, LocalTape()};
+        interpreter.SetCache(cache_);
 
-        auto computeFitness = [&]() {
-            ++ResidualEvaluations;
+        // the sampled windows are evaluated one after the other into the buffer (or the worker's one)
+        if (Sampling()) {
+            auto const rows { sampleTarget_.size() };
             Operon::Vector<Operon::Scalar> estimatedValues;
-            if (buf.size() != trainingRange.Size()) {
-                estimatedValues.resize(trainingRange.Size());
-                buf = { estimatedValues.data(), estimatedValues.size() };
+            if (buf.size() < rows) {
+                auto* ws = LocalWorkspace();
+                auto& values = ws != nullptr ? ws->Sample : estimatedValues;
+                if (values.size() < rows) { values.resize(rows); }
+                buf = { values.data(), rows };
             }
-            auto coeff = tree.GetCoefficients();
-            interpreter.Evaluate(coeff, trainingRange, buf);
-            if (scaling_) {
-                auto [a, b] = FitLeastSquaresImpl<Operon::Scalar>(buf, targetValues);
-                std::transform(buf.begin(), buf.end(), buf.begin(), [a=a,b=b](auto x) { return a * x + b; });
+            auto offset { 0UL };
+            for (auto const& range : sample_) {
+                interpreter.Evaluate({}, range, buf.subspan(offset, range.Size()));
+                offset += range.Size();
             }
-            ENSURE(buf.size() >= targetValues.size());
-            return error_(buf, targetValues);
-        };
+            CountRows(rows);
+            ind.Approximate = true;
+            return typename EvaluatorBase::ReturnType{ ComputeFitness(error_, scaling_, buf.first(rows), sampleTarget_) };
+        }
+
+        // the approximate flag is only set here: a full evaluation leaves it to Promote (or to the
+        // MultiEvaluator), so that it is not cleared by another evaluator of the same individual
+        ++ResidualEvaluations;
+
+        // the fitness is accumulated while the blocks are evaluated, the predictions are never stored
+        auto const fused { fusedFitness_ && SupportsMoments(error_.Type()) };
+        if (fused && cache_ == nullptr) {
+            interpreter.Prepare({});
+            Moments m{ .Full = NeedsMoments(error_.Type(), scaling_) };
+            auto const len { static_cast<int64_t>(trainingRange.Size()) };
+            for (auto row = 0L; row < len;) {
+                row += AccumulateBlock(interpreter, trainingRange, row, {}, targetValues, m);
+            }
+            return typename EvaluatorBase::ReturnType{ ComputeFitness(error_.Type(), scaling_, m) };
+        }
+
+        Operon::Vector<Operon::Scalar> estimatedValues;
+        if (buf.size() != trainingRange.Size()) {
+            estimatedValues.resize(trainingRange.Size());
+            buf = { estimatedValues.data(), estimatedValues.size() };
+        }
+        // empty coefficients: the tape takes the weights directly from the tree nodes
+        interpreter.Evaluate({}, trainingRange, buf);
+        if (fused) {
+            return typename EvaluatorBase::ReturnType{ ComputeFitness<TInterpreter::BatchSize>(error_.Type(), scaling_, buf, targetValues) };
+        }
+        return typename EvaluatorBase::ReturnType{ ComputeFitness(error_, scaling_, buf, targetValues) };
+    }
+
+    template<> auto OPERON_EXPORT
+    Evaluator<DefaultDispatch>::Prepare(Operon::Span<Individual const> /*pop*/) const -> void
+    {
+        sample_.clear();
+        sampleTarget_.clear();
+        if (!(sampleFraction_ < 1)) { return; }
 
-        auto fit = static_cast<Operon::Scalar>(computeFitness());
-        if (!std::isfinite(fit)) {
-            fit = EvaluatorBase::ErrMax;
+        // one window per stratum, at a random position within the stratum
+        auto const& problem = GetProblem();
+        auto const range { problem.TrainingRange() };
+        auto const target { problem.TargetValues() };
+        auto const strata { std::min(sampleStrata_, range.Size()) };
+        for (auto i = 0UL; i < strata; ++i) {
+            auto const lo { range.Start() + (i * range.Size() / strata) };
+            auto const hi { range.Start() + ((i + 1) * range.Size() / strata) };
+            auto const len { std::clamp(static_cast<std::size_t>(std::ceil(sampleFraction_ * static_cast<double>(hi - lo))), 1UL, hi - lo) };
+            auto const start { lo + std::uniform_int_distribution<std::size_t>(0, hi - lo - len)(sampleRng_) };
+            sample_.emplace_back(start, start + len);
+            sampleTarget_.insert(sampleTarget_.end(), target.begin() + static_cast<int64_t>(start), target.begin() + static_cast<int64_t>(start + len));
+        }
+    }
+
+    template<> auto OPERON_EXPORT
+    Evaluator<DefaultDispatch>::EvaluateWithThreshold(Operon::RandomGenerator& rng, Individual& ind, Operon::Span<Operon::Scalar> buf, Operon::Scalar threshold) const -> typename EvaluatorBase::ReturnType
+    {
+        auto const type { error_.Type() };
+        auto const squared { type == ErrorType::SSE || type == ErrorType::MSE || type == ErrorType::RMSE || type == ErrorType::NMSE };
+        // derived evaluators may compute a different fitness in operator()
+        if (!earlyAbandon_ || !squared || !(threshold < ErrMax) || !SupportsGroupEvaluation() || Sampling()) {
+            return (*this)(rng, ind, buf);
+        }
+
+        auto const& problem = GetProblem();
+        auto const& dataset = problem.GetDataset();
+        auto trainingRange = problem.TrainingRange();
+        auto targetValues = dataset.GetValues(problem.TargetVariable()).subspan(trainingRange.Start(), trainingRange.Size());
+        auto const n { static_cast<double>(trainingRange.Size()) };
+
+        // the error metric is the sum of squared errors divided by norm (and the root of it for the RMSE)
+        auto norm { type == ErrorType::SSE ? 1.0 : n };
+        if (type == ErrorType::NMSE) {
+            auto const var { vstat::univariate::accumulate<Operon::Scalar>(targetValues.begin(), targetValues.end()).variance };
+            if (!(var > 0)) { return (*this)(rng, ind, buf); }
+            norm *= var;
+        }
+        auto limit { static_cast<double>(threshold) };
+        if (type == ErrorType::RMSE) { limit = threshold < 0 ? -1.0 : limit * limit; }
+        limit *= norm;
+        // tolerance for the rounding differences with the final error computation
+        constexpr double tolerance{1e-5};
+        limit += std::abs(limit) * tolerance;
+
+        ++CallCount;
+        auto const fused { fusedFitness_ };
+        Operon::Vector<Operon::Scalar> estimatedValues;
+        if (fused) {
+            buf = {};
+        } else if (buf.size() != trainingRange.Size()) {
+            estimatedValues.resize(trainingRange.Size());
+            buf = { estimatedValues.data(), estimatedValues.size() };
+        }
+
+        TInterpreter const interpreter{GetDispatchTable(), dataset, ind.Genotype, LocalTape()};
+        interpreter.Prepare({});
+
+        // running moments (the scaled error is a lower bound of the final one). without the scaling, the
+        // squared errors are enough for the bound
+        Moments m{ .Full = NeedsMoments(type, scaling_) };
+        auto const len { static_cast<int64_t>(trainingRange.Size()) };
+        for (auto row = 0L; row < len;) {
+            row += AccumulateBlock(interpreter, trainingRange, row, buf, targetValues, m);
+            if (row == len) { break; }
+
+            auto const bound { scaling_ ? m.ScaledSse() : m.Sse };
+            if (std::isfinite(bound) && bound <= limit) { continue; }
+
+            // abandon: the rows evaluated so far count towards the budget as fractions of an evaluation
+            CountRows(static_cast<std::size_t>(row));
+            ++abandoned_;
+
+            if (!std::isfinite(bound)) { return typename EvaluatorBase::ReturnType{ ErrMax }; }
+            auto const fit { type == ErrorType::RMSE ? std::sqrt(bound / norm) : bound / norm };
+            auto const lower { std::nextafter(threshold, ErrMax) };
+            return typename EvaluatorBase::ReturnType{ std::max(static_cast<Operon::Scalar>(fit), lower) };
+        }
+
+        ++ResidualEvaluations;
+        if (fused) {
+            return typename EvaluatorBase::ReturnType{ ComputeFitness(type, scaling_, m) };
+        }
+        return typename EvaluatorBase::ReturnType{ ComputeFitness(error_, scaling_, buf, targetValues) };
+    }
+
+    template<> auto OPERON_EXPORT
+    Evaluator<DefaultDispatch>::Evaluate(Operon::Span<Operon::RandomGenerator> rngs, Operon::Span<Individual> individuals, Operon::Span<Operon::Scalar> buf) const -> void
+    {
+        auto const& problem = GetProblem();
+        auto const& dataset = problem.GetDataset();
+        auto trainingRange = problem.TrainingRange();
+        auto const n { trainingRange.Size() };
+
+        // derived evaluators (e.g. the information criteria) compute their fitness in operator(),
+        // the subtree cache and the row sample are used by the tree-wise evaluation
+        auto const group = std::min(individuals.size(), buf.size() / n);
+        if (!SupportsGroupEvaluation() || group < 2 || cache_ != nullptr || Sampling()) {
+            EvaluatorBase::Evaluate(rngs, individuals, buf);
+            return;
+        }
+
+        auto targetValues = dataset.GetValues(problem.TargetVariable()).subspan(trainingRange.Start(), n);
+
+        // the interpreter (and the tapes of the group) of the calling worker are reused across calls
+        std::optional<Operon::MultiInterpreter<Operon::Scalar, DefaultDispatch>> local;
+        auto* ws = LocalWorkspace();
+        auto& multi = ws != nullptr ? ws->Group : local;
+        if (!multi || &multi->GetDataset() != &dataset || &multi->GetDispatchTable() != &GetDispatchTable()) {
+            multi.emplace(GetDispatchTable(), dataset);
+        }
+        auto& interpreter = *multi;
+        // the predictions are stored anyway, the fused mode only decides how the fitness is computed
+        auto const fused { fusedFitness_ && SupportsMoments(error_.Type()) };
+
+        for (auto i = 0UL; i < individuals.size(); i += group) {
+            auto inds = individuals.subspan(i, std::min(group, individuals.size() - i));
+            interpreter.Evaluate(inds, trainingRange, buf, &Individual::Genotype);
+            for (auto j = 0UL; j < inds.size(); ++j) {
+                auto estimated { buf.subspan(j * n, n) };
+                inds[j].Fitness = { fused
+                    ? ComputeFitness<TInterpreter::BatchSize>(error_.Type(), scaling_, estimated, targetValues)
+                    : ComputeFitness(error_, scaling_, estimated, targetValues) };
+            }
+            CallCount += inds.size();
+            ResidualEvaluations += inds.size();
+        }
+    }
+
+    template<> auto OPERON_EXPORT
+    DagEvaluator<DefaultDispatch>::Evaluate(Operon::Span<Operon::RandomGenerator> rngs, Operon::Span<Individual> individuals, Operon::Span<Operon::Scalar> buf) const -> void
+    {
+        auto const& problem = GetProblem();
+        auto const& dataset = problem.GetDataset();
+        auto trainingRange = problem.TrainingRange();
+        auto const n { trainingRange.Size() };
+
+        auto const type { GetErrorMetric().Type() };
+        auto const fused { this->FusedFitness() && SupportsMoments(type) };
+        // without the moments the predictions are stored, so the groups are limited by the buffer
+        auto const group = fused ? individuals.size() : std::min(individuals.size(), buf.size() / n);
+        if (group < 2 || GetSubtreeCache() != nullptr || this->Sampling()) {
+            EvaluatorBase::Evaluate(rngs, individuals, buf);
+            return;
+        }
+
+        auto targetValues = dataset.GetValues(problem.TargetVariable()).subspan(trainingRange.Start(), n);
+
+        // the interpreter and the moments of the calling worker are reused across calls
+        Workspace local;
+        auto* pooled = workspaces_.Local();
+        auto& ws = pooled != nullptr ? *pooled : local;
+        if (!ws.Interpreter || &ws.Interpreter->GetDataset() != &dataset || &ws.Interpreter->GetDispatchTable() != &GetDispatchTable()) {
+            ws.Interpreter.emplace(GetDispatchTable(), dataset);
+        }
+        auto& interpreter = *ws.Interpreter;
+        auto& moments = ws.Moments;
+
+        for (auto i = 0UL; i < individuals.size(); i += group) {
+            auto inds = individuals.subspan(i, std::min(group, individuals.size() - i));
+            interpreter.Compile(inds, &Individual::Genotype);
+            if (fused) {
+                // the same blocks of rows as the tree-wise evaluation, hence the same fitness
+                moments.assign(inds.size(), Moments{ .Full = NeedsMoments(type, LinearScaling()) });
+                interpreter.EvaluateBlocks(trainingRange, [&](int64_t row, int64_t rem) {
+                    for (auto j = 0UL; j < inds.size(); ++j) {
+                        moments[j].Add(interpreter.Output(j).data(), targetValues.data() + row, rem);
+                    }
+                });
+                for (auto j = 0UL; j < inds.size(); ++j) {
+                    inds[j].Fitness = { ComputeFitness(type, LinearScaling(), moments[j]) };
+                }
+            } else {
+                interpreter.Evaluate(trainingRange, buf);
+                for (auto j = 0UL; j < inds.size(); ++j) {
+                    inds[j].Fitness = { ComputeFitness(GetErrorMetric(), LinearScaling(), buf.subspan(j * n, n), targetValues) };
+                }
+            }
+            totalNodes_ += interpreter.TotalNodes();
+            uniqueNodes_ += interpreter.UniqueNodes();
+            CallCount += inds.size();
+            ResidualEvaluations += inds.size();
         }
-        return typename EvaluatorBase::ReturnType{ fit };
     }
 
     auto DiversityEvaluator::Prepare(Operon::Span<Operon::Individual const> pop) const -> void {
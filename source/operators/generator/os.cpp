@@ -5,6 +5,11 @@
 #include "operon/core/comparison.hpp"
 
 namespace Operon {
+    namespace {
+        auto ComparisonValue(Operon::Scalar f1, Operon::Scalar f2, double factor) -> Operon::Scalar {
+            return std::max(f1, f2) - static_cast<Operon::Scalar>(factor) * std::abs(f1 - f2);
+        }
+    } // namespace
 
     auto OffspringSelectionGenerator::operator()(Operon::RandomGenerator& random, double pCrossover, double pMutation, double pLocal, Operon::Span<Operon::Scalar> buf) const -> std::optional<Individual>
     {
@@ -15,7 +20,7 @@ namespace Operon {
             for (size_t i = 0; i < q.Size(); ++i) {
                 auto f1 = (*res.Parent1)[i];
                 auto f2 = (*res.Parent2)[i];
-                q[i] = std::max(f1, f2) - static_cast<Operon::Scalar>(comparisonFactor_) * std::abs(f1 - f2);
+                q[i] = ComparisonValue(f1, f2, comparisonFactor_);
                 accept = Operon::ParetoDominance{}(res.Child->Fitness, q.Fitness) != Dominance::Right;
             }
         } else {
@@ -24,4 +29,13 @@ namespace Operon {
         return accept ? res.Child : std::nullopt;
     }
 
+    auto OffspringSelectionGenerator::RejectionThreshold(RecombinationResult const& res) const -> Operon::Scalar
+    {
+        if (Evaluator().ObjectiveCount() != 1) {
+            return OffspringGeneratorBase::RejectionThreshold(res);
+        }
+        auto const f1 = res.Parent1->Fitness[0];
+        return res.Parent2 ? ComparisonValue(f1, res.Parent2->Fitness[0], comparisonFactor_) : f1;
+    }
+
 } // namespace Operon
@@ -3,16 +3,28 @@
 
 #include "operon/operators//local_search.hpp"
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <numeric>
+
+#include "operon/core/individual.hpp"
 #include "operon/core/tree.hpp"
+#include "operon/operators/evaluator.hpp"
+#include "operon/optimizer/coefficient_cache.hpp"
 #include "operon/optimizer/optimizer.hpp"
 
 namespace Operon {
 
 auto CoefficientOptimizer::operator()(Operon::RandomGenerator& rng, Operon::Tree& tree) const -> OptimizerSummary {
+    return (*this)(rng, tree, optimizer_.get().Iterations());
+}
+
+auto CoefficientOptimizer::operator()(Operon::RandomGenerator& rng, Operon::Tree& tree, std::size_t iterations) const -> OptimizerSummary {
     OptimizerSummary summary;
     auto const& optimizer = optimizer_.get();
-    if (optimizer.Iterations() > 0) {
-        summary = optimizer.Optimize(rng, tree);
+    if (iterations > 0) {
+        summary = cache_ == nullptr ? optimizer.Optimize(rng, tree, iterations) : Optimize(rng, tree, iterations);
 
         if (std::bernoulli_distribution(lamarckianProbability_)(rng) && summary.Success) {
             tree.SetCoefficients(summary.FinalParameters);
@@ -20,4 +32,94 @@ auto CoefficientOptimizer::operator()(Operon::RandomGenerator& rng, Operon::Tree
     }
     return summary;
 }
-} // namespace Operon
\ No newline at end of file
+
+auto CoefficientOptimizer::Optimize(Operon::RandomGenerator& rng, Operon::Tree const& tree, std::size_t iterations) const -> OptimizerSummary {
+    auto const key = CoefficientCache::MakeKey(tree);
+    auto entry = cache_->Find(key);
+
+    OptimizerSummary summary;
+    if (!entry) {
+        summary = optimizer_.get().Optimize(rng, tree, iterations);
+    } else if (entry->Converged) {
+        summary.InitialParameters = tree.GetCoefficients();
+        summary.FinalParameters = std::move(entry->Coefficients);
+        summary.InitialCost = summary.FinalCost = entry->Cost;
+        summary.Success = summary.Skipped = true;
+        return summary;
+    } else {
+        auto start = tree;
+        start.SetCoefficients(entry->Coefficients);
+        summary = optimizer_.get().Optimize(rng, start, iterations);
+        // a solve that does not improve on the cached coefficients is not applied to the tree
+        summary.Success = std::isfinite(summary.FinalCost) && summary.FinalCost <= summary.InitialCost;
+        summary.WarmStart = true;
+    }
+    cache_->Update(key, summary.FinalParameters, summary.FinalCost);
+    return summary;
+}
+
+auto CoefficientOptimizer::SetWorkers(std::size_t count, std::function<int()> const& workerId) const -> void {
+    optimizer_.get().SetWorkers(count, workerId);
+}
+
+auto LocalSearchScheduler::Select(Operon::Span<Individual const> offspring) const -> std::vector<bool> {
+    // the children without a first pass (their local search rate is not set) are not refined
+    std::vector<std::size_t> candidates;
+    for (auto i = 0UL; i < offspring.size(); ++i) {
+        if (offspring[i][0] < EvaluatorBase::ErrMax && !std::isnan(offspring[i].LocalSearchRate)) { candidates.push_back(i); }
+    }
+
+    std::vector<bool> selected(offspring.size(), false);
+    auto const best = policy_ == LocalSearchPolicy::Best || policy_ == LocalSearchPolicy::BestOrImproving;
+    auto const improving = policy_ == LocalSearchPolicy::Improving || policy_ == LocalSearchPolicy::BestOrImproving;
+
+    if (policy_ == LocalSearchPolicy::Uniform) {
+        for (auto i : candidates) { selected[i] = true; }
+    }
+    if (best) {
+        auto const n = std::min(candidates.size(), static_cast<std::size_t>(std::ceil(fraction_ * static_cast<double>(candidates.size()))));
+        std::ranges::partial_sort(candidates, candidates.begin() + static_cast<std::ptrdiff_t>(n), std::less{}, [&](auto i) { return offspring[i][0]; });
+        for (auto i = 0UL; i < n; ++i) { selected[candidates[i]] = true; }
+    }
+    if (improving) {
+        for (auto i : candidates) { selected[i] = selected[i] || offspring[i].LocalSearchRate >= threshold_; }
+    }
+
+    candidates_ = candidates.size();
+    refined_ = static_cast<std::size_t>(std::ranges::count(selected, true));
+    time_ = 0;
+    gain_ = 0;
+    return selected;
+}
+
+auto LocalSearchScheduler::Refine(Operon::RandomGenerator& rng, Individual& child, Operon::Span<Operon::Scalar> buf) const -> void {
+    auto const t0 = std::chrono::steady_clock::now();
+    auto const& evaluator = evaluator_.get();
+    auto const before = child[0];
+    auto const coefficients = child.Genotype.GetCoefficients();
+
+    auto summary = optimizer_.get()(rng, child.Genotype, secondPass_);
+    evaluator.ResidualEvaluations += summary.FunctionEvaluations;
+    evaluator.JacobianEvaluations += summary.JacobianEvaluations;
+    evaluator.CoefficientCacheHits += static_cast<unsigned long>(summary.WarmStart || summary.Skipped);
+    evaluator.CoefficientCacheSkips += static_cast<unsigned long>(summary.Skipped);
+    child.LocalSearchRate = Rate(summary);
+
+    // the genotype is unchanged when the solve was skipped or its result was not applied, the fitness still holds
+    if (child.Genotype.GetCoefficients() != coefficients) {
+        child.Fitness = evaluator(rng, child, buf);
+        for (auto& v : child.Fitness) {
+            if (!std::isfinite(v)) { v = EvaluatorBase::ErrMax; }
+        }
+    }
+    auto const t1 = std::chrono::steady_clock::now();
+    time_ += std::chrono::duration<double>(t1 - t0).count();
+    gain_ += static_cast<double>(before) - static_cast<double>(child[0]);
+}
+
+auto LocalSearchScheduler::Rate(OptimizerSummary const& summary) -> Operon::Scalar {
+    if (!(std::isfinite(summary.InitialCost) && summary.InitialCost > 0 && std::isfinite(summary.FinalCost))) { return 0; }
+    // some optimizers do not report the iterations
+    return (summary.InitialCost - summary.FinalCost) / summary.InitialCost / static_cast<Operon::Scalar>(std::max(summary.Iterations, 1));
+}
+} // namespace Operon
@@ -0,0 +1,236 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2024 Heal Research
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+#include "operon/core/dataset.hpp"
+#include "operon/core/individual.hpp"
+#include "operon/core/problem.hpp"
+#include "operon/interpreter/interpreter.hpp"
+#include "operon/interpreter/multi_interpreter.hpp"
+#include "operon/interpreter/subtree_cache.hpp"
+#include "operon/operators/creator.hpp"
+#include "operon/operators/evaluator.hpp"
+#include "operon/optimizer/optimizer.hpp"
+
+namespace {
+    // allocations of the calling thread. the replacement of the global operator new applies to the whole
+    // executable: on ELF platforms it also interposes the calls of the shared libraries (operon and the
+    // standard library), so everything the thread allocates is counted. the test has its own executable so
+    // that the replacement does not change the allocations of the other tests
+    thread_local std::size_t allocationCount{0}; // NOLINT
+} // namespace
+
+auto operator new(std::size_t size) -> void*
+{
+    ++allocationCount;
+    if (auto* ptr = std::malloc(size == 0 ? 1 : size)) { return ptr; } // NOLINT
+    throw std::bad_alloc{};
+}
+
+auto operator delete(void* ptr) noexcept -> void { std::free(ptr); } // NOLINT
+auto operator delete(void* ptr, std::size_t /*size*/) noexcept -> void { std::free(ptr); } // NOLINT
+
+namespace Operon::Test {
+
+namespace {
+    struct Fixture {
+        Dataset Data{"./data/Poly-10.csv", /*hasHeader=*/true};
+        Range Rows{0, Data.Rows<std::size_t>()};
+        PrimitiveSet Primitives{PrimitiveSet::Arithmetic | NodeType::Exp | NodeType::Sin};
+        RandomGenerator Random{0};
+        DefaultDispatch Table;
+
+        auto Trees(std::size_t n) -> std::vector<Tree>
+        {
+            BalancedTreeCreator creator{Primitives, Data.VariableHashes()};
+            std::vector<Tree> trees;
+            for (auto i = 0UL; i < n; ++i) {
+                trees.push_back(creator(Random, 20, 10, 20));
+                for (auto& node : trees.back().Nodes()) { node.Optimize = node.IsLeaf(); }
+            }
+            return trees;
+        }
+    };
+} // namespace
+
+TEST_CASE("Steady-state allocations of the interpreter" * doctest::test_suite("allocations"))
+{
+    Fixture f;
+    auto const& ds = f.Data;
+    auto const range = f.Rows;
+    auto const& dtable = f.Table;
+    auto target = ds.GetValues("Y");
+    using TInterpreter = Interpreter<Operon::Scalar, DefaultDispatch>;
+
+    auto const trees = f.Trees(10);
+    std::vector<std::vector<Operon::Scalar>> coefficients;
+    for (auto const& tree : trees) { coefficients.push_back(tree.GetCoefficients()); }
+    auto const np { std::ranges::max(coefficients, std::less{}, [](auto const& c) { return c.size(); }).size() };
+
+    // the buffers of the callers
+    std::vector<Operon::Scalar> result(range.Size());
+    std::vector<Operon::Scalar> jacobian(range.Size() * np);
+    std::vector<double> jtj(np * np);
+    std::vector<double> jtr(np);
+    std::vector<Operon::Scalar> group(trees.size() * range.Size());
+
+    // the per-worker memory (see EvaluatorBase::SetWorkers)
+    TapePool<Operon::Scalar, DefaultDispatch> pool;
+    pool.Configure(1, []() { return 0; });
+    SubtreeCache<Operon::Scalar> cache;
+    MultiInterpreter<Operon::Scalar, DefaultDispatch> multi{dtable, ds};
+
+    auto run = [&]() {
+        for (auto i = 0UL; i < trees.size(); ++i) {
+            Operon::Span<Operon::Scalar const> coeff{ coefficients[i] };
+            auto const p { coeff.size() };
+            TInterpreter interpreter{dtable, ds, trees[i], pool.Local()};
+            interpreter.Evaluate(coeff, range, result);
+            interpreter.Jac(coeff, range, { jacobian.data(), range.Size() * p });
+            interpreter.JacFwd(coeff, range, { jacobian.data(), range.Size() * p });
+            interpreter.JacRev(coeff, range, { jacobian.data(), range.Size() * p });
+            (void) interpreter.NormalEquations(coeff, range, target.subspan(range.Start(), range.Size()), { jtj.data(), p * p }, { jtr.data(), p });
+
+            TInterpreter cached{dtable, ds, trees[i], pool.Local()};
+            cached.SetCache(&cache);
+            cached.Evaluate({}, range, result);
+        }
+        multi.Evaluate(trees, range, group);
+    };
+
+    // the first round grows the buffers (and fills the cache), the next ones only reuse them
+    run();
+    auto const before { allocationCount };
+    run();
+    CHECK(allocationCount == before);
+    CHECK(cache.Hits() >= trees.size());
+}
+
+TEST_CASE("Steady-state allocations of the subtree cache" * doctest::test_suite("allocations"))
+{
+    Fixture f;
+    auto const range = f.Rows;
+    using TInterpreter = Interpreter<Operon::Scalar, DefaultDispatch>;
+
+    // room for a few outputs per shard: the cache is full after the first rounds, then every new output
+    // evicts an older one and reuses its buffer
+    constexpr std::size_t outputsPerShard{16};
+    SubtreeCache<Operon::Scalar> cache{SubtreeCache<Operon::Scalar>::ShardCount * outputsPerShard * range.Size() * sizeof(Operon::Scalar)};
+    TapePool<Operon::Scalar, DefaultDispatch> pool;
+    pool.Configure(1, []() { return 0; });
+    std::vector<Operon::Scalar> result(range.Size());
+
+    // every round evaluates new trees: all the weights change, so none of the subtree outputs is cached
+    auto trees = f.Trees(10);
+    auto run = [&]() {
+        for (auto& tree : trees) {
+            for (auto& node : tree.Nodes()) { node.Value *= Operon::Scalar{1.1}; } // NOLINT
+            TInterpreter interpreter{f.Table, f.Data, tree, pool.Local()};
+            interpreter.SetCache(&cache);
+            interpreter.Evaluate({}, range, result);
+        }
+    };
+
+    constexpr auto warmup{10};
+    for (auto i = 0; i < warmup; ++i) { run(); }
+    REQUIRE(cache.Evictions() > 0);
+    auto const misses { cache.Misses() };
+    auto const before { allocationCount };
+    run();
+    CHECK(cache.Misses() > misses);
+    CHECK(allocationCount == before);
+}
+
+TEST_CASE("Steady-state allocations of the evaluator" * doctest::test_suite("allocations"))
+{
+    Fixture f;
+    Problem problem{f.Data, f.Rows, f.Rows};
+    problem.SetTarget("Y");
+
+    Evaluator<DefaultDispatch> evaluator{problem, f.Table};
+    evaluator.SetWorkers(1, []() { return 0; });
+
+    std::vector<Individual> individuals;
+    for (auto& tree : f.Trees(10)) {
+        individuals.emplace_back();
+        individuals.back().Genotype = std::move(tree);
+    }
+    std::vector<Operon::Scalar> buffer(f.Rows.Size());
+
+    auto run = [&]() {
+        for (auto& ind : individuals) { (void) evaluator(f.Random, ind, buffer); }
+    };
+    run();
+    auto const before { allocationCount };
+    run();
+    // only the returned fitness vectors
+    CHECK(allocationCount - before == individuals.size());
+}
+
+TEST_CASE("Steady-state allocations of the coefficient optimizer" * doctest::test_suite("allocations"))
+{
+    Fixture f;
+    Problem problem{f.Data, f.Rows, f.Rows};
+    problem.SetTarget("Y");
+    auto const tree = f.Trees(1).front();
+
+    using Optimizer = LevenbergMarquardtOptimizer<DefaultDispatch, OptimizerType::Tiny>;
+    Optimizer pooled{f.Table, problem};
+    pooled.SetWorkers(1, []() { return 0; });
+    Optimizer unpooled{f.Table, problem};
+
+    auto count = [&](Optimizer const& optimizer) {
+        auto const before { allocationCount };
+        (void) optimizer.Optimize(f.Random, tree);
+        return allocationCount - before;
+    };
+
+    // the solver allocates its own state (parameters, residuals and jacobian) for every call, the
+    // interpreter reuses the worker tape: the count is the same for every call after the first one and
+    // lower than without a tape pool
+    (void) count(pooled);
+    auto const steady { count(pooled) };
+    CHECK(count(pooled) == steady);
+    CHECK(steady < count(unpooled));
+}
+
+TEST_CASE("Steady-state allocations of the frozen subtrees" * doctest::test_suite("allocations"))
+{
+    Fixture f;
+    Problem problem{f.Data, f.Rows, f.Rows};
+    problem.SetTarget("Y");
+    // only some of the leaves are optimized, so that the other subtrees are frozen
+    auto tree = f.Trees(1).front();
+    auto i { 0 };
+    for (auto& node : tree.Nodes()) { node.Optimize = node.IsLeaf() && i++ % 3 == 0; }
+
+    using Optimizer = LevenbergMarquardtOptimizer<DefaultDispatch, OptimizerType::Tiny>;
+    Optimizer plain{f.Table, problem};
+    plain.SetWorkers(1, []() { return 0; });
+    Optimizer frozen{f.Table, problem};
+    frozen.SetWorkers(1, []() { return 0; });
+    // freezing is opt-in
+    CHECK(plain.FreezeBudget() == 0);
+    frozen.SetFreezeBudget(Interpreter<Operon::Scalar, DefaultDispatch>::DefaultFreezeBudget);
+
+    auto count = [&](Optimizer const& optimizer) {
+        auto const before { allocationCount };
+        (void) optimizer.Optimize(f.Random, tree);
+        return allocationCount - before;
+    };
+
+    // the worker tape keeps the buffer of the frozen outputs across the local searches
+    (void) count(plain);
+    (void) count(frozen);
+    auto const steady { count(frozen) };
+    CHECK(count(frozen) == steady);
+    CHECK(steady == count(plain));
+}
+
+} // namespace Operon::Test
@@ -0,0 +1,40 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2024 Heal Research
+
+#ifndef OPERON_TEST_BENCHMARK_BACKEND_HPP
+#define OPERON_TEST_BENCHMARK_BACKEND_HPP
+
+#include <array>
+#include <cstdint>
+
+#include "operon/core/node.hpp"
+#include "operon/interpreter/dispatch_table.hpp"
+
+namespace Operon::Benchmark {
+    template<typename T>
+    using Function = Dispatch::Function<T, Dispatch::DefaultBatchSize<T>>;
+
+    // the forward kernels of the built-in primitives, indexed like the node types (nullptr for the nullary symbols)
+    template<typename T>
+    using Functions = std::array<Function<T>, NodeTypes::Count>;
+
+    struct Kernels {
+        Functions<float> Float;
+        Functions<double> Double;
+
+        template<typename T>
+        [[nodiscard]] auto Get() const -> Functions<T> const& {
+            if constexpr (std::is_same_v<T, float>) { return Float; } else { return Double; }
+        }
+    };
+
+    // the benchmarked math backends: the header-only ones (see MathBackend) and vdt, which needs its own library
+    enum class MathLibrary : uint8_t { Eigen, Stl, Eve, Vdt, Blaze, Fastor, FastV1, FastV2, FastV3 };
+
+    // one translation unit per math backend, generated from backend.cpp.in (see test/CMakeLists.txt). the
+    // compiled backends are listed in the generated operon_benchmark_backends.hpp
+    template<MathLibrary L>
+    auto CompiledKernels() -> Kernels const&;
+} // namespace Operon::Benchmark
+
+#endif
@@ -0,0 +1,195 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2024 Heal Research
+
+// throughput and accuracy of the built-in primitives for every compiled math backend, in single and double
+// precision. the accuracy is measured in units in the last place (ulp) against a long double reference.
+// usage: operon_backend_benchmark [elements], the results are written to stdout as json (and to stderr as a table)
+
+#define ANKERL_NANOBENCH_IMPLEMENT
+#include "../thirdparty/nanobench.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <fmt/core.h>
+#include <limits>
+#include <optional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "backend.hpp"
+#include "operon/core/tree.hpp"
+#include "operon/interpreter/tape.hpp"
+#include "operon_benchmark_backends.hpp"
+
+namespace Operon::Benchmark {
+namespace {
+    using Real = long double;
+
+    struct Domain {
+        Real Min;
+        Real Max;
+    };
+
+    // the n-ary primitives are evaluated with two arguments, the first one is in the First domain
+    struct Primitive {
+        NodeType Type;
+        std::string_view Name;
+        Domain First;
+        Domain Second;
+        Real (*Reference)(Real, Real);
+    };
+
+    // typical inputs of the primitives during the search (e.g. standardized variables scaled by coefficients),
+    // mostly inside the domain of definition of the function
+    constexpr Domain Default{-10, 10};
+    constexpr Domain None{0, 0};
+
+    const std::array Primitives {
+        Primitive{ NodeType::Add,     "add",     Default, Default, [](Real a, Real b) { return a + b; } },
+        Primitive{ NodeType::Mul,     "mul",     Default, Default, [](Real a, Real b) { return a * b; } },
+        Primitive{ NodeType::Sub,     "sub",     Default, Default, [](Real a, Real b) { return a - b; } },
+        Primitive{ NodeType::Div,     "div",     Default, Default, [](Real a, Real b) { return a / b; } },
+        Primitive{ NodeType::Fmin,    "fmin",    Default, Default, [](Real a, Real b) { return std::fmin(a, b); } },
+        Primitive{ NodeType::Fmax,    "fmax",    Default, Default, [](Real a, Real b) { return std::fmax(a, b); } },
+        Primitive{ NodeType::Aq,      "aq",      Default, Default, [](Real a, Real b) { return a / std::sqrt(1 + b * b); } },
+        Primitive{ NodeType::Pow,     "pow",     {Real{1e-2}, 10}, {-3, 3}, [](Real a, Real b) { return std::pow(a, b); } },
+        Primitive{ NodeType::Abs,     "abs",     Default, None, [](Real a, Real /*unused*/) { return std::abs(a); } },
+        Primitive{ NodeType::Acos,    "acos",    {-1, 1}, None, [](Real a, Real /*unused*/) { return std::acos(a); } },
+        Primitive{ NodeType::Asin,    "asin",    {-1, 1}, None, [](Real a, Real /*unused*/) { return std::asin(a); } },
+        Primitive{ NodeType::Atan,    "atan",    Default, None, [](Real a, Real /*unused*/) { return std::atan(a); } },
+        Primitive{ NodeType::Cbrt,    "cbrt",    {-100, 100}, None, [](Real a, Real /*unused*/) { return std::cbrt(a); } },
+        Primitive{ NodeType::Ceil,    "ceil",    Default, None, [](Real a, Real /*unused*/) { return std::ceil(a); } },
+        Primitive{ NodeType::Cos,     "cos",     Default, None, [](Real a, Real /*unused*/) { return std::cos(a); } },
+        Primitive{ NodeType::Cosh,    "cosh",    Default, None, [](Real a, Real /*unused*/) { return std::cosh(a); } },
+        Primitive{ NodeType::Exp,     "exp",     Default, None, [](Real a, Real /*unused*/) { return std::exp(a); } },
+        Primitive{ NodeType::Floor,   "floor",   Default, None, [](Real a, Real /*unused*/) { return std::floor(a); } },
+        Primitive{ NodeType::Log,     "log",     {Real{1e-3}, 100}, None, [](Real a, Real /*unused*/) { return std::log(a); } },
+        Primitive{ NodeType::Logabs,  "logabs",  {-100, 100}, None, [](Real a, Real /*unused*/) { return std::log(std::abs(a)); } },
+        Primitive{ NodeType::Log1p,   "log1p",   {Real{-0.999}, 100}, None, [](Real a, Real /*unused*/) { return std::log1p(a); } },
+        Primitive{ NodeType::Sin,     "sin",     Default, None, [](Real a, Real /*unused*/) { return std::sin(a); } },
+        Primitive{ NodeType::Sinh,    "sinh",    Default, None, [](Real a, Real /*unused*/) { return std::sinh(a); } },
+        Primitive{ NodeType::Sqrt,    "sqrt",    {0, 100}, None, [](Real a, Real /*unused*/) { return std::sqrt(a); } },
+        Primitive{ NodeType::Sqrtabs, "sqrtabs", {-100, 100}, None, [](Real a, Real /*unused*/) { return std::sqrt(std::abs(a)); } },
+        Primitive{ NodeType::Tan,     "tan",     {Real{-1.5}, Real{1.5}}, None, [](Real a, Real /*unused*/) { return std::tan(a); } },
+        Primitive{ NodeType::Tanh,    "tanh",    Default, None, [](Real a, Real /*unused*/) { return std::tanh(a); } },
+        Primitive{ NodeType::Square,  "square",  Default, None, [](Real a, Real /*unused*/) { return a * a; } },
+    };
+
+    struct Result {
+        double NanosecondsPerElement;
+        double GigabytesPerSecond;
+        double MaxUlp;
+        double MeanUlp;
+        std::size_t NonFinite; // elements which are finite in only one of the result and the reference
+    };
+
+    // the error of value in units in the last place of the reference rounded to T, nullopt if only one of them is finite
+    template<typename T>
+    auto UlpError(T value, Real reference) -> std::optional<double>
+    {
+        auto const r = static_cast<T>(reference);
+        if (!std::isfinite(r) || !std::isfinite(value)) {
+            if ((std::isnan(r) && std::isnan(value)) || r == value) { return 0.0; }
+            return std::nullopt;
+        }
+        auto const ulp = static_cast<Real>(std::nextafter(std::abs(r), std::numeric_limits<T>::infinity()) - std::abs(r));
+        return static_cast<double>(std::abs(static_cast<Real>(value) - reference) / ulp);
+    }
+
+    template<typename T>
+    auto Measure(Function<T> function, Primitive const& primitive, std::size_t elements, Operon::RandomGenerator& rng) -> Result
+    {
+        constexpr auto S = Dispatch::DefaultBatchSize<T>;
+        auto const unary = Node(primitive.Type).Arity == 1;
+
+        // the arguments and the result of a batch are adjacent columns of the primal buffer, as in the interpreter
+        std::vector<Node> nodes{ Node(NodeType::Variable), Node(primitive.Type) };
+        if (!unary) { nodes.insert(nodes.begin(), Node(NodeType::Variable)); }
+        nodes = Tree(nodes).UpdateNodes().Nodes();
+
+        auto const cols = nodes.size();
+        auto const batches = (elements + S - 1) / S;
+        auto buffer = detail::AllocateAligned<T, Backend::DefaultAlignment>(batches * cols * S);
+        auto view = [&](std::size_t b) { return Backend::View<T, S>(buffer.get() + b * cols * S, S, static_cast<int>(cols)); };
+
+        // the first argument is the child closest to the parent
+        std::uniform_real_distribution<T> first(static_cast<T>(primitive.First.Min), static_cast<T>(primitive.First.Max));
+        std::uniform_real_distribution<T> second(static_cast<T>(primitive.Second.Min), static_cast<T>(primitive.Second.Max));
+        for (auto b = 0UL; b < batches; ++b) {
+            auto* p = view(b).data_handle();
+            std::ranges::generate_n(p + (cols - 2) * S, S, [&]() { return first(rng); });
+            if (!unary) { std::ranges::generate_n(p, S, [&]() { return second(rng); }); }
+        }
+
+        auto const i = cols - 1;
+        Operon::Range const range{ 0, S };
+        ankerl::nanobench::Bench bench;
+        bench.output(nullptr).warmup(1).epochs(7).batch(batches * S).run(std::string{primitive.Name}, [&]() { // NOLINT
+            for (auto b = 0UL; b < batches; ++b) { function(nodes, view(b), i, range); }
+        });
+
+        Result result{};
+        auto const seconds = bench.results().back().median(ankerl::nanobench::Result::Measure::elapsed);
+        result.NanosecondsPerElement = seconds * 1e9 / static_cast<double>(batches * S);
+        result.GigabytesPerSecond = static_cast<double>(cols * sizeof(T)) / result.NanosecondsPerElement;
+
+        std::size_t count{0};
+        for (auto b = 0UL; b < batches; ++b) {
+            auto* p = view(b).data_handle();
+            for (auto k = 0UL; k < S; ++k) {
+                auto const a = static_cast<Real>(p[(cols - 2) * S + k]);
+                auto const c = unary ? Real{0} : static_cast<Real>(p[k]);
+                if (auto e = UlpError(p[(cols - 1) * S + k], primitive.Reference(a, c)); e) {
+                    result.MaxUlp = std::max(result.MaxUlp, *e);
+                    result.MeanUlp += *e;
+                    ++count;
+                } else {
+                    ++result.NonFinite;
+                }
+            }
+        }
+        if (count > 0) { result.MeanUlp /= static_cast<double>(count); }
+        return result;
+    }
+
+    template<typename T>
+    auto Run(std::string_view backend, Kernels const& kernels, std::size_t elements, std::vector<std::string>& json) -> void
+    {
+        constexpr auto type = std::is_same_v<T, float> ? "float" : "double";
+        Operon::RandomGenerator rng{0}; // same inputs for every backend
+        for (auto const& primitive : Primitives) {
+            auto const function = kernels.Get<T>()[NodeTypes::GetIndex(primitive.Type)];
+            auto const r = Measure<T>(function, primitive, elements, rng);
+            fmt::print(stderr, "{:<8} {:<7} {:<8} {:>10.3f} {:>8.2f} {:>10.4g} {:>10.4g} {:>9}\n",
+                backend, type, primitive.Name, r.NanosecondsPerElement, r.GigabytesPerSecond, r.MaxUlp, r.MeanUlp, r.NonFinite);
+            json.push_back(fmt::format(R"({{ "backend": "{}", "type": "{}", "primitive": "{}", "ns_per_element": {:.6g}, "gb_per_s": {:.6g}, "max_ulp": {:.6g}, "mean_ulp": {:.6g}, "nonfinite": {} }})",
+                backend, type, primitive.Name, r.NanosecondsPerElement, r.GigabytesPerSecond, r.MaxUlp, r.MeanUlp, r.NonFinite));
+        }
+    }
+} // namespace
+} // namespace Operon::Benchmark
+
+auto main(int argc, char** argv) -> int
+{
+    using namespace Operon::Benchmark; // NOLINT
+    std::size_t elements = argc > 1 ? std::stoul(argv[1]) : 1UL << 16U; // NOLINT
+
+    std::vector<std::string> json;
+    fmt::print(stderr, "{:<8} {:<7} {:<8} {:>10} {:>8} {:>10} {:>10} {:>9}\n", "backend", "type", "symbol", "ns/elem", "GB/s", "max ulp", "mean ulp", "nonfinite");
+#define OPERON_BENCHMARK_BACKEND(B, N) /* NOLINT */ \
+    Run<float>(#N, CompiledKernels<MathLibrary::B>(), elements, json); \
+    Run<double>(#N, CompiledKernels<MathLibrary::B>(), elements, json);
+    OPERON_BENCHMARK_BACKENDS
+#undef OPERON_BENCHMARK_BACKEND
+
+    fmt::print("{{\n  \"elements\": {},\n  \"results\": [\n    ", elements);
+    for (auto i = 0UL; i < json.size(); ++i) {
+        fmt::print("{}{}", i == 0 ? "" : ",\n    ", json[i]);
+    }
+    fmt::print("\n  ]\n}}\n");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,47 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2024 Heal Research
+
+#ifndef OPERON_TEST_BENCHMARK_KERNELS_HPP
+#define OPERON_TEST_BENCHMARK_KERNELS_HPP
+
+#include <utility>
+
+#if !defined(OPERON_ISA_NAMESPACE)
+#error "the benchmarked backends must define OPERON_ISA_NAMESPACE"
+#endif
+
+#include "backend.hpp"
+
+// the built-in primitives of the math backend selected by the including translation unit. like the instruction set
+// variants of the library, each backend declares its kernels in its own inline namespace (OPERON_ISA_NAMESPACE),
+// otherwise the linker could merge the kernels of different backends, which have the same names
+namespace Operon::Benchmark {
+namespace {
+    template<NodeType Type, typename T>
+    [[gnu::flatten]] auto Call(Operon::Vector<Node> const& nodes, Backend::View<T, Dispatch::DefaultBatchSize<T>> primal, size_t i, Operon::Range range) -> void
+    {
+        constexpr auto S = Dispatch::DefaultBatchSize<T>;
+        if constexpr (Node::IsNary<Type>) {
+            Dispatch::NaryOp<Type, T, S>(nodes, primal, i, range);
+        } else if constexpr (Node::IsBinary<Type>) {
+            Dispatch::BinaryOp<Type, T, S>(nodes, primal, i, range);
+        } else {
+            Dispatch::UnaryOp<Type, T, S>(nodes, primal, i, range);
+        }
+    }
+
+    template<typename T>
+    constexpr auto MakeFunctions() -> Functions<T>
+    {
+        Functions<T> functions{};
+        [&]<auto... I>(std::index_sequence<I...>) {
+            ((functions[I] = &Call<static_cast<NodeType>(1U << I), T>), ...);
+        }(std::make_index_sequence<NodeTypes::Count - 3>{});
+        return functions;
+    }
+
+    constexpr Kernels Table{ MakeFunctions<float>(), MakeFunctions<double>() };
+} // namespace
+} // namespace Operon::Benchmark
+
+#endif
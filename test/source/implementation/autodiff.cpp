@@ -18,6 +18,8 @@
 #include "operon/interpreter/dual.hpp"
 #include "operon/operators/creator.hpp"
 #include "operon/operators/initializer.hpp"
+#include "operon/optimizer/likelihood/gaussian_likelihood.hpp"
+#include "operon/optimizer/lm_cost_function.hpp"
 #include "operon/parser/infix.hpp"
 
 
@@ -346,4 +348,166 @@ TEST_CASE("reverse mode" * dt::test_suite("[autodiff]")) {
     };
 }
 
+TEST_CASE("vector forward mode" * dt::test_suite("[autodiff]")) {
+    Operon::Dataset ds("./data/Poly-10.csv", /*hasHeader=*/true);
+    Operon::Range range(0, ds.Rows<std::size_t>());
+    Operon::PrimitiveSet pset(Operon::PrimitiveSet::Arithmetic | NodeType::Exp | NodeType::Sin | NodeType::Tanh);
+    Operon::BalancedTreeCreator creator{pset, ds.VariableHashes()};
+    Operon::RandomGenerator rng(0UL);
+    DispatchTable<Operon::Scalar> dtable;
+
+    // the modes may round differently, the non-finite values must still match
+    auto const close = [](auto const& a, auto const& b) {
+        return ((a.isNaN() && b.isNaN()) || a == b || (a.isFinite() && b.isFinite() && (a - b).abs() <= 1e-4 * (1 + b.abs()))).all();
+    };
+
+    for (auto i = 0; i < 300; ++i) { // NOLINT
+        auto tree = creator(rng, 1 + (i % 50), 1, 12); // NOLINT
+        // coefficients on some of the function nodes
+        if (i % 5 == 0) {
+            for (auto& n : tree.Nodes()) {
+                if (!n.IsLeaf() && n.Length % 2 == 0) { n.Optimize = true; n.Value = 1.5; } // NOLINT
+            }
+        }
+        auto coeff = tree.GetCoefficients();
+        Operon::Interpreter<Operon::Scalar, decltype(dtable)> interpreter{dtable, ds, tree};
+        auto const jrev = interpreter.JacRev(coeff, range);
+        auto const jfwd = interpreter.JacFwd(coeff, range);
+        CHECK(close(jfwd, jrev));
+
+        // the cost heuristic only changes the mode, not the result
+        Eigen::Array<Operon::Scalar, -1, -1> jac(jrev.rows(), jrev.cols());
+        interpreter.Jac(coeff, range, { jac.data(), static_cast<std::size_t>(jac.size()) });
+        CHECK(close(jac, jrev));
+    }
+
+    // a single coefficient near the root of a large tree is cheaper in forward mode
+    auto tree = creator(rng, 50, 1, 12); // NOLINT
+    for (auto& n : tree.Nodes()) { n.Optimize = false; }
+    tree.Nodes().back().Optimize = true;
+    Operon::Interpreter<Operon::Scalar, decltype(dtable)> interpreter{dtable, ds, tree};
+    CHECK(interpreter.PreferForward(1));
+    // but not when all the leaves are coefficients
+    auto other = creator(rng, 50, 1, 12); // NOLINT
+    CHECK(!Operon::Interpreter<Operon::Scalar, decltype(dtable)>{dtable, ds, other}.PreferForward(std::ssize(other.GetCoefficients())));
+}
+
+TEST_CASE("primal and jacobian in one pass" * dt::test_suite("[autodiff]")) {
+    Operon::Dataset ds("./data/Poly-10.csv", /*hasHeader=*/true);
+    Operon::Range range(0, ds.Rows<std::size_t>());
+    Operon::PrimitiveSet pset(Operon::PrimitiveSet::Arithmetic | NodeType::Exp | NodeType::Sin);
+    Operon::BalancedTreeCreator creator{pset, ds.VariableHashes()};
+    Operon::RandomGenerator rng(0UL);
+    DispatchTable<Operon::Scalar> dtable;
+    auto const target = ds.GetValues("Y");
+
+    auto const close = [](auto const& a, auto const& b) {
+        for (auto i = 0UL; i < a.size(); ++i) {
+            if (std::isfinite(b[i]) && std::abs(a[i] - b[i]) > 1e-5 * (1 + std::abs(b[i]))) { return false; }
+        }
+        return true;
+    };
+
+    for (auto i = 0; i < 100; ++i) { // NOLINT
+        auto tree = creator(rng, 1 + (i % 40), 1, 10); // NOLINT
+        auto coeff = tree.GetCoefficients();
+        auto const nr { range.Size() };
+        auto const np { coeff.size() };
+        Operon::Interpreter<Operon::Scalar, decltype(dtable)> interpreter{dtable, ds, tree};
+
+        std::vector<Operon::Scalar> r1(nr), r2(nr), j1(nr * np), j2(nr * np);
+        interpreter.EvaluateJac(coeff, range, r1, j1);
+        interpreter.Evaluate(coeff, range, r2);
+        interpreter.Jac(coeff, range, j2);
+        CHECK(close(r1, r2));
+        CHECK(close(j1, j2));
+
+        // the cost function computes the residuals and the jacobian together
+        Operon::LMCostFunction<Operon::Scalar> cf{interpreter, target, range};
+        std::vector<Operon::Scalar> r3(nr), j3(nr * np);
+        CHECK(cf(coeff.data(), r3.data(), j3.data()));
+        std::ranges::transform(r2, target, r2.begin(), std::minus{});
+        CHECK(close(r3, r2));
+        CHECK(close(j3, j2));
+    }
+}
+
+TEST_CASE("vector-jacobian product" * dt::test_suite("[autodiff]")) {
+    Operon::Dataset ds("./data/Poly-10.csv", /*hasHeader=*/true);
+    Operon::Range range(0, ds.Rows<std::size_t>());
+    Operon::PrimitiveSet pset(Operon::PrimitiveSet::Arithmetic | NodeType::Exp | NodeType::Sin);
+    Operon::BalancedTreeCreator creator{pset, ds.VariableHashes()};
+    Operon::RandomGenerator rng(0UL);
+    DispatchTable<Operon::Scalar> dtable;
+    auto const target = ds.GetValues("Y");
+
+    using Vector = Eigen::Matrix<Operon::Scalar, -1, 1>;
+    auto const close = [](Vector const& a, Vector const& b) {
+        return !b.allFinite() || ((a - b).array().abs() <= 1e-3 * (1 + b.array().abs())).all();
+    };
+
+    std::uniform_real_distribution<Operon::Scalar> dist(-1, 1);
+    for (auto i = 0; i < 100; ++i) { // NOLINT
+        auto tree = creator(rng, 1 + (i % 40), 1, 10); // NOLINT
+        auto coeff = tree.GetCoefficients();
+        auto const np { std::ssize(coeff) };
+        Operon::Interpreter<Operon::Scalar, decltype(dtable)> interpreter{dtable, ds, tree};
+        Eigen::Matrix<Operon::Scalar, -1, -1> const jac = interpreter.JacRev(coeff, range).matrix();
+
+        Vector v(range.Size());
+        for (auto& x : v) { x = dist(rng); }
+        Vector g(np);
+        interpreter.Vjp(coeff, range, {v.data(), range.Size()}, {g.data(), coeff.size()});
+        CHECK(close(g, jac.transpose() * v));
+
+        // the likelihood gradient is the vector-jacobian product with the residual
+        auto const primal = interpreter.Evaluate(coeff, range);
+        Vector e(range.Size());
+        for (auto j = 0UL; j < range.Size(); ++j) { e[j] = primal[j] - target[j]; }
+        if (!std::isfinite(e.squaredNorm())) { continue; }
+        Operon::GaussianLikelihood<Operon::Scalar> loss{rng, interpreter, target, range};
+        Eigen::Map<Vector const> x(coeff.data(), np);
+        Vector grad(np);
+        auto const f = loss(x, grad);
+        CHECK(close(grad, jac.transpose() * e));
+        CHECK(std::abs(f - e.squaredNorm() / 2) <= 1e-3 * (1 + e.squaredNorm()));
+    }
+}
+
+TEST_CASE("normal equations" * dt::test_suite("[autodiff]")) {
+    Operon::Dataset ds("./data/Poly-10.csv", /*hasHeader=*/true);
+    Operon::Range range(0, ds.Rows<std::size_t>());
+    Operon::PrimitiveSet pset(Operon::PrimitiveSet::Arithmetic | NodeType::Exp | NodeType::Sin);
+    Operon::BalancedTreeCreator creator{pset, ds.VariableHashes()};
+    Operon::RandomGenerator rng(0UL);
+    DispatchTable<Operon::Scalar> dtable;
+    auto const target = ds.GetValues("Y");
+
+    using Vector = Eigen::Matrix<Operon::Scalar, -1, 1>;
+    using Matrix = Eigen::Matrix<Operon::Scalar, -1, -1>;
+    for (auto i = 0; i < 100; ++i) { // NOLINT
+        auto tree = creator(rng, 1 + (i % 40), 1, 10); // NOLINT
+        auto coeff = tree.GetCoefficients();
+        auto const np { std::ssize(coeff) };
+        Operon::Interpreter<Operon::Scalar, decltype(dtable)> interpreter{dtable, ds, tree};
+
+        Matrix const jac = interpreter.JacRev(coeff, range).matrix();
+        auto const primal = interpreter.Evaluate(coeff, range);
+        Vector r(range.Size());
+        for (auto j = 0UL; j < range.Size(); ++j) { r[j] = primal[j] - target[j]; }
+        if (!(jac.transpose() * jac).allFinite() || !std::isfinite(r.squaredNorm())) { continue; }
+
+        // the normal equations are accumulated in double precision (from a jacobian in single precision,
+        // which may be computed in another mode than the reference)
+        Eigen::MatrixXd const jd = jac.cast<double>();
+        Eigen::VectorXd const rd = r.cast<double>();
+        Eigen::MatrixXd a(np, np);
+        Eigen::VectorXd b(np);
+        auto const ssr = interpreter.NormalEquations(coeff, range, target, {a.data(), static_cast<std::size_t>(a.size())}, {b.data(), coeff.size()});
+        CHECK(a.isApprox(jd.transpose() * jd, 1e-3));
+        CHECK(b.isApprox(jd.transpose() * rd, 1e-3));
+        CHECK(std::abs(ssr - rd.squaredNorm()) <= 1e-3 * (1 + rd.squaredNorm()));
+    }
+}
+
 } // namespace Operon::Test
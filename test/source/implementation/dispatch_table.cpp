@@ -4,7 +4,10 @@
 #include <doctest/doctest.h>
 #include <fmt/ranges.h>
 
+#include "operon/core/pset.hpp"
 #include "operon/interpreter/interpreter.hpp"
+#include "operon/interpreter/isa.hpp"
+#include "operon/operators/creator.hpp"
 #include "operon/parser/infix.hpp"
 #include "operon/formatter/formatter.hpp"
 
@@ -54,4 +57,161 @@ namespace Operon::Test {
         DT dt4(std::move(map));
         check(dt4, "exp(log(10))", std::exp(std::log(10.f)));
     }
+
+    TEST_CASE("callables" * dt::test_suite("dispatch_table")) {
+        using DT = Operon::DispatchTable<Operon::Scalar>;
+        constexpr auto S = DT::BatchSize<Operon::Scalar>;
+
+        std::string x{"x"};
+        std::vector<Operon::Scalar> v{0};
+        Operon::Dataset ds({x}, {v});
+
+        // the built-in primitives are plain functions, the map only holds the registered callables
+        DT dt;
+        CHECK(dt.GetMap().empty());
+        CHECK(dt.GetFunction<Operon::Scalar>(Node(NodeType::Exp).HashValue).Builtin != nullptr);
+        CHECK(dt.GetDerivative<Operon::Scalar>(Node(NodeType::Exp).HashValue).Builtin != nullptr);
+        CHECK(!dt.Contains(Node(NodeType::Constant).HashValue));
+
+        // a user-defined unary function
+        Node f(NodeType::Dynamic, /*hashValue=*/42); // NOLINT
+        f.Arity = 1;
+        CHECK(!dt.Contains(f.HashValue));
+        dt.RegisterCallable(f.HashValue, [](auto const& /*nodes*/, auto primal, std::size_t i, Operon::Range rg) {
+            auto* res = primal.data_handle() + i * S;
+            std::transform(res - S, res - S + rg.Size(), res, [](auto a) { return 2 * a; });
+        });
+        CHECK(dt.Contains(f.HashValue));
+        CHECK(dt.GetFunction<Operon::Scalar>(f.HashValue).Dynamic != nullptr);
+
+        Tree tree({ Node::Constant(3), f });
+        tree.UpdateNodes();
+        auto r = Operon::Interpreter<Operon::Scalar, DT>(dt, ds, tree).Evaluate(tree.GetCoefficients(), Operon::Range(0, 1));
+        CHECK(r[0] == 6);
+
+        // the tape of an interpreter keeps pointing at the callable while more callables are registered
+        Operon::Interpreter<Operon::Scalar, DT> compiled(dt, ds, tree);
+        r = compiled.Evaluate(tree.GetCoefficients(), Operon::Range(0, 1));
+        for (auto h = 100UL; h < 1100UL; ++h) { // NOLINT
+            dt.RegisterCallable(h, [](auto const& /*nodes*/, auto /*primal*/, std::size_t /*i*/, Operon::Range /*rg*/) { });
+        }
+        r = compiled.Evaluate(tree.GetCoefficients(), Operon::Range(0, 1));
+        CHECK(r[0] == 6);
+
+        // a table created from a map of callables also holds the built-in primitives
+        DT custom(dt.GetMap());
+        CHECK(custom.GetMap().size() == dt.GetMap().size());
+        CHECK(custom.GetFunction<Operon::Scalar>(f.HashValue).Dynamic != nullptr);
+        CHECK(custom.GetFunction<Operon::Scalar>(Node(NodeType::Exp).HashValue).Builtin != nullptr);
+        r = Operon::Interpreter<Operon::Scalar, DT>(custom, ds, tree).Evaluate(tree.GetCoefficients(), Operon::Range(0, 1));
+        CHECK(r[0] == 6);
+
+        // a registered callable replaces the built-in primitive
+        dt.RegisterCallable(Node(NodeType::Exp).HashValue, [](auto const& /*nodes*/, auto primal, std::size_t i, Operon::Range rg) {
+            auto* res = primal.data_handle() + i * S;
+            std::fill_n(res, rg.Size(), Operon::Scalar{-1});
+        });
+        CHECK(dt.GetFunction<Operon::Scalar>(Node(NodeType::Exp).HashValue).Builtin == nullptr);
+        Tree other({ Node::Constant(3), Node(NodeType::Exp) });
+        other.UpdateNodes();
+        r = Operon::Interpreter<Operon::Scalar, DT>(dt, ds, other).Evaluate(other.GetCoefficients(), Operon::Range(0, 1));
+        CHECK(r[0] == -1);
+    }
+
+    TEST_CASE("instruction sets" * dt::test_suite("dispatch_table")) {
+        auto ds = Dataset("./data/Poly-10.csv", /*hasHeader=*/true);
+        auto range = Range { 0, ds.Rows<std::size_t>() };
+        PrimitiveSet pset{PrimitiveSet::Arithmetic | NodeType::Exp | NodeType::Log | NodeType::Sin | NodeType::Tanh};
+        BalancedTreeCreator creator{pset, ds.VariableHashes()};
+        Operon::RandomGenerator rng{0};
+
+        // restores the instruction set for the other tests, also when a check throws
+        struct Restore {
+            InstructionSet Isa;
+            explicit Restore(InstructionSet isa) : Isa(isa) { }
+            Restore(Restore const&) = delete;
+            Restore(Restore&&) = delete;
+            auto operator=(Restore const&) -> Restore& = delete;
+            auto operator=(Restore&&) -> Restore& = delete;
+            ~Restore() { SetInstructionSet(Isa); }
+        } const restore{GetInstructionSet()};
+        auto const initial = restore.Isa;
+        CHECK(IsAvailable(initial));
+        CHECK(IsAvailable(InstructionSet::Generic));
+        CHECK(ParseInstructionSet("AVX2") == InstructionSet::Avx2);
+        CHECK(!ParseInstructionSet("neon"));
+
+        SetInstructionSet(InstructionSet::Generic);
+        DefaultDispatch generic;
+        std::vector<Tree> trees;
+        for (auto i = 0; i < 100; ++i) { trees.push_back(creator(rng, 1 + i % 40, 1, 12)); } // NOLINT
+
+        // the variants may round differently (e.g. fused multiply-add), the non-finite values must still match
+        using Array = Eigen::Array<Operon::Scalar, -1, -1>;
+        auto close = [](Array const& a, Array const& b) {
+            return ((a.isNaN() && b.isNaN()) || a == b || (a.isFinite() && b.isFinite() && (a - b).abs() <= 1e-4 * (1 + b.abs()))).all();
+        };
+
+        for (auto isa : { InstructionSet::Sse42, InstructionSet::Avx2, InstructionSet::Avx512 }) {
+            if (!IsAvailable(isa)) {
+                CHECK_THROWS(SetInstructionSet(isa));
+                continue;
+            }
+            SetInstructionSet(isa);
+            DefaultDispatch dtable;
+            for (auto const& tree : trees) {
+                auto coeff = tree.GetCoefficients();
+                Interpreter<Operon::Scalar, DefaultDispatch> interpreter{dtable, ds, tree};
+                Interpreter<Operon::Scalar, DefaultDispatch> reference{generic, ds, tree};
+                auto x = interpreter.Evaluate(coeff, range);
+                auto y = reference.Evaluate(coeff, range);
+                CHECK(close(Eigen::Map<Array>(x.data(), std::ssize(x), 1), Eigen::Map<Array>(y.data(), std::ssize(y), 1)));
+                CHECK(close(interpreter.JacRev(coeff, range), reference.JacRev(coeff, range)));
+            }
+        }
+    }
+    TEST_CASE("math backends" * dt::test_suite("dispatch_table")) {
+        auto ds = Dataset("./data/Poly-10.csv", /*hasHeader=*/true);
+        auto range = Range { 0, ds.Rows<std::size_t>() };
+
+        CHECK(IsAvailable(MathBackend::Default));
+        CHECK(ParseMathBackend("FAST_V1") == MathBackend::FastV1);
+        CHECK(!ParseMathBackend("vdt"));
+
+        Operon::Map<std::string, Operon::Hash> vars;
+        for (auto const& v : ds.GetVariables()) { vars.insert({ v.Name, v.Hash }); }
+        auto tree = InfixParser::Parse("exp(X1) * sin(X2) + X3", vars);
+        auto coeff = tree.GetCoefficients();
+
+        DefaultDispatch exact;
+        Interpreter<Operon::Scalar, DefaultDispatch> reference{exact, ds, tree};
+        auto y = reference.Evaluate(coeff, range);
+
+        using Array = Eigen::Array<Operon::Scalar, -1, 1>;
+        auto const exp = static_cast<Operon::Hash>(NodeType::Exp);
+        auto const sin = static_cast<Operon::Hash>(NodeType::Sin);
+
+        for (auto backend : { MathBackend::Eigen, MathBackend::Stl, MathBackend::Eve, MathBackend::FastV1, MathBackend::FastV2, MathBackend::FastV3 }) {
+            DefaultDispatch dtable;
+            if (!IsAvailable(backend)) {
+                CHECK_THROWS(dtable.SetBackend(backend));
+                continue;
+            }
+
+            // only the selected primitives are replaced
+            dtable.SetBackend(backend, NodeType::Exp);
+            CHECK(dtable.GetFunction<Operon::Scalar>(sin).Builtin == exact.GetFunction<Operon::Scalar>(sin).Builtin);
+
+            Interpreter<Operon::Scalar, DefaultDispatch> interpreter{dtable, ds, tree};
+            auto x = interpreter.Evaluate(coeff, range);
+            auto const err = ((Eigen::Map<Array>(x.data(), std::ssize(x)) - Eigen::Map<Array>(y.data(), std::ssize(y))).abs() / (1 + Eigen::Map<Array>(y.data(), std::ssize(y)).abs())).maxCoeff();
+            fmt::print("{}: max relative error {}\n", MathBackendName(backend), err);
+            CHECK(err < 0.1); // the fast approximations are only accurate to a few percent
+
+            // switching back restores the exact kernels (for the interpreters created afterwards)
+            dtable.SetBackend(MathBackend::Default);
+            CHECK(dtable.GetFunction<Operon::Scalar>(exp).Builtin == exact.GetFunction<Operon::Scalar>(exp).Builtin);
+            CHECK(Interpreter<Operon::Scalar, DefaultDispatch>{dtable, ds, tree}.Evaluate(coeff, range) == y);
+        }
+    }
 } // namespace Operon::Test
@@ -6,15 +6,23 @@
 #include "operon/core/types.hpp"
 #include "operon/error_metrics/mean_squared_error.hpp"
 #include "operon/formatter/formatter.hpp"
+#include "operon/interpreter/dag_interpreter.hpp"
 #include "operon/interpreter/interpreter.hpp"
+#include "operon/interpreter/interval.hpp"
+#include "operon/interpreter/multi_interpreter.hpp"
+#include "operon/interpreter/subtree_cache.hpp"
 #include "operon/operators/creator.hpp"
 #include "operon/operators/evaluator.hpp"
+#include "operon/operators/generator.hpp"
+#include "operon/operators/local_search.hpp"
+#include "operon/optimizer/coefficient_cache.hpp"
 #include "operon/optimizer/likelihood/gaussian_likelihood.hpp"
 #include "operon/optimizer/likelihood/poisson_likelihood.hpp"
 #include "operon/optimizer/optimizer.hpp"
 #include "operon/optimizer/solvers/sgd.hpp"
 #include "operon/parser/infix.hpp"
 #include <doctest/doctest.h>
+#include <taskflow/taskflow.hpp>
 #include <utility>
 
 namespace Operon::Test {
@@ -175,8 +183,36 @@ TEST_CASE("relative accuracy")
         fmt::print("cos(nan): {} {}\n", backend::Cos(nan), std::cos(nan));
         fmt::print("tanh(nan): {} {}\n", backend::Tanh(nan), std::tanh(nan));
         fmt::print("sqrt(nan): {} {}\n", backend::Sqrt(nan), std::sqrt(nan));
-        fmt::print("div(nan, x): {} {}\n", backend::Div(nan, 2), nan / 2);
-        fmt::print("aq(nan, x): {} {}\n", backend::Aq(nan, 2), nan / std::sqrt(5));
+        fmt::print("div(nan, x): {} {}\n", backend::Div(nan, Operon::Scalar{2}), nan / 2);
+        fmt::print("aq(nan, x): {} {}\n", backend::Aq(nan, Operon::Scalar{2}), nan / std::sqrt(5));
+    }
+
+    SUBCASE("simd") {
+        // the wide kernels must agree with the scalar ones lane by lane, including the special values
+        using W = eve::wide<Operon::Scalar>;
+        auto constexpr inf = std::numeric_limits<Operon::Scalar>::infinity();
+        std::vector<Operon::Scalar> x{ 0, -0.F, 1, -1, 0.5, -2.5, 7, -9, inf, -inf, nan, 1e-3F, 85, -85, 3, 100 };
+        for (auto i = 0L; i + W::size() <= std::ssize(x); i += W::size()) {
+            W const u{x.data() + i};
+            W const v{x.data() + std::ssize(x) - i - W::size()};
+            auto check = [&](auto&& f) {
+                auto const r = f(u, v);
+                for (auto j = 0L; j < W::size(); ++j) {
+                    auto const a = r.get(j);
+                    auto const b = f(u.get(j), v.get(j));
+                    CHECK(((std::isnan(a) && std::isnan(b)) || a == b));
+                }
+            };
+            check([](auto a, auto) { return backend::Exp(a); });
+            check([](auto a, auto) { return backend::Log(a); });
+            check([](auto a, auto) { return backend::Inv(a); });
+            check([](auto a, auto) { return backend::Sqrt(a); });
+            check([](auto a, auto) { return backend::Sin(a); });
+            check([](auto a, auto) { return backend::Cos(a); });
+            check([](auto a, auto) { return backend::Tanh(a); });
+            check([](auto a, auto b) { return backend::Pow(a, b); });
+            check([](auto a, auto b) { return backend::Aq(a, b); });
+        }
     }
     #endif
 
@@ -230,7 +266,896 @@ TEST_CASE("Batch evaluation")
     }
 
     Operon::EvaluateTrees(trees, ds, range, {result.data(), result.size()});
-    Operon::EvaluateTrees(trees, ds, range);
+    auto const values = Operon::EvaluateTrees(trees, ds, range);
+
+    // interleaving the trees over the row blocks must not change the results
+    for (auto i = 0; i < n; ++i) {
+        auto const expected = Interpreter<Operon::Scalar, DefaultDispatch>::Evaluate(trees[i], ds, range);
+        CHECK(values[i] == expected);
+        CHECK(std::equal(expected.begin(), expected.end(), result.begin() + i * range.Size()));
+    }
+
+    // the evaluator scores a group of individuals in one pass
+    DefaultDispatch dtable;
+    Operon::Evaluator<DefaultDispatch> evaluator{problem, dtable};
+    std::vector<Operon::Individual> individuals(n);
+    std::vector<Operon::RandomGenerator> rngs;
+    for (auto i = 0; i < n; ++i) { rngs.emplace_back(rng()); }
+    for (auto i = 0; i < n; ++i) { individuals[i].Genotype = trees[i]; }
+    evaluator.Evaluate(rngs, individuals, result);
+    for (auto i = 0; i < n; ++i) {
+        auto const fit = evaluator(rng, individuals[i], {result.data(), range.Size()});
+        CHECK(individuals[i].Fitness == fit);
+    }
+}
+
+TEST_CASE("Row-parallel evaluation")
+{
+    auto ds = Dataset("./data/Poly-10.csv", /*hasHeader=*/true);
+    auto range = Range { 0, ds.Rows<std::size_t>() };
+
+    Operon::PrimitiveSet pset{PrimitiveSet::Arithmetic};
+    Operon::BalancedTreeCreator creator{pset, ds.VariableHashes()};
+    Operon::RandomGenerator rng{0};
+    DefaultDispatch dtable;
+
+    // small chunks (rounded up to the batch size) so that the range is split among the workers
+    auto constexpr chunkSize{100};
+    tf::Executor executor(4);
+
+    for (auto i = 0; i < 10; ++i) {
+        auto tree = creator(rng, 20, 10, 20);
+        for (auto& node : tree.Nodes()) { node.Optimize = node.IsLeaf(); }
+        auto const coeff = tree.GetCoefficients();
+        Interpreter<Operon::Scalar, DefaultDispatch> interpreter{dtable, ds, tree};
+
+        std::vector<Operon::Scalar> result(range.Size());
+        Operon::EvaluateRows(executor, dtable, tree, ds, range, coeff, result, chunkSize);
+        CHECK(result == interpreter.Evaluate(coeff, range));
+        CHECK(Operon::EvaluateRows(tree, ds, range, 2, chunkSize) == interpreter.Evaluate(coeff, range));
+
+        auto const expected = interpreter.JacRev(coeff, range);
+        Eigen::Array<Operon::Scalar, -1, -1> jacobian(range.Size(), coeff.size());
+        Operon::JacRevRows(executor, dtable, tree, ds, range, coeff, {jacobian.data(), static_cast<std::size_t>(jacobian.size())}, chunkSize);
+        CHECK(((jacobian == expected) || (jacobian.isNaN() && expected.isNaN())).all());
+
+        // the chunks are summed in another order than the batches of a single interpreter
+        auto const np { std::ssize(coeff) };
+        auto const target = ds.GetValues("Y").subspan(range.Start(), range.Size());
+        Eigen::MatrixXd a(np, np);
+        Eigen::MatrixXd a1(np, np);
+        Eigen::VectorXd b(np);
+        Eigen::VectorXd b1(np);
+        auto const ssr = interpreter.NormalEquations(coeff, range, target, {a.data(), static_cast<std::size_t>(a.size())}, {b.data(), static_cast<std::size_t>(b.size())});
+        auto const ssr1 = Operon::NormalEquationsRows(executor, dtable, tree, ds, range, coeff, target, {a1.data(), static_cast<std::size_t>(a1.size())}, {b1.data(), static_cast<std::size_t>(b1.size())}, chunkSize);
+        if (!std::isfinite(ssr)) { continue; }
+        CHECK(a1.isApprox(a, 1e-10));
+        CHECK(b1.isApprox(b, 1e-10));
+        CHECK(ssr1 == doctest::Approx(ssr).epsilon(1e-10));
+    }
+}
+
+TEST_CASE("Subtree sharing")
+{
+    auto ds = Dataset("./data/Poly-10.csv", /*hasHeader=*/true);
+    auto range = Range { 0, ds.Rows<std::size_t>() };
+
+    Operon::Problem problem{ds, range, range};
+    Operon::PrimitiveSet pset{PrimitiveSet::Arithmetic | NodeType::Exp | NodeType::Sin};
+    Operon::BalancedTreeCreator creator{pset, ds.VariableHashes()};
+
+    Operon::RandomGenerator rng{0};
+    auto constexpr n{10};
+
+    // every tree appears twice, so at least half of the nodes are shared
+    std::vector<Operon::Tree> trees;
+    for (auto i = 0; i < n; ++i) {
+        trees.push_back(creator(rng, 20, 10, 20));
+        trees.push_back(trees.back());
+    }
+
+    DefaultDispatch dtable;
+    DagInterpreter<Operon::Scalar, DefaultDispatch> interpreter{dtable, ds};
+    interpreter.Compile(trees);
+    CHECK(interpreter.DedupRatio() >= 0.5);
+
+    std::vector<Operon::Scalar> result(range.Size() * trees.size());
+    interpreter.Evaluate(range, result);
+    for (auto i = 0UL; i < trees.size(); ++i) {
+        auto const expected = Interpreter<Operon::Scalar, DefaultDispatch>::Evaluate(trees[i], ds, range);
+        CHECK(std::equal(expected.begin(), expected.end(), result.begin() + i * range.Size()));
+    }
+
+    // same fitness as the tree-wise evaluator
+    Operon::Evaluator<DefaultDispatch> evaluator{problem, dtable};
+    Operon::DagEvaluator<DefaultDispatch> dagEvaluator{problem, dtable};
+    std::vector<Operon::Individual> individuals(trees.size());
+    std::vector<Operon::RandomGenerator> rngs;
+    for (auto i = 0UL; i < trees.size(); ++i) {
+        individuals[i].Genotype = trees[i];
+        rngs.emplace_back(rng());
+    }
+    dagEvaluator.Evaluate(rngs, individuals, result);
+    CHECK(dagEvaluator.DedupRatio() >= 0.5);
+    for (auto& ind : individuals) {
+        CHECK(ind.Fitness == evaluator(rng, ind, {result.data(), range.Size()}));
+    }
+
+    // in the fused mode the fitness is accumulated block by block, so the group is not limited by the buffer
+    CHECK(dagEvaluator.SharesSubtrees());
+    evaluator.SetFusedFitness(true);
+    dagEvaluator.SetFusedFitness(true);
+    for (auto& ind : individuals) { ind.Fitness.clear(); }
+    dagEvaluator.Evaluate(rngs, individuals, {result.data(), range.Size()});
+    for (auto& ind : individuals) {
+        CHECK(ind.Fitness == evaluator(rng, ind, {result.data(), range.Size()}));
+    }
+
+    // trees sharing a non-root subtree: f(S, X1) and g(S) for different functions f and g
+    auto const shared = creator(rng, 20, 10, 20);
+    interpreter.Compile(std::vector<Operon::Tree>{ shared });
+    auto const unique { interpreter.UniqueNodes() };
+
+    auto const x1 = Node(NodeType::Variable, ds.GetVariable("X1")->Hash);
+    std::vector<Operon::Tree> wrapped;
+    for (auto type : { NodeType::Add, NodeType::Sub, NodeType::Mul, NodeType::Div, NodeType::Exp, NodeType::Sin }) {
+        auto nodes = shared.Nodes();
+        if (Node(type).Arity == 2) { nodes.push_back(x1); }
+        nodes.push_back(Node(type));
+        wrapped.emplace_back(nodes).UpdateNodes();
+    }
+    interpreter.Compile(wrapped);
+    // the shared subtree is evaluated once, each tree adds its root (and possibly the variable)
+    CHECK(interpreter.UniqueNodes() >= unique + wrapped.size());
+    CHECK(interpreter.UniqueNodes() <= unique + wrapped.size() + 1);
+
+    result.resize(range.Size() * wrapped.size());
+    interpreter.Evaluate(range, result);
+    for (auto i = 0UL; i < wrapped.size(); ++i) {
+        auto const expected = Interpreter<Operon::Scalar, DefaultDispatch>::Evaluate(wrapped[i], ds, range);
+        CHECK(std::equal(expected.begin(), expected.end(), result.begin() + i * range.Size()));
+    }
+}
+
+TEST_CASE("Subtree cache")
+{
+    auto ds = Dataset("./data/Poly-10.csv", /*hasHeader=*/true);
+    auto range = Range { 0, ds.Rows<std::size_t>() };
+
+    Operon::PrimitiveSet pset{PrimitiveSet::Arithmetic | NodeType::Exp | NodeType::Sin};
+    Operon::BalancedTreeCreator creator{pset, ds.VariableHashes()};
+    Operon::RandomGenerator rng{0};
+    DefaultDispatch dtable;
+    using TInterpreter = Interpreter<Operon::Scalar, DefaultDispatch>;
+
+    SubtreeCache<Operon::Scalar> cache;
+    std::vector<Operon::Scalar> result(range.Size());
+    auto same = [&](Operon::Tree const& tree) {
+        return std::ranges::equal(result, TInterpreter::Evaluate(tree, ds, range), [](auto x, auto y) { return x == y || (std::isnan(x) && std::isnan(y)); });
+    };
+
+    for (auto i = 0; i < 10; ++i) {
+        auto tree = creator(rng, 20, 10, 20);
+        TInterpreter interpreter{dtable, ds, tree};
+        interpreter.SetCache(&cache);
+        interpreter.Evaluate({}, range, result);
+        CHECK(same(tree));
+
+        // a different root weight: only the root is evaluated again
+        auto const hits = cache.Hits();
+        auto modified = tree;
+        modified.Nodes().back().Value *= 2;
+        TInterpreter other{dtable, ds, modified};
+        other.SetCache(&cache);
+        other.Evaluate({}, range, result);
+        CHECK(same(modified));
+        CHECK(cache.Hits() > hits);
+    }
+    CHECK(cache.HitRate() > 0);
+    CHECK(cache.Bytes() <= cache.Capacity());
+
+    // the memory budget is enforced by evicting the least recently used outputs
+    SubtreeCache<Operon::Scalar> small{SubtreeCache<Operon::Scalar>::ShardCount * range.Size() * sizeof(Operon::Scalar)};
+    for (auto i = 0; i < 10; ++i) {
+        auto tree = creator(rng, 20, 10, 20);
+        TInterpreter interpreter{dtable, ds, tree};
+        interpreter.SetCache(&small);
+        interpreter.Evaluate({}, range, result);
+        CHECK(same(tree));
+    }
+    CHECK(small.Evictions() > 0);
+    CHECK(small.Bytes() <= small.Capacity());
+
+    // outputs that do not fit in the budget are neither looked up nor allocated
+    SubtreeCache<Operon::Scalar> tiny{SubtreeCache<Operon::Scalar>::ShardCount * sizeof(Operon::Scalar)};
+    auto tree = creator(rng, 20, 10, 20);
+    TInterpreter interpreter{dtable, ds, tree};
+    interpreter.SetCache(&tiny);
+    interpreter.Evaluate({}, range, result);
+    CHECK(same(tree));
+    CHECK(tiny.Misses() == 0);
+    CHECK(tiny.Bytes() == 0);
+}
+
+TEST_CASE("Early abandon")
+{
+    auto ds = Dataset("./data/Poly-10.csv", /*hasHeader=*/true);
+    auto range = Range { 0, ds.Rows<std::size_t>() };
+
+    Operon::Problem problem{ds, range, range};
+    Operon::PrimitiveSet pset{PrimitiveSet::Arithmetic};
+    Operon::BalancedTreeCreator creator{pset, ds.VariableHashes()};
+    Operon::RandomGenerator rng{0};
+    DefaultDispatch dtable;
+
+    std::vector<Operon::Individual> individuals(100);
+    for (auto& ind : individuals) { ind.Genotype = creator(rng, 20, 10, 20); }
+    std::vector<Operon::Scalar> buf(range.Size());
+
+    for (auto scaling : { false, true }) {
+        for (auto error : { Operon::ErrorMetric{ErrorType::MSE}, Operon::ErrorMetric{ErrorType::RMSE}, Operon::ErrorMetric{ErrorType::NMSE} }) {
+            Operon::Evaluator<DefaultDispatch> evaluator{problem, dtable, error, scaling};
+            std::vector<Operon::Scalar> fitness;
+            for (auto& ind : individuals) { fitness.push_back(evaluator(rng, ind, buf).front()); }
+            auto sorted = fitness;
+            std::ranges::sort(sorted);
+            // the scaled errors of random trees are close to each other, their partial errors only exceed a low threshold
+            auto const threshold = scaling ? sorted.front() / 2 : sorted[sorted.size() / 2];
+
+            evaluator.SetEarlyAbandon(true);
+            evaluator.Reset();
+            for (auto i = 0UL; i < individuals.size(); ++i) {
+                auto const f = evaluator.EvaluateWithThreshold(rng, individuals[i], buf, threshold).front();
+                // the individuals that qualify get their exact fitness, the others a fitness that is still worse than the threshold
+                if (fitness[i] <= threshold) {
+                    CHECK(f == fitness[i]);
+                } else {
+                    CHECK(f > threshold);
+                    CHECK(f <= fitness[i] * (1 + 1e-5));
+                }
+            }
+            CHECK(evaluator.AbandonedCount() > 0);
+            CHECK(evaluator.ResidualEvaluations < individuals.size());
+        }
+    }
+}
+
+TEST_CASE("Fused fitness")
+{
+    auto ds = Dataset("./data/Poly-10.csv", /*hasHeader=*/true);
+    auto range = Range { 0, ds.Rows<std::size_t>() };
+
+    Operon::Problem problem{ds, range, range};
+    Operon::PrimitiveSet pset{PrimitiveSet::Arithmetic};
+    Operon::BalancedTreeCreator creator{pset, ds.VariableHashes()};
+    Operon::RandomGenerator rng{0};
+    DefaultDispatch dtable;
+
+    std::vector<Operon::Individual> individuals(100);
+    for (auto& ind : individuals) { ind.Genotype = creator(rng, 20, 10, 20); }
+    std::vector<Operon::Scalar> buf(range.Size());
+
+    for (auto scaling : { false, true }) {
+        for (auto type : { ErrorType::SSE, ErrorType::MSE, ErrorType::RMSE, ErrorType::NMSE, ErrorType::R2, ErrorType::C2 }) {
+            Operon::Evaluator<DefaultDispatch> evaluator{problem, dtable, Operon::ErrorMetric{type}, scaling};
+            Operon::Evaluator<DefaultDispatch> fused{problem, dtable, Operon::ErrorMetric{type}, scaling};
+            // off by default, the callers may read the predictions from the buffer
+            CHECK(!evaluator.FusedFitness());
+            fused.SetFusedFitness(true);
+
+            for (auto& ind : individuals) {
+                auto const expected = evaluator(rng, ind, buf).front();
+                std::ranges::fill(buf, Operon::Scalar{-1});
+                auto const f = fused(rng, ind, buf).front();
+                // the predictions are not stored
+                CHECK(std::ranges::all_of(buf, [](auto x) { return x == -1; }));
+                CHECK(f == doctest::Approx(expected).epsilon(1e-4));
+            }
+        }
+    }
+}
+
+TEST_CASE("Progressive evaluation")
+{
+    auto ds = Dataset("./data/Poly-10.csv", /*hasHeader=*/true);
+    auto range = Range { 0, ds.Rows<std::size_t>() };
+
+    Operon::Problem problem{ds, range, range};
+    Operon::PrimitiveSet pset{PrimitiveSet::Arithmetic};
+    Operon::BalancedTreeCreator creator{pset, ds.VariableHashes()};
+    Operon::RandomGenerator rng{0};
+    DefaultDispatch dtable;
+
+    std::vector<Operon::Individual> individuals(10);
+    for (auto& ind : individuals) { ind.Genotype = creator(rng, 20, 10, 20); }
+    std::vector<Operon::Scalar> buf(range.Size());
+
+    Operon::Evaluator<DefaultDispatch> reference{problem, dtable};
+    std::vector<Operon::Vector<Operon::Scalar>> expected;
+    for (auto& ind : individuals) { expected.push_back(reference(rng, ind, buf)); }
+
+    Operon::Evaluator<DefaultDispatch> evaluator{problem, dtable};
+    evaluator.SetSubsample(0.1, 5, 42);
+    evaluator.Prepare(individuals);
+
+    // one window per stratum, a tenth of the rows in total
+    auto const sample = std::vector<Range>(evaluator.Sample().begin(), evaluator.Sample().end());
+    REQUIRE(sample.size() == 5);
+    auto rows { 0UL };
+    for (auto i = 0UL; i < sample.size(); ++i) {
+        auto const stratum { range.Size() / sample.size() };
+        CHECK(sample[i].Start() >= i * stratum);
+        CHECK(sample[i].End() <= (i + 1) * stratum);
+        rows += sample[i].Size();
+    }
+    CHECK(rows == range.Size() / 10);
+
+    for (auto& ind : individuals) {
+        ind.Fitness = evaluator(rng, ind, buf);
+        CHECK(ind.Approximate);
+    }
+    // ten evaluations on a tenth of the rows
+    CHECK(evaluator.ResidualEvaluations == 1);
+
+    // the promoted individuals get their full-range fitness
+    for (auto i = 0UL; i < individuals.size(); ++i) {
+        auto& ind = individuals[i];
+        CHECK(evaluator.Promote(rng, ind, buf));
+        CHECK(!ind.Approximate);
+        CHECK(ind.Fitness == expected[i]);
+        CHECK(!evaluator.Promote(rng, ind, buf));
+    }
+    CHECK(evaluator.ResidualEvaluations == 1 + individuals.size());
+
+    // the initial population is evaluated on all the rows at once
+    {
+        auto population = individuals;
+        for (auto& ind : population) { ind.Fitness.clear(); }
+        std::vector<Operon::RandomGenerator> rngs(population.size(), rng);
+        evaluator.EvaluateFull(rngs, population, buf);
+        for (auto i = 0UL; i < population.size(); ++i) {
+            CHECK(!population[i].Approximate);
+            CHECK(population[i].Fitness == expected[i]);
+        }
+        CHECK(evaluator.ResidualEvaluations == 1 + 2 * individuals.size());
+    }
+
+    // a new sample for the next generation
+    evaluator.Prepare(individuals);
+    CHECK(!std::ranges::equal(evaluator.Sample(), sample, [](auto a, auto b) { return a.Start() == b.Start(); }));
+
+    SUBCASE("multi-objective") {
+        // a full evaluation after the sampled one must not clear the flag, otherwise Promote does nothing
+        Operon::Evaluator<DefaultDispatch> full{problem, dtable};
+        Operon::MultiEvaluator multi{problem};
+        multi.Add(evaluator);
+        multi.Add(full);
+        multi.Prepare(individuals);
+
+        for (auto i = 0UL; i < individuals.size(); ++i) {
+            auto& ind = individuals[i];
+            ind.Fitness = multi(rng, ind, buf);
+            CHECK(ind.Approximate);
+            CHECK(ind.Fitness[1] == expected[i].front());
+            CHECK(multi.Promote(rng, ind, buf));
+            CHECK(!ind.Approximate);
+            CHECK(ind.Fitness[0] == expected[i].front());
+            CHECK(!multi.Promote(rng, ind, buf));
+        }
+    }
+}
+
+TEST_CASE("Interval arithmetic")
+{
+    auto ds = Dataset("./data/Poly-10.csv", /*hasHeader=*/true);
+    auto range = Range { 0, ds.Rows<std::size_t>() };
+
+    Operon::IntervalInterpreter interval{ds, range};
+    Operon::IntervalInterpreter strict{ds, range, /*strict=*/true};
+    auto const [lo, hi] = std::ranges::minmax(ds.GetValues("X1"));
+
+    Operon::Node x1{NodeType::Variable, ds.GetVariable("X1")->Hash};
+    Operon::Node x2{NodeType::Variable, ds.GetVariable("X2")->Hash};
+    x1.Value = x2.Value = 1;
+    auto const make = [](std::initializer_list<Node> nodes) { Tree tree(nodes); tree.UpdateNodes(); return tree; };
+
+    SUBCASE("Bounds")
+    {
+        auto const iv = interval(make({ x1, x1, Node(NodeType::Add) }));
+        CHECK(iv.Lower == 2 * lo);
+        CHECK(iv.Upper == 2 * hi);
+
+        // sqrt(X1 * X1 + 1), log(exp(X1) + X2^2)
+        CHECK(interval.IsValid(make({ Node::Constant(1), x1, x1, Node(NodeType::Mul), Node(NodeType::Add), Node(NodeType::Sqrt) })));
+        CHECK(interval.IsValid(make({ x2, Node(NodeType::Square), x1, Node(NodeType::Exp), Node(NodeType::Add), Node(NodeType::Log) })));
+
+        // log(-1 - X1 * X1) is undefined
+        auto const undefined = make({ x1, x1, Node(NodeType::Mul), Node::Constant(-1), Node(NodeType::Sub), Node(NodeType::Log) });
+        CHECK(!interval(undefined).IsDefined());
+        CHECK(!interval.IsValid(undefined));
+        CHECK(!strict.IsValid(undefined));
+
+        // X2 / (X1 - X1), exp(exp(1000 * X1)) are unbounded, only the strict check rejects them
+        auto y = x1;
+        y.Value = 1000;
+        for (auto const& tree : { make({ x1, x1, Node(NodeType::Sub), x2, Node(NodeType::Div) }), make({ y, Node(NodeType::Exp), Node(NodeType::Exp) }) }) {
+            CHECK(interval.IsValid(tree));
+            CHECK(!strict.IsValid(tree));
+        }
+    }
+
+    Operon::PrimitiveSet pset{PrimitiveSet::Full};
+    Operon::BalancedTreeCreator creator{pset, ds.VariableHashes()};
+    Operon::RandomGenerator rng{0};
+    DefaultDispatch dtable;
+
+    SUBCASE("Registered callable")
+    {
+        // a user-defined primitive has no interval rule, its output is unbounded
+        constexpr auto S = DefaultDispatch::BatchSize<Operon::Scalar>;
+        Node f(NodeType::Dynamic, /*hashValue=*/42); // NOLINT
+        f.Arity = 1;
+        DefaultDispatch custom;
+        custom.RegisterCallable(f.HashValue, [](auto const& /*nodes*/, auto primal, std::size_t i, Operon::Range rg) {
+            auto* res = primal.data_handle() + i * S;
+            std::transform(res - S, res - S + rg.Size(), res, [](auto a) { return 2 * a; });
+        });
+        auto const tree = make({ x1, f, Node::Constant(1), Node(NodeType::Add) });
+        auto const values = Interpreter<Operon::Scalar, DefaultDispatch>(custom, ds, tree).Evaluate(tree.GetCoefficients(), range);
+        CHECK(std::ranges::all_of(values, [](auto v) { return std::isfinite(v); }));
+
+        auto const iv = interval(tree);
+        CHECK(iv.IsDefined());
+        CHECK(!iv.IsFinite());
+        CHECK(interval.IsValid(tree));
+        CHECK(!strict.IsValid(tree));
+    }
+
+    SUBCASE("Enclosure")
+    {
+        // the outputs of the valid trees (strict check) are finite and inside the interval
+        for (auto k = 0; k < 1000; ++k) {
+            auto tree = creator(rng, 20, 1, 10);
+            auto const iv = strict(tree);
+            if (!iv.IsFinite()) { continue; }
+            auto const values = Interpreter<Operon::Scalar, DefaultDispatch>(dtable, ds, tree).Evaluate(tree.GetCoefficients(), range);
+            auto const eps = 1e-3 * std::max({ Operon::Scalar{1}, std::abs(iv.Lower), std::abs(iv.Upper) });
+            CHECK(std::ranges::all_of(values, [&](auto v) { return std::isfinite(v) && v >= iv.Lower - eps && v <= iv.Upper + eps; }));
+        }
+    }
+
+    SUBCASE("Offspring rejection")
+    {
+        Operon::Problem problem{ds, range, range};
+        Operon::Evaluator<DefaultDispatch> evaluator{problem, dtable};
+        std::vector<Operon::Scalar> buf(range.Size());
+        std::vector<Operon::Individual> individuals(100);
+        for (auto& ind : individuals) {
+            ind.Genotype = creator(rng, 20, 1, 10);
+            ind.Fitness = evaluator(rng, ind, buf);
+        }
+
+        Operon::SubtreeCrossover crossover{1.0, 10, 50};
+        Operon::ChangeFunctionMutation mutator{pset};
+        Operon::SingleObjectiveComparison comp;
+        Operon::TournamentSelector selector{comp};
+        Operon::BasicOffspringGenerator generator{evaluator, crossover, mutator, selector, selector};
+        generator.SetIntervalCheck(&interval);
+        generator.Prepare(individuals);
+        evaluator.Reset();
+
+        auto constexpr n{200UL};
+        auto rejected{0UL};
+        for (auto k = 0UL; k < n; ++k) {
+            auto child = generator.Generate(rng, 1.0, 0.5, 0.0, buf).Child;
+            if (!interval.IsValid(child->Genotype)) {
+                ++rejected;
+                CHECK(child->Fitness == Operon::Vector<Operon::Scalar>{ EvaluatorBase::ErrMax });
+            }
+        }
+        // the rejected offspring are not evaluated, but each rejection is charged to the budget
+        CHECK(rejected > 0);
+        CHECK(generator.IntervalRejections() == rejected);
+        CHECK(evaluator.ResidualEvaluations == n);
+    }
+}
+
+TEST_CASE("Constant folding")
+{
+    auto ds = Dataset("./data/Poly-10.csv", /*hasHeader=*/true);
+    auto range = Range { 0, ds.Rows<std::size_t>() };
+    auto const x = ds.GetValues("X1").subspan(range.Start(), range.Size());
+
+    // 2 * 3 + X1, the product does not depend on the data
+    Operon::Node var{NodeType::Variable, ds.GetVariable("X1")->Hash};
+    var.Value = 1;
+    Operon::Tree tree({ Node::Constant(2), Node::Constant(3), Node(NodeType::Mul), var, Node(NodeType::Add) });
+    tree.UpdateNodes();
+    for (auto& node : tree.Nodes()) { node.Optimize = node.IsLeaf(); }
+
+    DefaultDispatch dtable;
+    Interpreter<Operon::Scalar, DefaultDispatch> interpreter{dtable, ds, tree};
+
+    auto values = interpreter.Evaluate({}, range);
+    CHECK(interpreter.GetTape().Folded().size() == 1);
+    CHECK(interpreter.GetTape().Live().size() == 2);
+    for (auto i = 0UL; i < values.size(); ++i) { CHECK(values[i] == doctest::Approx(6 + x[i])); }
+
+    // the folded subtree is recomputed when one of its coefficients changes
+    std::vector<Operon::Scalar> coeff{4, 3, 1};
+    values = interpreter.Evaluate(coeff, range);
+    for (auto i = 0UL; i < values.size(); ++i) { CHECK(values[i] == doctest::Approx(12 + x[i])); }
+
+    // the derivatives of the coefficients inside the folded subtree
+    auto const jac = interpreter.JacRev(coeff, range);
+    for (auto i = 0L; i < jac.rows(); ++i) {
+        CHECK(jac(i, 0) == doctest::Approx(3));
+        CHECK(jac(i, 1) == doctest::Approx(4));
+        CHECK(jac(i, 2) == doctest::Approx(x[i]));
+    }
+    CHECK((interpreter.JacFwd(coeff, range) == jac).all());
+    values = interpreter.Evaluate(coeff, range);
+    for (auto i = 0UL; i < values.size(); ++i) { CHECK(values[i] == doctest::Approx(12 + x[i])); }
+}
+
+TEST_CASE("Fused variable weights")
+{
+    auto ds = Dataset("./data/Poly-10.csv", /*hasHeader=*/true);
+    Range range{ 3, 3 + 1000 + 7 }; // ends with a partial batch
+
+    auto variable = [&](std::string const& name, Operon::Scalar w) {
+        Node n{NodeType::Variable, ds.GetVariable(name)->Hash};
+        n.Value = w;
+        return n;
+    };
+
+    // n-ary nodes with weighted variable children (more than four of them)
+    for (auto type : { NodeType::Add, NodeType::Sub, NodeType::Mul }) {
+        Node f{type};
+        f.Arity = 6;
+        Operon::Tree tree({ variable("X6", 1), Node(NodeType::Sin), variable("X5", 0.5), variable("X4", 2), variable("X3", -1), variable("X2", 3), variable("X1", 0.25), f });
+        tree.UpdateNodes();
+        for (auto& node : tree.Nodes()) { node.Optimize = node.IsVariable(); }
+
+        DefaultDispatch dtable;
+        Interpreter<Operon::Scalar, DefaultDispatch> interpreter{dtable, ds, tree};
+        auto const values = interpreter.Evaluate({}, range);
+        auto const code = interpreter.GetTape().Code();
+        CHECK(code.back().Fused != nullptr);
+        CHECK(std::ranges::count_if(code, [](auto const& ins) { return ins.Inlined; }) == 5);
+
+        // a wrapped primitive is not recognized as the default one, so it is not fused
+        DefaultDispatch wrapped{dtable};
+        auto const fn = dtable.GetFunction<Operon::Scalar>(f.HashValue);
+        auto const df = dtable.GetDerivative<Operon::Scalar>(f.HashValue);
+        wrapped.RegisterCallable(f.HashValue,
+            [fn](auto const& nodes, auto primal, auto i, auto rg) { fn(nodes, primal, i, rg); },
+            [df](auto const& nodes, auto primal, auto trace, auto i, auto j) { df(nodes, primal, trace, i, j); });
+        Interpreter<Operon::Scalar, DefaultDispatch> reference{wrapped, ds, tree};
+        auto const expected = reference.Evaluate({}, range);
+        CHECK(reference.GetTape().Code().back().Fused == nullptr);
+        for (auto i = 0UL; i < values.size(); ++i) { CHECK(values[i] == doctest::Approx(expected[i])); }
+
+        // the derivatives still see the variable values
+        auto const jac = interpreter.JacRev(tree.GetCoefficients(), range);
+        CHECK(jac.isApprox(reference.JacRev(tree.GetCoefficients(), range), 1e-4));
+        CHECK(interpreter.Evaluate({}, range) == values);
+    }
+}
+
+TEST_CASE("Tape reuse")
+{
+    auto ds = Dataset("./data/Poly-10.csv", /*hasHeader=*/true);
+    auto range = Range { 0, ds.Rows<std::size_t>() };
+
+    Operon::Map<std::string, Operon::Hash> vars;
+    for (auto const& v : ds.GetVariables()) {
+        vars[v.Name] = v.Hash;
+    }
+
+    using DTable = DispatchTable<Operon::Scalar>;
+    DTable dtable;
+
+    auto tree = InfixParser::Parse("sin(X1) * X2 + 2.5 * X3 / (1 + X4 * X4)", vars);
+    Interpreter<Operon::Scalar, DTable> interpreter{dtable, ds, tree};
+
+    auto coeff = tree.GetCoefficients();
+    auto const e0 = interpreter.Evaluate(coeff, range);
+
+    // the tape compiled by the first call must pick up the new coefficients
+    std::ranges::transform(coeff, coeff.begin(), [](auto c) { return c * Operon::Scalar{0.5}; });
+    auto const e1 = interpreter.Evaluate(coeff, range);
+    auto const e2 = Interpreter<Operon::Scalar, DTable>(dtable, ds, tree).Evaluate(coeff, range);
+    CHECK(e0 != e1);
+    CHECK(e1 == e2);
+
+    // a different range on the same interpreter
+    Range sub{ 10, 110 };
+    auto const e3 = interpreter.Evaluate(coeff, sub);
+    CHECK(std::equal(e3.begin(), e3.end(), e2.begin() + sub.Start()));
+
+    auto const j1 = interpreter.JacRev(coeff, range);
+    auto const j2 = Interpreter<Operon::Scalar, DTable>(dtable, ds, tree).JacRev(coeff, range);
+    CHECK(j1.isApprox(j2));
+
+    // a pooled tape shared by interpreters of different trees (as done by the evaluator workers)
+    TapePool<Operon::Scalar, DTable> pool;
+    pool.Configure(1, []() { return 0; });
+    auto small = InfixParser::Parse("X1 * X2", vars);
+    auto const e4 = Interpreter<Operon::Scalar, DTable>(dtable, ds, tree, pool.Local()).Evaluate(coeff, range);
+    auto const e5 = Interpreter<Operon::Scalar, DTable>(dtable, ds, small, pool.Local()).Evaluate({}, range);
+    auto const e6 = Interpreter<Operon::Scalar, DTable>(dtable, ds, tree, pool.Local()).Evaluate(coeff, range);
+    CHECK(e4 == e2);
+    CHECK(e5 == Interpreter<Operon::Scalar, DTable>(dtable, ds, small).Evaluate({}, range));
+    CHECK(e6 == e2);
+
+    auto const j3 = Interpreter<Operon::Scalar, DTable>(dtable, ds, tree, pool.Local()).JacFwd(coeff, range);
+    CHECK(j3.isApprox(j2));
+
+    pool.Configure(1, {});
+    CHECK(pool.Local() == nullptr);
+
+    // in-place mutations of the same size must recompile the tape of an existing interpreter
+    auto mutated = tree;
+    Interpreter<Operon::Scalar, DTable> reused{dtable, ds, mutated};
+    auto const& vx1 = vars["X1"];
+    auto const& vx5 = vars["X5"];
+    (void) reused.Evaluate({}, range);
+    for (auto& n : mutated.Nodes()) {
+        if (n.IsVariable() && n.HashValue == vx1) { n.HashValue = n.CalculatedHashValue = vx5; }  // variable change
+        if (n.Is<NodeType::Sin>()) { n = Node(NodeType::Cos); }                                  // symbol change
+    }
+    mutated.UpdateNodes();
+    auto const expected = InfixParser::Parse("cos(X5) * X2 + 2.5 * X3 / (1 + X4 * X4)", vars);
+    CHECK(reused.Evaluate({}, range) == Interpreter<Operon::Scalar, DTable>(dtable, ds, expected).Evaluate({}, range));
+
+    // the compiled tape is tied to the dataset and to the current state of the tree
+    Dataset::Matrix shifted = ds.Values().array() + 1;
+    Dataset other{shifted};
+    other.SetVariableNames(ds.VariableNames());
+    pool.Configure(1, []() { return 0; });
+    auto const e7 = Interpreter<Operon::Scalar, DTable>(dtable, ds, tree, pool.Local()).Evaluate(coeff, range);
+    CHECK(e7 == e2);
+    CHECK(pool.Local()->IsCompiled(dtable, ds, tree));
+    CHECK(!pool.Local()->IsCompiled(dtable, other, tree));
+    CHECK(!pool.Local()->IsCompiled(dtable, ds, mutated));
+    auto const e8 = Interpreter<Operon::Scalar, DTable>(dtable, other, tree, pool.Local()).Evaluate(coeff, range);
+    CHECK(e8 == Interpreter<Operon::Scalar, DTable>(dtable, other, tree).Evaluate(coeff, range));
+    CHECK(e8 != e7);
+}
+
+TEST_CASE("Frozen subtrees")
+{
+    auto ds = Dataset("./data/Poly-10.csv", /*hasHeader=*/true);
+    PrimitiveSet pset{PrimitiveSet::Arithmetic | NodeType::Exp | NodeType::Sin | NodeType::Tanh};
+    BalancedTreeCreator creator{pset, ds.VariableHashes()};
+    RandomGenerator rng{0};
+    DefaultDispatch dtable;
+
+    Range train{ 50, 450 };
+    Range sub{ 100, 377 };
+    auto const same = [](auto const& a, auto const& b) {
+        return std::ranges::equal(a.reshaped(), b.reshaped(), [](auto x, auto y) { return x == y || (std::isnan(x) && std::isnan(y)); });
+    };
+
+    // the frozen outputs are kept in the tape, shared by the trees like the tapes of an optimizer worker
+    Tape<Operon::Scalar, DefaultDispatch> tape;
+
+    for (auto k = 0; k < 100; ++k) { // NOLINT
+        // only some of the leaves are optimized, the other subtrees are frozen
+        auto tree = creator(rng, 1 + k % 50, 1, 12); // NOLINT
+        for (auto& n : tree.Nodes()) { n.Optimize = n.IsLeaf() && (k + n.Length + n.Depth) % 3 == 0; }
+        auto coeff = tree.GetCoefficients();
+
+        Interpreter<Operon::Scalar, DefaultDispatch> plain{dtable, ds, tree};
+        Interpreter<Operon::Scalar, DefaultDispatch> frozen{dtable, ds, tree, &tape};
+        // without budget nothing is frozen
+        frozen.Freeze(train, k % 4 == 0 ? 0 : Interpreter<Operon::Scalar, DefaultDispatch>::DefaultFreezeBudget);
+
+        for (auto range : { train, sub }) {
+            using Vector = Eigen::Array<Operon::Scalar, -1, 1>;
+            auto const e1 = plain.Evaluate(coeff, range);
+            auto const e2 = frozen.Evaluate(coeff, range);
+            CHECK(same(Eigen::Map<Vector const>(e1.data(), std::ssize(e1)), Eigen::Map<Vector const>(e2.data(), std::ssize(e2))));
+            CHECK(same(plain.JacRev(coeff, range), frozen.JacRev(coeff, range)));
+            CHECK(same(plain.JacFwd(coeff, range), frozen.JacFwd(coeff, range)));
+        }
+
+        // freezing the tape again (here over another range, by another interpreter of the same tree)
+        // invalidates the frozen outputs of the first interpreter
+        Interpreter<Operon::Scalar, DefaultDispatch> other{dtable, ds, tree, &tape};
+        other.Freeze(sub);
+        using Vector = Eigen::Array<Operon::Scalar, -1, 1>;
+        auto const e1 = plain.Evaluate(coeff, train);
+        auto const e2 = frozen.Evaluate(coeff, train);
+        CHECK(same(Eigen::Map<Vector const>(e1.data(), std::ssize(e1)), Eigen::Map<Vector const>(e2.data(), std::ssize(e2))));
+    }
+}
+
+TEST_CASE("Variable projection")
+{
+    Operon::RandomGenerator rng{0};
+    constexpr auto nrow{500};
+    auto range = Range { 0, nrow };
+
+    Eigen::Array<Operon::Scalar, -1, -1> data(nrow, 3);
+    for (auto i = 0; i < 2; ++i) {
+        auto col = data.col(i);
+        std::generate(col.begin(), col.end(), [&](){ return Operon::Random::Uniform(rng, -1.0F, +1.0F); });
+    }
+    data.col(2) = 2 + 3 * data.col(0) - 1.5 * (0.7 * data.col(1)).exp(); // NOLINT
+
+    Operon::Dataset ds(data);
+    Operon::Problem problem{ds, range, range};
+    problem.SetTarget("X3");
+
+    // c + w1 * X1 + w2 * exp(w3 * X2): c, w1 and w2 are linear, w3 is not
+    Operon::Node x1{NodeType::Variable, ds.GetVariable("X1")->Hash};
+    Operon::Node x2{NodeType::Variable, ds.GetVariable("X2")->Hash};
+    Operon::Node expNode{NodeType::Exp};
+    x1.Value = x2.Value = expNode.Value = 1;
+    expNode.Optimize = true;
+    Tree tree({ Node::Constant(1), x1, Node(NodeType::Add), x2, expNode, Node(NodeType::Add) });
+    tree.UpdateNodes();
+
+    using DTable = DispatchTable<Operon::Scalar>;
+    DTable dtable;
+    CHECK(VarProOptimizer<DTable>::LinearCoefficients(tree) == std::vector<bool>{ true, true, false, true });
+
+    VarProOptimizer<DTable> optimizer{dtable, problem};
+    auto const summary = optimizer.Optimize(rng, tree);
+    CHECK(summary.Success);
+    CHECK(summary.FinalCost < 1e-6 * summary.InitialCost);
+    CHECK(std::abs(summary.FinalParameters[2] - 0.7) < 1e-3); // NOLINT
+}
+
+TEST_CASE("Coefficient cache")
+{
+    auto ds = Dataset("./data/Poly-10.csv", /*hasHeader=*/true);
+    auto range = Range { 0, ds.Rows<std::size_t>() };
+    Operon::Problem problem{ds, range, range};
+
+    // polynomials, so that all the costs are finite
+    PrimitiveSet pset{NodeType::Constant | NodeType::Variable | NodeType::Add | NodeType::Sub | NodeType::Mul};
+    BalancedTreeCreator creator{pset, ds.VariableHashes()};
+    RandomGenerator rng{0};
+    DefaultDispatch dtable;
+
+    LevenbergMarquardtOptimizer<DefaultDispatch, OptimizerType::Tiny> optimizer{dtable, problem};
+    optimizer.SetIterations(10); // NOLINT
+    CoefficientCache cache;
+    CoefficientOptimizer coeffOptimizer{optimizer, /*lmProb=*/0.0};
+    coeffOptimizer.SetCache(&cache);
+
+    for (auto k = 0; k < 10; ++k) { // NOLINT
+        auto tree = creator(rng, 20, 1, 10); // NOLINT
+        auto const first = coeffOptimizer(rng, tree);
+        CHECK(!first.WarmStart);
+        CHECK(!first.Skipped);
+
+        // the same structure starts from the optimized coefficients, until the cost stops improving
+        auto const second = coeffOptimizer(rng, tree);
+        CHECK(second.WarmStart);
+        CHECK(second.InitialParameters == first.FinalParameters);
+        CHECK(second.FinalCost <= first.FinalCost);
+        CHECK((!second.Success || second.FinalCost <= second.InitialCost));
+
+        OptimizerSummary summary;
+        for (auto i = 0; i < 100 && !summary.Skipped; ++i) { summary = coeffOptimizer(rng, tree); } // NOLINT
+        CHECK(summary.Skipped);
+        CHECK(summary.Success);
+        CHECK(summary.FunctionEvaluations == 0);
+        CHECK(summary.FinalCost <= second.FinalCost);
+    }
+    CHECK(cache.Skips() == 10);
+    CHECK(cache.Misses() == 10);
+
+    // commutative arguments in a different order: same structure, but the coefficients are swapped
+    auto x1 = Node(NodeType::Variable, ds.GetVariable("X1")->Hash);
+    Tree lhs({ x1, Node::Constant(1), Node(NodeType::Add) });
+    Tree rhs({ Node::Constant(1), x1, Node(NodeType::Add) });
+    lhs.UpdateNodes();
+    rhs.UpdateNodes();
+    auto const k1 = CoefficientCache::MakeKey(lhs);
+    auto const k2 = CoefficientCache::MakeKey(rhs);
+    CHECK(k1.Structure == k2.Structure);
+    CHECK(k1.Layout != k2.Layout);
+    cache.Update(k1, lhs.GetCoefficients(), 1);
+    CHECK(!cache.Find(k2).has_value());
+
+    // the same structure with a different fixed constant is a different problem for the optimizer
+    auto c1 = Node::Constant(1);
+    auto c2 = Node::Constant(2);
+    c1.Optimize = c2.Optimize = false;
+    Tree t1({ x1, c1, Node(NodeType::Add) });
+    Tree t2({ x1, c2, Node(NodeType::Add) });
+    t1.UpdateNodes();
+    t2.UpdateNodes();
+    auto const k3 = CoefficientCache::MakeKey(t1);
+    auto const k4 = CoefficientCache::MakeKey(t2);
+    CHECK(k3.Structure == k4.Structure);
+    CHECK(k3.Layout != k4.Layout);
+    cache.Update(k3, t1.GetCoefficients(), 1);
+    CHECK(cache.Find(k3).has_value());
+    CHECK(!cache.Find(k4).has_value());
+}
+
+TEST_CASE("Local search scheduler")
+{
+    auto ds = Dataset("./data/Poly-10.csv", /*hasHeader=*/true);
+    auto range = Range { 0, ds.Rows<std::size_t>() };
+    Operon::Problem problem{ds, range, range};
+
+    PrimitiveSet pset{NodeType::Constant | NodeType::Variable | NodeType::Add | NodeType::Sub | NodeType::Mul};
+    BalancedTreeCreator creator{pset, ds.VariableHashes()};
+    RandomGenerator rng{0};
+    DefaultDispatch dtable;
+
+    LevenbergMarquardtOptimizer<DefaultDispatch, OptimizerType::Tiny> optimizer{dtable, problem};
+    CoefficientOptimizer coeffOptimizer{optimizer};
+    Operon::Evaluator<DefaultDispatch> evaluator{problem, dtable, Operon::ErrorMetric{ErrorType::MSE}, /*linearScaling=*/false};
+    std::vector<Operon::Scalar> buf(range.Size());
+
+    LocalSearchScheduler scheduler{coeffOptimizer, evaluator, LocalSearchPolicy::Best, /*firstPass=*/2, /*secondPass=*/20};
+    scheduler.SetFraction(0.2); // NOLINT
+
+    // the first pass, as done by the offspring generator (the last children get none)
+    auto const iterations = optimizer.Iterations();
+    std::vector<Operon::Individual> offspring(60); // NOLINT
+    for (auto i = 0UL; i < offspring.size(); ++i) {
+        auto& ind = offspring[i];
+        ind.Genotype = creator(rng, 20, 1, 10); // NOLINT
+        if (i < 50) { ind.LocalSearchRate = LocalSearchScheduler::Rate(coeffOptimizer(rng, ind.Genotype, scheduler.FirstPass())); } // NOLINT
+        ind.Fitness = evaluator(rng, ind, buf);
+    }
+
+    // the passes do not change the settings of the shared optimizer
+    auto const selected = scheduler.Select(offspring);
+    CHECK(optimizer.Iterations() == iterations);
+    CHECK(std::ranges::count(selected, true) == 10);
+    CHECK(std::ranges::none_of(selected.begin() + 50, selected.end(), std::identity{})); // NOLINT
+    for (auto i = 0UL; i < offspring.size(); ++i) {
+        for (auto j = 0UL; j < 50; ++j) { // NOLINT
+            if (selected[i] && !selected[j]) { CHECK(offspring[i][0] <= offspring[j][0]); }
+        }
+    }
+
+    for (auto i = 0UL; i < offspring.size(); ++i) {
+        if (!selected[i]) { continue; }
+        auto const before = offspring[i][0];
+        scheduler.Refine(rng, offspring[i], buf);
+        CHECK(offspring[i][0] <= before);
+    }
+    auto const stats = scheduler.GetStats();
+    CHECK(stats.Candidates == 50); // NOLINT
+    CHECK(stats.Refined == 10);
+    CHECK(stats.Gain >= 0);
+    CHECK(stats.Time > 0);
+
+    // the children whose cost is still dropping
+    LocalSearchScheduler improving{coeffOptimizer, evaluator, LocalSearchPolicy::Improving, 2, 20}; // NOLINT
+    auto const dropping = improving.Select(offspring);
+    for (auto i = 0UL; i < offspring.size(); ++i) {
+        CHECK(dropping[i] == (offspring[i].LocalSearchRate >= improving.Threshold()));
+    }
+
+    // without a first pass there is no rate to rank the children by
+    CHECK_THROWS_AS(LocalSearchScheduler(coeffOptimizer, evaluator, LocalSearchPolicy::Improving, 0, 20), std::invalid_argument); // NOLINT
+    CHECK_THROWS_AS(LocalSearchScheduler(coeffOptimizer, evaluator, LocalSearchPolicy::BestOrImproving, 0, 20), std::invalid_argument); // NOLINT
+    CHECK_NOTHROW(LocalSearchScheduler(coeffOptimizer, evaluator, LocalSearchPolicy::Best, 0, 20)); // NOLINT
+
+    // a second pass whose result is not applied keeps the fitness without evaluating the child again
+    CoefficientCache cache;
+    CoefficientOptimizer darwinian{optimizer, /*lmProb=*/0.0};
+    darwinian.SetCache(&cache);
+    LocalSearchScheduler refiner{darwinian, evaluator, LocalSearchPolicy::Uniform, 2, 20}; // NOLINT
+    auto child = offspring.front();
+    auto const fitness = child.Fitness;
+    refiner.Refine(rng, child, buf);
+    auto const hits = evaluator.CoefficientCacheHits.load();
+    refiner.Refine(rng, child, buf);
+    CHECK(child.Fitness == fitness);
+    CHECK(evaluator.CoefficientCacheHits == hits + 1);
 }
 
 TEST_CASE("parameter optimization")
@@ -333,6 +1258,12 @@ TEST_CASE("parameter optimization")
         testOptimizer(optimizer, "ceres solver");
     }
 
+    SUBCASE("streaming")
+    {
+        LevenbergMarquardtOptimizer<DTable, OptimizerType::Streaming> optimizer { dtable, problem };
+        testOptimizer(optimizer, "streaming solver");
+    }
+
     SUBCASE("lbfgs / gaussian")
     {
         LBFGSOptimizer<DTable, GaussianLikelihood<Operon::Scalar>> optimizer { dtable, problem };
@@ -0,0 +1,93 @@
+// SPDX-License-Identifier: MIT
+// SPDX-FileCopyrightText: Copyright 2019-2024 Heal Research
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include <cmath>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "builtins.hpp"
+#include "operon_test_variants.hpp"
+
+namespace dt = doctest;
+
+namespace Operon::Test {
+#define OPERON_TEST_VARIANT(N, B, I) auto N() -> detail::IsaBuiltinTable const*; // NOLINT
+    OPERON_TEST_VARIANTS
+#undef OPERON_TEST_VARIANT
+
+namespace {
+    using T = Operon::Scalar;
+    constexpr auto S = Dispatch::DefaultBatchSize<T>;
+
+    struct Variant {
+        std::string Name;
+        std::string_view Backend;
+        detail::IsaBuiltinTable const* Table;
+    };
+
+    // the variants which can run on this processor (the instruction set must be available to the library)
+    auto Variants() -> std::vector<Variant>
+    {
+        std::vector<Variant> variants;
+#define OPERON_TEST_VARIANT(N, B, I) if (IsAvailable(InstructionSet::I)) { variants.push_back({ #N, #B, N() }); } // NOLINT
+        OPERON_TEST_VARIANTS
+#undef OPERON_TEST_VARIANT
+        return variants;
+    }
+
+    // evaluates a unary primitive over S values in (0, 10] with the kernels of the table
+    auto Evaluate(detail::IsaBuiltinTable const& table, NodeType type) -> std::vector<T>
+    {
+        std::vector<T> buffer(2 * S);
+        auto view = Backend::View<T, S>(buffer.data(), S, 2);
+        for (auto i = 0UL; i < S; ++i) { buffer[i] = static_cast<T>(i + 1) * T{10} / static_cast<T>(S); }
+        Operon::Vector<Node> nodes{ Node(NodeType::Variable), Node(type) };
+        table.Functions[NodeTypes::GetIndex(type)](nodes, view, 1, Operon::Range{0, S});
+        return { buffer.begin() + S, buffer.end() };
+    }
+} // namespace
+
+// the variants are compiled at -O0, where none of the kernel templates are inlined into the entry points.
+// each table must still evaluate with its own code (see OPERON_ISA_NAMESPACE)
+TEST_CASE("kernel variants at -O0" * dt::test_suite("isa"))
+{
+    auto const variants = Variants();
+    REQUIRE(!variants.empty());
+
+    for (auto const& v : variants) {
+        if (v.Backend != "Eigen") { continue; }
+        auto const exp = Evaluate(*v.Table, NodeType::Exp);
+        auto const log = Evaluate(*v.Table, NodeType::Log);
+        for (auto i = 0UL; i < S; ++i) {
+            auto const x = static_cast<T>(i + 1) * T{10} / static_cast<T>(S);
+            CHECK_MESSAGE(exp[i] == doctest::Approx(std::exp(x)).epsilon(1e-5), v.Name);
+            CHECK_MESSAGE(log[i] == doctest::Approx(std::log(x)).epsilon(1e-5), v.Name);
+        }
+    }
+}
+
+// the per-table backends have the same kernel names (e.g. Backend::Exp<T, S>), the approximations must not be
+// replaced by the exact functions of another variant or the other way around
+TEST_CASE("math backends at -O0" * dt::test_suite("isa"))
+{
+    auto const variants = Variants();
+
+    for (auto const& v : variants) {
+        if (v.Backend != "Fast_v1") { continue; }
+        auto const approx = Evaluate(*v.Table, NodeType::Exp);
+        for (auto i = 0UL; i < S; ++i) {
+            auto const x = static_cast<T>(i + 1) * T{10} / static_cast<T>(S);
+            CHECK_MESSAGE(approx[i] == doctest::Approx(std::exp(x)).epsilon(0.1), v.Name);
+        }
+
+        for (auto const& w : variants) {
+            if (w.Backend != "Eigen") { continue; }
+            CHECK_MESSAGE(approx != Evaluate(*w.Table, NodeType::Exp), v.Name + " vs " + w.Name);
+        }
+    }
+}
+} // namespace Operon::Test